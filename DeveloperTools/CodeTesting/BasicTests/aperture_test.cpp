@@ -34,6 +34,19 @@ void testCollimatorAperture()
 	assert(app->GetCollimatorTilt() == 0);
 	assert(app->GetCollimatorLength() == 10);
 	assert(app->CheckWithinApertureBoundaries(0.0, 0.0, 0.0) == true);
+	// no exit gap set yet, so no inscribed guarantee
+	assert(app->GetInscribedRadius() == 0);
+	app->SetExitWidth(0.08);
+	app->SetExitHeight(0.12);
+	assert_close(app->GetInscribedRadius(), 0.04, 1e-12);
+
+	// the jaw tapers from 0.05 to 0.04 in x, so a parallel path at x=0.045 reaches it half way
+	double z_in, z_out;
+	assert(app->GapInterval(0.045, 0.0, 0.0, 0.0, 0.0, length, z_in, z_out) == true);
+	assert_close(z_in, 0.0, 1e-12);
+	assert_close(z_out, 5.0, 1e-9);
+	// a path starting in the jaw that converges on the gap too slowly never leaves the material
+	assert(app->GapInterval(0.06, -0.0015, 0.0, 0.0, 0.0, length, z_in, z_out) == false);
 
 	collimator_aperture_tilt = 0.001;
 	bool side = true;
@@ -78,6 +91,7 @@ void testApertureFactory()
 
 	assert(ap->GetType() == "RECTELLIPSE");
 	assert(ap->CheckWithinApertureBoundaries(0.0, 0.0, 0.0) == true);
+	assert(ap->GetInscribedRadius() == 1);
 }
 
 void testInterpolatedApertureFactory()
@@ -135,6 +149,8 @@ void testInterpolatedApertureFactory()
 
 	assert(apInt->GetType() == "RECTELLIPSE-interpolated");
 	assert(apInt2->GetType() == "CIRCLE-interpolated");
+	assert(apInt->GetInscribedRadius() == 1);
+	assert(apInt2->GetInscribedRadius() == 1);
 }
 
 int main(int argc, char* argv[])
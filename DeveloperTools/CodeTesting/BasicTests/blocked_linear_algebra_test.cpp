@@ -0,0 +1,138 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include "TLASimp.h"
+#include "LinearAlgebra.h"
+#include "BlockedLinearAlgebra.h"
+
+/* Compare the blocked SVD, least squares solution and symmetric eigensystem
+ * with the unblocked routines, with one and several threads, for a matrix
+ * with dependent columns.
+ */
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	const size_t m = 230;
+	const size_t n = 150;
+
+	mt19937 gen(1);
+	normal_distribution<> normal;
+
+	RealMatrix A(m, n);
+	for(size_t i = 0; i < m; i++)
+	{
+		for(size_t j = 0; j < n; j++)
+		{
+			A(i, j) = normal(gen);
+		}
+		// a zero and a repeated column
+		A(i, 3) = 0;
+		A(i, n - 1) = A(i, 0);
+	}
+	RealVector b(m);
+	for(size_t i = 0; i < m; i++)
+	{
+		b[i] = normal(gen);
+	}
+
+	// Least squares by SVDMatrix
+	SetBlockedThreshold(0);
+	RealVector x0 = SVDMatrix<double>(A)(b);
+	double norm = 0;
+	for(size_t j = 0; j < n; j++)
+	{
+		norm = max(norm, fabs(x0[j]));
+	}
+
+	for(size_t nt = 1; nt <= 3; nt += 2)
+	{
+		SetBlockedThreads(nt);
+		SetBlockedThreshold(100);
+		SVDMatrix<double> svd(A);
+		RealVector x = svd(b);
+		for(size_t j = 0; j < n; j++)
+		{
+			assert(fabs(x[j] - x0[j]) < 1e-12 * norm);
+		}
+
+		// U^T U = 1 and A = U W V^T
+		const RealMatrix& U = svd.U();
+		const RealMatrix& V = svd.V();
+		const RealVector& W = svd.W();
+		assert(count(W.begin(), W.end(), 0.0) == 2);
+		for(size_t j = 0; j < n; j += 7)
+		{
+			for(size_t k = 0; k < n; k++)
+			{
+				double s = 0;
+				for(size_t i = 0; i < m; i++)
+				{
+					s += U(i, j) * U(i, k);
+				}
+				assert_close(s, j == k ? 1.0 : 0.0, 1e-12);
+			}
+			for(size_t i = 0; i < m; i++)
+			{
+				double s = 0;
+				for(size_t k = 0; k < n; k++)
+				{
+					s += U(i, k) * W[k] * V(j, k);
+				}
+				assert_close(s, A(i, j), 1e-12);
+			}
+		}
+	}
+
+	// Symmetric eigensystem
+	RealMatrix S(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		for(size_t j = 0; j <= i; j++)
+		{
+			S(i, j) = S(j, i) = normal(gen);
+		}
+	}
+	RealMatrix Z0(S);
+	RealVector e0;
+	SetBlockedThreshold(0);
+	EigenSystemSymmetricMatrix(Z0, e0);
+
+	SetBlockedThreshold(100);
+	RealMatrix Z(S);
+	RealVector e;
+	EigenSystemSymmetricMatrix(Z, e);
+
+	vector<double> ev0(e0.begin(), e0.end());
+	vector<double> ev(e.begin(), e.end());
+	sort(ev0.begin(), ev0.end());
+	sort(ev.begin(), ev.end());
+	for(size_t k = 0; k < n; k++)
+	{
+		assert_close(ev[k], ev0[k], 1e-11);
+	}
+	for(size_t k = 0; k < n; k += 5)
+	{
+		for(size_t i = 0; i < n; i++)
+		{
+			double s = 0;
+			for(size_t j = 0; j < n; j++)
+			{
+				s += S(i, j) * Z(j, k);
+			}
+			assert_close(s, e[k] * Z(i, k), 1e-11);
+		}
+	}
+
+	cout << "all blocked linear algebra tests successful" << endl;
+}
@@ -0,0 +1,95 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "Channels.h"
+
+/* Resolve element IDs and channels by literal names and patterns, and check
+ * that block reads and writes of channel arrays reach the right elements.
+ */
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	vector<Quadrupole*> quads;
+	for(int cell = 0; cell < 4; cell++)
+	{
+		quads.push_back(new Quadrupole(cell % 2 ? "QD" : "QF", 1.0, 0.1 * (cell + 1)));
+		ctor->AppendComponent(quads.back());
+		ctor->AppendComponent(new Drift("D", 1.0));
+		ctor->AppendComponent(new Sextupole(cell % 2 ? "SD" : "SF", 0.5, 1.0 + cell));
+		ctor->AppendComponent(new Drift("D", 1.0));
+	}
+	ctor->AppendComponent(new Quadrupole("QFINAL", 1.0, 0.5));
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+
+	vector<ModelElement*> elements;
+	assert(model->ExtractModelElements("Quadrupole.QF", elements) == 2);
+	elements.clear();
+	assert(model->ExtractModelElements("Quadrupole.QF*", elements) == 3);
+	elements.clear();
+	assert(model->ExtractModelElements("Quadrupole.*", elements) == 5);
+	elements.clear();
+	assert(model->ExtractModelElements("Quad*", elements) == 5);
+	elements.clear();
+	// component frames are named after their component, e.g. ComponentFrame.Quadrupole.QD
+	assert(model->ExtractModelElements("*.QD", elements) == 4);
+	elements.clear();
+	assert(model->ExtractModelElements("Quadrupole.QD|Sextupole.SF", elements) == 4);
+	elements.clear();
+	assert(model->ExtractModelElements("Quadrupole.QX*", elements) == 0);
+	elements.clear();
+	assert(model->ExtractModelElements("Quadrupol.*", elements) == 0);
+
+	vector<RWChannel*> chnls;
+	assert(model->GetRWChannels("Quadrupole.QF.B1", chnls) == 2);
+	assert(model->GetRWChannels("Sextupole.*.B2", chnls) == 4);
+	assert(model->GetRWChannels("Quadrupole.QD.B1", chnls) == 2);
+	RWChannelArray channels(chnls);
+	assert(channels.Size() == 8);
+
+	RealVector values(channels.Size());
+	channels.ReadAll(values);
+	for(size_t i = 0; i < channels.Size(); i++)
+	{
+		assert(values[i] == channels.Read(i));
+		values[i] = 10.0 + i;
+	}
+
+	channels.WriteAll(values);
+	RealVector readback(channels.Size());
+	channels.ReadAll(readback);
+	for(size_t i = 0; i < channels.Size(); i++)
+	{
+		assert(readback[i] == 10.0 + i);
+	}
+
+	// every quadrupole except QFINAL was written once
+	for(size_t q = 0; q < quads.size(); q++)
+	{
+		assert(quads[q]->GetFieldStrength() >= 10.0);
+	}
+
+	vector<RWChannel*> beamline_chnls;
+	AcceleratorModel::Beamline bl = model->GetBeamline();
+	assert(model->GetRWChannels(bl, "Quadrupole.Q*.B1", beamline_chnls) == 5);
+	RWChannelArray beamline_channels(beamline_chnls);
+	RealVector beamline_values(beamline_channels.Size());
+	beamline_channels.ReadAll(beamline_values);
+	assert(beamline_values.size() == 5);
+	assert(beamline_values[4] == 0.5);
+
+	delete model;
+	cout << "all channel tests successful" << endl;
+}
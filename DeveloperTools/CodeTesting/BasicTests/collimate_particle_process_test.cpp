@@ -6,15 +6,18 @@
  */
 
 #include "../tests.h"
+#include <cmath>
 #include <iostream>
 
 #include "AcceleratorModelConstructor.h"
 #include "Components.h"
 #include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
 #include "ParticleBunchTypes.h"
 #include "ParticleTracker.h"
 #include "Aperture.h"
 #include "CollimateParticleProcess.h"
+#include "CollimationOutput.h"
 
 /* Create a bunch of particle, and check that the correct number survive various sized apertures
  *
@@ -22,6 +25,19 @@
 
 using namespace std;
 using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+
+// Records the in-element position of each loss
+class LossPositionOutput: public CollimationOutput
+{
+public:
+	void Dispose(AcceleratorComponent& currcomponent, double pos, Particle& particle, int turn = 0, std::string
+		scatterType = "none")
+	{
+		positions.push_back(pos);
+	}
+	vector<double> positions;
+};
 
 int main(int argc, char* argv[])
 {
@@ -83,6 +99,18 @@ int main(int argc, char* argv[])
 	CollimateParticleProcess* myCollimateProcess = new CollimateParticleProcess(2, 4);
 	tracker->AddProcess(myCollimateProcess);
 
+	// A safety factor below one would skip particles that can be lost
+	bool rejected = false;
+	try
+	{
+		myCollimateProcess->SetEntryStateSafetyFactor(0.5);
+	}
+	catch(MerlinException&)
+	{
+		rejected = true;
+	}
+	assert(rejected);
+
 	drift->SetAperture(rect_app);
 
 	ProtonBunch* test_bunch;
@@ -134,6 +162,59 @@ int main(int argc, char* argv[])
 	assert(test_bunch->size() == 4);
 	delete test_bunch;
 
+	//
+	// Test the loss position of a particle leaving a drift at an angle: x = 20 mrad * s crosses 15 mm at s = 0.75 m
+	//
+	LossPositionOutput* lossOutput = new LossPositionOutput;
+	myCollimateProcess->SetCollimationOutput(lossOutput);
+	pcoords2.clear();
+	pcoords2.push_back(Particle(0));
+	Particle p_angle(0);
+	p_angle.xp() = 20e-3;
+	pcoords2.push_back(p_angle);
+	test_bunch = new ProtonBunch(beam_energy, 1, pcoords2);
+	tracker->Track(test_bunch);
+	assert(test_bunch->size() == 1);
+	assert(lossOutput->positions.size() == 1);
+	cout << "Loss position: " << lossOutput->positions[0] << endl;
+	assert_close(lossOutput->positions[0], 0.75, 1e-3);
+	delete test_bunch;
+
+	//
+	// Test the loss position inside a magnet: in a defocusing quadrupole with K1 = -1/m^2, a particle at
+	// x = 10 mm reaches x = 10 mm * cosh(s) = 15 mm at s = acosh(1.5) m
+	//
+	AcceleratorModelConstructor* qctor = new AcceleratorModelConstructor();
+	double brho = beam_energy / eV / SpeedOfLight;
+	Quadrupole* quad = new Quadrupole("q1", 1 * meter, -1.0 * brho);
+	quad->SetAperture(rect_app4);
+	qctor->AppendComponent(*quad);
+	AcceleratorModel* quadModel = qctor->GetModel();
+	delete qctor;
+
+	ParticleTracker* quadTracker = new ParticleTracker(quadModel->GetBeamline(), myBunch, false);
+	CollimateParticleProcess* quadCollimateProcess = new CollimateParticleProcess(2, 4);
+	LossPositionOutput* quadLossOutput = new LossPositionOutput;
+	quadCollimateProcess->SetCollimationOutput(quadLossOutput);
+	quadTracker->AddProcess(quadCollimateProcess);
+
+	pcoords2.clear();
+	pcoords2.push_back(Particle(0));
+	Particle p_offset(0);
+	p_offset.x() = 10 * millimeter;
+	pcoords2.push_back(p_offset);
+	test_bunch = new ProtonBunch(beam_energy, 1, pcoords2);
+	quadTracker->Track(test_bunch);
+	assert(test_bunch->size() == 1);
+	assert(quadLossOutput->positions.size() == 1);
+	cout << "Loss position in quadrupole: " << quadLossOutput->positions[0] << endl;
+	assert_close(quadLossOutput->positions[0], acosh(1.5), 1e-3);
+	delete test_bunch;
+
+	delete quadTracker;
+	delete quadModel;
+	delete quadLossOutput;
+
 	delete rect_app;
 	delete rect_app2;
 	delete rect_app3;
@@ -0,0 +1,137 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <cmath>
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "BeamData.h"
+#include "ParticleBunch.h"
+#include "ParticleDistributionGenerator.h"
+#include "ParticleTracker.h"
+#include "CollimatorWakeProcess.h"
+#include "CollimatorWakePotentials.h"
+#include "PhysicalUnits.h"
+#include "RandomNG.h"
+
+/* Track a bunch through a collimator wake, change the wake potentials and
+ * track again with the same CollimatorWakeProcess. The kicks must match
+ * those of a fresh process, i.e. the tabulated wakes must not be reused.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace ParticleTracking;
+
+const int modes = 3;
+
+/* Tapered collimator potentials whose inner half gap can be changed */
+class AdjustablePotentials: public CollimatorWakePotentials
+{
+public:
+	AdjustablePotentials(int m, double aa, double bb) :
+		CollimatorWakePotentials(m, 0., 0.), a(aa), b(bb)
+	{
+	}
+	void SetHalfGap(double aa)
+	{
+		a = aa;
+		Changed();
+	}
+	double Wlong(double z, int m) const
+	{
+		return z > 0 ? -(m / a) * Coeff(m) / exp(m * z / a) : 0;
+	}
+	double Wtrans(double z, int m) const
+	{
+		return z > 0 ? Coeff(m) / exp(m * z / a) : 0;
+	}
+	double Wlong(double z) const
+	{
+		return 0;
+	}
+	double Wtrans(double z) const
+	{
+		return 0;
+	}
+
+private:
+	double Coeff(int m) const
+	{
+		return 2 * (1. / pow(a, 2 * m) - 1. / pow(b, 2 * m));
+	}
+	double a, b;
+};
+
+int main()
+{
+	RandomNG::init(1);
+
+	BeamData beam;
+	beam.charge = 1.0e6;
+	beam.beta_x = 3. * meter;
+	beam.beta_y = 10. * meter;
+	beam.emit_x = 0.36 * millimeter;
+	beam.emit_y = 0.16 * millimeter;
+	beam.sig_z = 0.65 * millimeter;
+	beam.p0 = 1.19 * GeV;
+	beam.y0 = 0.5 * millimeter;
+
+	ParticleBunch initial(2000, NormalParticleDistributionGenerator(), beam);
+
+	AcceleratorModelConstructor ctor;
+	ctor.NewModel();
+	ctor.AppendComponent(new Drift("D1", 1.0));
+	Collimator* coll = new Collimator("C1", 0.1, 0.004);
+	ctor.AppendComponent(coll);
+	ctor.AppendComponent(new Drift("D2", 1.0));
+	AcceleratorModel* model = ctor.GetModel();
+
+	AdjustablePotentials* wake = new AdjustablePotentials(modes, 1.0 * millimeter, 5.0 * millimeter);
+	coll->SetWakePotentials(wake);
+
+	// The cached run keeps one process for both bunches
+	CollimatorWakeProcess* cachedProc = new CollimatorWakeProcess(modes, 1, 100, 3);
+	wake->SetExpectedProcess(cachedProc);
+	ParticleTracker cachedTracker(model->GetBeamline(), &initial, false);
+	cachedTracker.AddProcess(cachedProc);
+
+	ParticleBunch before(initial);
+	cachedTracker.Track(&before);
+
+	wake->SetHalfGap(2.0 * millimeter);
+	ParticleBunch cached(initial);
+	cachedTracker.Track(&cached);
+
+	// The fresh run tabulates the changed wake from scratch
+	CollimatorWakeProcess* freshProc = new CollimatorWakeProcess(modes, 1, 100, 3);
+	ParticleTracker freshTracker(model->GetBeamline(), &initial, false);
+	freshTracker.AddProcess(freshProc);
+	ParticleBunch fresh(initial);
+	freshTracker.Track(&fresh);
+
+	assert(cached.size() == fresh.size());
+	double changed = 0;
+	for(size_t i = 0; i < cached.size(); i++)
+	{
+		for(int j = 0; j < 6; j++)
+		{
+			assert_close(cached.GetParticles()[i][j], fresh.GetParticles()[i][j], 1e-18);
+		}
+		changed = max(changed, fabs(cached.GetParticles()[i].yp() - before.GetParticles()[i].yp()));
+	}
+	cout << "Largest change in yp after changing the wake: " << changed << endl;
+
+	// The change must have been visible for the comparison to mean anything
+	assert(changed > 1e-12);
+
+	delete model;
+	delete wake;
+	return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+#include <thread>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "SequenceFrame.h"
+#include "SupportStructure.h"
+#include "ComponentFrame.h"
+
+/* Frame transformations of a lattice of bent girders. Without misalignments
+ * every frame transformation is the identity; moving a girder moves all its
+ * components, and clearing the move restores the identity, so the cached
+ * transformations must follow each change. Threads querying the frames
+ * together must get the same transformations. Moving the supports of a
+ * second model moves its components, while queries on the first model
+ * running at the same time still get its own transformations.
+ */
+
+using namespace std;
+
+// The girders bend horizontally, so a horizontal offset of a girder is rotated
+// into the local frames of its components
+void assert_translation(const Transform3D& t, double dx, double dy)
+{
+	assert_close(t.X().y, dy, 1e-14);
+	assert_close(sqrt(t.X().x * t.X().x + t.X().z * t.X().z), fabs(dx), 1e-14);
+	const Vector3D ez = t.R()(Vector3D(0, 0, 1));
+	assert_close(ez.x, 0, 1e-14);
+	assert_close(ez.y, 0, 1e-14);
+}
+
+int main(int argc, char* argv[])
+{
+	AcceleratorModelConstructor ctor;
+	ctor.NewModel();
+	vector<SequenceFrame*> girders;
+	for(int g = 0; g < 8; g++)
+	{
+		SequenceFrame* girder = new SequenceFrame("GIRDER", SequenceFrame::originAtCenter);
+		ctor.NewFrame(girder);
+		girders.push_back(girder);
+		for(int k = 0; k < 3; k++)
+		{
+			ctor.AppendComponent(new Quadrupole("Q", 0.5, 0.1));
+			ctor.AppendComponent(new SectorBend("B", 2.0, 0.05, 0.0));
+			ctor.AppendComponent(new Drift("D", 0.7));
+		}
+		ctor.EndFrame();
+	}
+	AcceleratorModel* model = ctor.GetModel();
+	AcceleratorModel::Beamline beamline = model->GetBeamline();
+
+	vector<ComponentFrame*> frames(beamline.begin(), beamline.end());
+	assert(frames.size() == 72);
+
+	for(size_t n = 0; n < frames.size(); n++)
+	{
+		assert_translation(frames[n]->GetFrameTransform(), 0, 0);
+	}
+
+	// Move the third girder
+	girders[2]->Translate(1.0e-4, -2.0e-4, 0);
+	for(size_t n = 0; n < frames.size(); n++)
+	{
+		const bool moved = n / 9 == 2;
+		assert_translation(frames[n]->GetFrameTransform(), moved ? 1.0e-4 : 0, moved ? -2.0e-4 : 0);
+	}
+
+	// and one of its components
+	frames[20]->Translate(0, 1.0e-5, 0);
+	assert_translation(frames[20]->GetFrameTransform(), 1.0e-4, -1.9e-4);
+
+	girders[2]->ClearTransform();
+	frames[20]->ClearTransform();
+	for(size_t n = 0; n < frames.size(); n++)
+	{
+		assert_translation(frames[n]->GetFrameTransform(), 0, 0);
+	}
+
+	// Concurrent queries after a change
+	girders[5]->RotateY(1.0e-4);
+	vector<vector<Transform3D> > results(4);
+	vector<thread> threads;
+	for(size_t t = 0; t < results.size(); t++)
+	{
+		threads.push_back(thread([&frames, &results, t]()
+		{
+			for(size_t n = 0; n < frames.size(); n++)
+			{
+				results[t].push_back(frames[n]->GetFrameTransform() * frames[n]->GetPhysicalTransform());
+			}
+		}));
+	}
+	for(size_t t = 0; t < threads.size(); t++)
+	{
+		threads[t].join();
+	}
+	for(size_t n = 0; n < frames.size(); n++)
+	{
+		const Transform3D expected = frames[n]->GetFrameTransform() * frames[n]->GetPhysicalTransform();
+		for(size_t t = 0; t < results.size(); t++)
+		{
+			assert(results[t][n].X() == expected.X());
+		}
+	}
+
+	// A second, straight model on girder mounts
+	ctor.NewModel();
+	for(int g = 0; g < 4; g++)
+	{
+		ctor.NewFrame(new GirderMount("MOUNT"));
+		ctor.AppendComponent(new Quadrupole("Q", 0.5, 0.1));
+		ctor.AppendComponent(new Drift("D", 2.0));
+		ctor.EndFrame();
+	}
+	AcceleratorModel* model2 = ctor.GetModel();
+	AcceleratorModel::Beamline beamline2 = model2->GetBeamline();
+	vector<ComponentFrame*> frames2(beamline2.begin(), beamline2.end());
+	AcceleratorSupportList supports;
+	assert(model2->GetAcceleratorSupports(supports) == 8);
+
+	// Both supports of the second girder move together
+	supports[2]->SetOffset(3.0e-5, 4.0e-5, 0);
+	supports[3]->SetOffset(3.0e-5, 4.0e-5, 0);
+	for(size_t n = 0; n < frames2.size(); n++)
+	{
+		const bool moved = n / 2 == 1;
+		assert_translation(frames2[n]->GetFrameTransform(), moved ? 3.0e-5 : 0, moved ? 4.0e-5 : 0);
+	}
+
+	// Query the first model while the supports of the second keep moving
+	threads.clear();
+	for(size_t t = 0; t < results.size(); t++)
+	{
+		threads.push_back(thread([&frames, &results, t]()
+		{
+			for(int pass = 0; pass < 100; pass++)
+			{
+				for(size_t n = 0; n < frames.size(); n++)
+				{
+					const Transform3D tn = frames[n]->GetFrameTransform() * frames[n]->GetPhysicalTransform();
+					assert(tn.X() == results[t][n].X());
+				}
+			}
+		}));
+	}
+	for(int pass = 0; pass < 1000; pass++)
+	{
+		supports[0]->IncrementOffset(1.0e-9, 0, 0);
+		frames2[0]->GetFrameTransform();
+	}
+	for(size_t t = 0; t < threads.size(); t++)
+	{
+		threads[t].join();
+	}
+
+	supports[0]->Reset();
+	supports[2]->Reset();
+	supports[3]->Reset();
+	for(size_t n = 0; n < frames2.size(); n++)
+	{
+		assert_translation(frames2[n]->GetFrameTransform(), 0, 0);
+	}
+
+	delete model2;
+	delete model;
+	cout << "all lattice frame tests successful" << endl;
+}
@@ -0,0 +1,102 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+#include <limits>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "ParticleBunchTypes.h"
+#include "ParticleTracker.h"
+#include "NANCheckProcess.h"
+#include "SymplecticIntegrators.h"
+
+/* Check that the tracking maps flag invalid and over-amplitude particles,
+ * and that NANCheckProcess culls them, with both integrator sets.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+using namespace ParticleTracking;
+
+const double beam_energy = 7000.0 * GeV;
+
+ProtonBunch* MakeBunch(bool bad)
+{
+	PSvectorArray particles;
+	for(size_t i = 0; i < 10; i++)
+	{
+		Particle p(0);
+		p.x() = 1e-4 * i;
+		p.y() = -1e-4 * i;
+		p.id() = i;
+		particles.push_back(p);
+	}
+	if(bad)
+	{
+		particles[3].xp() = std::numeric_limits<double>::quiet_NaN();
+		particles[7].x() = 0.05;
+	}
+	ProtonBunch* bunch = new ProtonBunch(beam_energy, 1, particles);
+	bunch->SetAmplitudeLimit(0.01);
+	return bunch;
+}
+
+int main(int argc, char* argv[])
+{
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	const double brho = beam_energy / eV / SpeedOfLight;
+	const double h = 1e-3;
+	ctor->AppendComponent(new Quadrupole("q1", 1 * meter, 0.01 * brho));
+	ctor->AppendComponent(new Drift("d1", 2 * meter));
+	ctor->AppendComponent(new SectorBend("b1", 10 * meter, h, brho * h));
+	ctor->AppendComponent(new Drift("d2", 2 * meter));
+	ctor->AppendComponent(new Quadrupole("q2", 1 * meter, -0.01 * brho));
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+
+	for(int symplectic = 0; symplectic < 2; symplectic++)
+	{
+		// A clean bunch is only marked as checked
+		ParticleTracker tracker(model->GetBeamline(), MakeBunch(false), true);
+		if(symplectic)
+		{
+			tracker.SetIntegratorSet(new ParticleTracking::SYMPLECTIC::StdISet());
+		}
+		tracker.Run();
+		assert(tracker.GetTrackedBunch().GetTrackingFlags() == ParticleBunch::checked);
+
+		// The invalid particle and the one beyond the amplitude limit are flagged
+		tracker.SetInitialBunch(MakeBunch(true), true);
+		tracker.Run();
+		ParticleBunch* bunch = &tracker.GetTrackedBunch();
+		assert(bunch->GetTrackingFlags() == (ParticleBunch::checked | ParticleBunch::nonFinite
+			| ParticleBunch::overAmplitude));
+		assert(bunch->size() == 10);
+
+		// and culled by NANCheckProcess
+		tracker.SetInitialBunch(MakeBunch(true), true);
+		NANCheckProcess* nancheck = new NANCheckProcess;
+		nancheck->SetCullNAN();
+		nancheck->SetAmplitudeLimit(0.01);
+		tracker.AddProcess(nancheck);
+		tracker.Run();
+		bunch = &tracker.GetTrackedBunch();
+		assert(bunch->size() == 8);
+		for(auto& p : *bunch)
+		{
+			assert(p.id() != 3 && p.id() != 7);
+		}
+	}
+
+	delete model;
+	cout << "all NAN check tests successful" << endl;
+}
@@ -0,0 +1,89 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "ParallelFor.h"
+
+/* Check that ParallelFor() and ParallelRanges() cover every index once, that
+ * nested loops default to one thread, and that the exception of the lowest
+ * index is rethrown.
+ */
+
+using namespace std;
+
+int main()
+{
+	const size_t n = 1000;
+
+	vector<int> hits(n, 0);
+	ParallelFor(n, 4, [&](size_t i)
+		{
+			hits[i]++;
+		});
+	for(size_t i = 0; i < n; i++)
+	{
+		assert(hits[i] == 1);
+	}
+
+	hits.assign(n, 0);
+	ParallelRanges(n, 4, 3, [&](size_t i0, size_t i1)
+		{
+			for(size_t i = i0; i < i1; i++)
+			{
+				hits[i]++;
+			}
+		});
+	for(size_t i = 0; i < n; i++)
+	{
+		assert(hits[i] == 1);
+	}
+
+	// Outside a loop 0 means one per hardware thread, inside it means one
+	assert(!InParallelLoop());
+	vector<size_t> nested(8, 0);
+	ParallelFor(nested.size(), 2, [&](size_t i)
+		{
+			nested[i] = ParallelThreads(0);
+		});
+	for(size_t i = 0; i < nested.size(); i++)
+	{
+		assert(nested[i] == 1);
+	}
+	assert(!InParallelLoop());
+
+	// A loop on a single thread leaves the default alone
+	size_t serial = 0;
+	ParallelFor(1, 1, [&](size_t)
+		{
+			serial = ParallelThreads(0);
+		});
+	assert(serial == ParallelThreads(0));
+
+	size_t thrown = n;
+	try
+	{
+		ParallelFor(n, 4, [](size_t i)
+			{
+				if(i % 100 == 37)
+				{
+					throw runtime_error(to_string(i));
+				}
+			});
+	}
+	catch(runtime_error& e)
+	{
+		thrown = stoul(e.what());
+	}
+	cout << "Rethrown exception of index " << thrown << endl;
+	assert(thrown == 37);
+
+	return 0;
+}
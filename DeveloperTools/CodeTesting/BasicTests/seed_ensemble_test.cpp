@@ -0,0 +1,147 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "ParticleBunchTypes.h"
+#include "ParticleTracker.h"
+#include "CollimationOutput.h"
+#include "RandomNG.h"
+#include "SeedEnsemble.h"
+
+/* Track the same seeds serially and with a SeedEnsemble sharing one model,
+ * and check that every seed gives an identical bunch.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+using namespace ParticleTracking;
+
+const double beam_energy = 7000.0 * GeV;
+
+class TrackJob: public SeedEnsemble::Job
+{
+public:
+	void Run(AcceleratorModel* model, std::uint32_t seed)
+	{
+		PSvectorArray particles;
+		for(size_t i = 0; i < 500; i++)
+		{
+			Particle p(0);
+			p.x() = RandomNG::normal(0, 1e-6);
+			p.xp() = RandomNG::normal(0, 1e-8);
+			p.y() = RandomNG::normal(0, 1e-6);
+			p.yp() = RandomNG::normal(0, 1e-8);
+			p.dp() = RandomNG::normal(0, 1e-8);
+			particles.push_back(p);
+		}
+		ProtonBunch* bunch = new ProtonBunch(beam_energy, 1, particles);
+		ParticleTracker tracker(model->GetBeamline(), bunch, true);
+		tracker.Run();
+
+		result = tracker.GetTrackedBunch().GetParticles();
+
+		LossData loss;
+		loss.position = result[0].x();
+		output.DeadParticles.push_back(loss);
+	}
+
+	vector<CollimationOutput*> GetCollimationOutputs()
+	{
+		return vector<CollimationOutput*>(1, &output);
+	}
+
+	PSvectorArray result;
+	CollimationOutput output;
+};
+
+int main(int argc, char* argv[])
+{
+	// A lattice whose magnets all take the split map + kick path
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	const double brho = beam_energy / eV / SpeedOfLight;
+	const double h = 1e-3;
+	SectorBend* bend = new SectorBend("b1", 10 * meter, h, brho * h);
+	bend->GetField().SetCoefficient(2, Complex(0.5 * brho * h));
+	Quadrupole* quad = new Quadrupole("q1", 1 * meter, 0.1 * brho);
+	ctor->AppendComponent(quad);
+	ctor->AppendComponent(new Drift("d1", 2 * meter));
+	ctor->AppendComponent(bend);
+	ctor->AppendComponent(new Drift("d2", 2 * meter));
+	ctor->AppendComponent(new Sextupole("s1", 0.5 * meter, 0.2 * brho));
+	ctor->AppendComponent(new Quadrupole("q2", 1 * meter, -0.1 * brho));
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+
+	const Complex b0 = bend->GetField().GetCoefficient(0);
+	const Complex b2 = bend->GetField().GetCoefficient(2);
+
+	// reading a term above the highest multipole must not resize the field,
+	// as worker threads read the shared fields concurrently
+	const MultipoleField& qfield = static_cast<const Quadrupole*>(quad)->GetField();
+	const int highest = qfield.HighestMultipole();
+	assert(qfield.GetCoefficient(highest + 4) == Complex(0));
+	assert(qfield.HighestMultipole() == highest);
+
+	const size_t nseeds = 6;
+
+	vector<PSvectorArray> serial;
+	for(size_t n = 0; n < nseeds; n++)
+	{
+		TrackJob job;
+		RandomNG::init(n + 1);
+		job.Run(model, n + 1);
+		serial.push_back(job.result);
+	}
+
+	// the caller's sequence is not disturbed by the jobs run on its thread
+	RandomNG::init(1234);
+	double expected = RandomNG::uniform(0, 1);
+	RandomNG::init(1234);
+
+	SeedEnsemble ensemble(model, beam_energy, 3);
+	for(size_t n = 0; n < nseeds; n++)
+	{
+		ensemble.AddJob(new TrackJob, n + 1);
+	}
+	ensemble.Run();
+	assert(RandomNG::getSeed() == vector<uint32_t>(1, 1234));
+	assert(RandomNG::uniform(0, 1) == expected);
+
+	for(size_t n = 0; n < nseeds; n++)
+	{
+		const PSvectorArray& result = static_cast<TrackJob*>(ensemble.GetJob(n))->result;
+		assert(result.size() == serial[n].size());
+		for(size_t i = 0; i < result.size(); i++)
+		{
+			assert(result[i] == serial[n][i]);
+		}
+	}
+	// seeds differ, so their bunches should too
+	assert(!(serial[0][0] == serial[1][0]));
+
+	// the shared field is never modified while tracking
+	assert(bend->GetField().GetCoefficient(0) == b0);
+	assert(bend->GetField().GetCoefficient(2) == b2);
+
+	CollimationOutput total;
+	ensemble.MergeCollimationOutputs(total);
+	assert(total.DeadParticles.size() == nseeds);
+	for(size_t n = 0; n < nseeds; n++)
+	{
+		assert(total.DeadParticles[n].position == serial[n][0].x());
+	}
+
+	delete model;
+	cout << "all seed ensemble tests successful" << endl;
+}
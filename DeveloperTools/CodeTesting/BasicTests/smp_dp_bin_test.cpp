@@ -0,0 +1,107 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <cmath>
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "BeamData.h"
+#include "ParallelFor.h"
+#include "SMPBunchConstructor.h"
+#include "SMPTracker.h"
+#include "PhysicalUnits.h"
+
+/* Track SMP bunches through quadrupoles and a solenoid with an exact and a
+ * dp binned integrator set at the same time, and check that the exact run
+ * matches one made on its own, and that the binned run is close to it.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace SMPTracking;
+
+SMPBunch* Track(AcceleratorModel* model, const SMPBunchConstructor& ctor, double dpBinWidth)
+{
+	SMPBunch* bunch = ctor.ConstructSMPBunch();
+	StdISet iset(dpBinWidth);
+	SMPTracker tracker(model->GetBeamline());
+	tracker.SetIntegratorSet(&iset);
+	tracker.Track(bunch);
+	return bunch;
+}
+
+/* Largest difference of the centroids and second moments, relative to the sizes of the first bunch */
+double Difference(const SMPBunch& a, const SMPBunch& b)
+{
+	assert(a.Size() == b.Size());
+	double d = 0;
+	for(size_t n = 0; n < a.Size(); n++)
+	{
+		const SliceMacroParticle& pa = a.Get(n);
+		const SliceMacroParticle& pb = b.Get(n);
+		for(int i = 0; i < 4; i++)
+		{
+			double sig = sqrt(pa(i, i));
+			d = max(d, fabs(pa[i] - pb[i]) / sig);
+			for(int j = 0; j < 4; j++)
+			{
+				d = max(d, fabs(pa(i, j) - pb(i, j)) / (sig * sqrt(pa(j, j))));
+			}
+		}
+	}
+	return d;
+}
+
+int main()
+{
+	AcceleratorModelConstructor mc;
+	mc.NewModel();
+	mc.AppendComponent(new Drift("D1", 1.0));
+	mc.AppendComponent(new Quadrupole("QF", 0.5, 10.0));
+	mc.AppendComponent(new Drift("D2", 1.0));
+	mc.AppendComponent(new Quadrupole("QD", 0.5, -10.0));
+	mc.AppendComponent(new Drift("D3", 1.0));
+	mc.AppendComponent(new Solenoid("S", 1.0, 2.0));
+	AcceleratorModel* model = mc.GetModel();
+
+	BeamData beam;
+	beam.p0 = 1.0 * GeV;
+	beam.beta_x = 5.0 * meter;
+	beam.beta_y = 5.0 * meter;
+	beam.emit_x = 1.0e-9 * meter;
+	beam.emit_y = 1.0e-9 * meter;
+	beam.sig_dp = 1.0e-3;
+	beam.sig_z = 0.3 * millimeter;
+	beam.x0 = 1.0e-5 * meter;
+	beam.y0 = 1.0e-5 * meter;
+	SMPBunchConstructor ctor(beam, 11, 21);
+
+	// The exact and binned trackers run at the same time
+	SMPBunch* bunches[2];
+	const double widths[2] = {0, 1.0e-4};
+	ParallelFor(2, 2, [&](size_t i)
+		{
+			bunches[i] = Track(model, ctor, widths[i]);
+		});
+	SMPBunch* alone = Track(model, ctor, 0);
+
+	double exact = Difference(*alone, *bunches[0]);
+	double binned = Difference(*alone, *bunches[1]);
+	cout << "Largest relative difference: " << exact << " exact, " << binned << " binned" << endl;
+
+	assert(exact == 0);
+	assert(binned > 0);
+	assert(binned < 1e-3);
+
+	delete alone;
+	delete bunches[0];
+	delete bunches[1];
+	delete model;
+	return 0;
+}
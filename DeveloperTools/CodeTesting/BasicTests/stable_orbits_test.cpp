@@ -0,0 +1,94 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <algorithm>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "Aperture.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "StableOrbits.h"
+
+/* Select the stable particles of a bunch in a linear FODO ring with circular
+ * apertures in the quadrupoles. Starting with xp = 0 the particles which
+ * survive are those with the smallest |x|, and the selection must be the
+ * same with one thread and with several.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+
+int main(int argc, char* argv[])
+{
+	const double p0 = 10.0 * GeV;
+	const double brho = p0 / eV / SpeedOfLight;
+
+	AcceleratorModelConstructor ctor;
+	ctor.NewModel();
+	for(int cell = 0; cell < 20; cell++)
+	{
+		for(int half = 0; half < 2; half++)
+		{
+			Quadrupole* q = new Quadrupole("Q", 0.5 * meter, (half ? -0.3 : 0.3) * brho);
+			q->SetAperture(new CircularAperture(5.0 * millimeter));
+			ctor.AppendComponent(q);
+			ctor.AppendComponent(new Drift("D", 4.5 * meter));
+		}
+	}
+	AcceleratorModel* model = ctor.GetModel();
+
+	ParticleBunch bunch(p0, 1.0);
+	const size_t np = 200;
+	for(size_t n = 0; n < np; n++)
+	{
+		Particle p(0);
+		p.x() = ((n % 2) ? -1.0 : 1.0) * (n * 7 % np) * 0.05 * millimeter;
+		p.y() = 0.5 * millimeter;
+		bunch.push_back(p);
+	}
+
+	StableOrbits so(model);
+	so.SetTurns(20);
+	vector<size_t> stable = so.SelectStable(bunch);
+	assert(bunch.size() == np);
+	assert(stable.size() > 10 && stable.size() < np - 10);
+	assert(is_sorted(stable.begin(), stable.end()));
+
+	// The survivors are the particles of smallest amplitude
+	double max_stable = 0, min_lost = 1;
+	for(size_t n = 0, k = 0; n < np; n++)
+	{
+		const double x = fabs(bunch.GetParticles()[n].x());
+		if(k < stable.size() && stable[k] == n)
+		{
+			max_stable = max(max_stable, x);
+			k++;
+		}
+		else
+		{
+			min_lost = min(min_lost, x);
+		}
+	}
+	assert(max_stable < min_lost);
+
+	// Several threads, through the index list
+	so.SetThreads(3);
+	list<size_t> index;
+	so.SelectStable(bunch, &index);
+	assert(vector<size_t>(index.begin(), index.end()) == stable);
+	assert(bunch.size() == np);
+
+	cout << stable.size() << " of " << np << " particles stable" << endl;
+	delete model;
+	cout << "all stable orbits tests successful" << endl;
+}
@@ -0,0 +1,84 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "ParticleBunchTypes.h"
+#include "ParticleTracker.h"
+#include "StdIntegrators.h"
+#include "SymplecticIntegrators.h"
+#include "RandomNG.h"
+
+/* Track a bunch with the standard integrator sets and with their static
+ * equivalents, and check that the results are identical.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+using namespace ParticleTracking;
+
+const double beam_energy = 7000.0 * GeV;
+
+PSvectorArray Track(AcceleratorModel* model, PSvectorArray particles,
+	const ParticleTracker::integrator_set_base& iset)
+{
+	ProtonBunch* bunch = new ProtonBunch(beam_energy, 1, particles);
+	ParticleTracker tracker(model->GetBeamline(), bunch, true);
+	tracker.SetIntegratorSet(&iset);
+	tracker.Run();
+	return tracker.GetTrackedBunch().GetParticles();
+}
+
+void Compare(const PSvectorArray& a, const PSvectorArray& b)
+{
+	assert(a.size() == b.size());
+	for(size_t i = 0; i < a.size(); i++)
+	{
+		assert(a[i] == b[i]);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	const double brho = beam_energy / eV / SpeedOfLight;
+	const double h = 1e-3;
+	ctor->AppendComponent(new Quadrupole("q1", 1 * meter, 0.1 * brho));
+	ctor->AppendComponent(new Drift("d1", 2 * meter));
+	ctor->AppendComponent(new SectorBend("b1", 10 * meter, h, brho * h));
+	ctor->AppendComponent(new Marker("m1"));
+	ctor->AppendComponent(new Sextupole("s1", 0.5 * meter, 0.2 * brho));
+	ctor->AppendComponent(new Quadrupole("q2", 1 * meter, -0.1 * brho));
+	ctor->AppendComponent(new Drift("d2", 2 * meter));
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+
+	RandomNG::init(1);
+	PSvectorArray particles;
+	for(size_t i = 0; i < 100; i++)
+	{
+		Particle p(0);
+		p.x() = RandomNG::normal(0, 1e-4);
+		p.xp() = RandomNG::normal(0, 1e-6);
+		p.y() = RandomNG::normal(0, 1e-4);
+		p.yp() = RandomNG::normal(0, 1e-6);
+		p.dp() = RandomNG::normal(0, 1e-4);
+		particles.push_back(p);
+	}
+
+	Compare(Track(model, particles, TRANSPORT::StdISet()), Track(model, particles, TRANSPORT::FixedISet()));
+	Compare(Track(model, particles, SYMPLECTIC::StdISet()), Track(model, particles, SYMPLECTIC::FixedISet()));
+
+	delete model;
+	cout << "all static integrator set tests successful" << endl;
+}
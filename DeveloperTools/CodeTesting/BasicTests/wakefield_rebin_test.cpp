@@ -0,0 +1,151 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <cmath>
+#include <iostream>
+#include <map>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "ParticleBunch.h"
+#include "ParticleTracker.h"
+#include "WakeFieldProcess.h"
+#include "WakePotentials.h"
+#include "PhysicalUnits.h"
+#include "RandomNG.h"
+
+/* Track a bunch through a line of drifts, each with a wake, once binning
+ * the bunch again at every wake and once reusing the binning, and check
+ * that the kicks agree.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace ParticleTracking;
+
+/* Wake of a TESLA cavity */
+class CavityWake: public WakePotentials
+{
+public:
+	double Wlong(double z) const
+	{
+		return 38.1e+12 * (1.165 * exp(-sqrt(z / 3.65e-3)) - 0.165);
+	}
+	double Wtrans(double z) const
+	{
+		double arZ = sqrt(z / 0.92e-03);
+		return 1.21e14 * (1.0 - (1.0 + arZ) * exp(-arZ));
+	}
+};
+
+/* Counts the binnings, each of which calculates the longitudinal wake.
+ * A negative tolerance keeps the default.
+ */
+class CountingWakeProcess: public WakeFieldProcess
+{
+public:
+	CountingWakeProcess(double tolerance) :
+		WakeFieldProcess(1), binnings(0)
+	{
+		if(tolerance >= 0)
+		{
+			SetRebinTolerance(tolerance);
+		}
+	}
+	size_t binnings;
+
+protected:
+	void CalculateWakeL()
+	{
+		binnings++;
+		WakeFieldProcess::CalculateWakeL();
+	}
+};
+
+map<int, PSvector> Track(AcceleratorModel* model, const PSvectorArray& initial, double tolerance, size_t& binnings)
+{
+	PSvectorArray particles(initial);
+	ParticleBunch bunch(5.0 * GeV, 2.0e10, particles);
+	CountingWakeProcess* proc = new CountingWakeProcess(tolerance);
+	ParticleTracker tracker(model->GetBeamline(), &bunch, false);
+	tracker.AddProcess(proc);
+	tracker.Track(&bunch);
+	binnings = proc->binnings;
+
+	map<int, PSvector> result;
+	for(ParticleBunch::const_iterator p = bunch.begin(); p != bunch.end(); p++)
+	{
+		result[static_cast<int>(p->id())] = *p;
+	}
+	return result;
+}
+
+int main()
+{
+	RandomNG::init(1);
+
+	const size_t ncell = 10;
+	CavityWake* wake = new CavityWake;
+	AcceleratorModelConstructor ctor;
+	ctor.NewModel();
+	for(size_t n = 0; n < ncell; n++)
+	{
+		Drift* d = new Drift("D", 1.0);
+		d->SetWakePotentials(wake);
+		ctor.AppendComponent(d);
+	}
+	AcceleratorModel* model = ctor.GetModel();
+
+	PSvectorArray initial;
+	for(size_t i = 0; i < 2000; i++)
+	{
+		PSvector p(0);
+		p.x() = RandomNG::normal(0, 1e-8);
+		p.xp() = RandomNG::normal(0, 1e-12);
+		p.y() = RandomNG::normal(2e-4, 1e-8);
+		p.yp() = RandomNG::normal(0, 1e-12);
+		// within the binning range, so that no particles are truncated
+		p.ct() = RandomNG::normal(0, 9e-8, 2);
+		p.id() = i;
+		initial.push_back(p);
+	}
+
+	size_t freshBinnings, reusedBinnings;
+	map<int, PSvector> fresh = Track(model, initial, 0, freshBinnings);
+	map<int, PSvector> reused = Track(model, initial, -1, reusedBinnings);
+	cout << "Binnings: " << freshBinnings << " fresh, " << reusedBinnings << " reused" << endl;
+
+	// The drifts move the particles in ct, so only the run with the default tolerance skips binnings
+	assert(freshBinnings == ncell);
+	assert(reusedBinnings < freshBinnings);
+
+	assert(fresh.size() == reused.size());
+	double kick = 0;
+	double ddp = 0;
+	for(map<int, PSvector>::const_iterator f = fresh.begin(); f != fresh.end(); f++)
+	{
+		kick = max(kick, fabs(f->second.yp() - initial[f->first].yp()));
+		ddp = max(ddp, fabs(f->second.dp()));
+	}
+	cout << "Largest kicks: " << kick << " in yp, " << ddp << " in dp" << endl;
+	assert(kick > 1e-9);
+
+	// The fresh binning range follows the bunch as it moves in ct, so the
+	// wakes agree to well within the slicing error rather than exactly
+	for(map<int, PSvector>::const_iterator f = fresh.begin(); f != fresh.end(); f++)
+	{
+		const PSvector& r = reused[f->first];
+		assert_close(f->second.yp(), r.yp(), 1e-6 * kick);
+		assert_close(f->second.dp(), r.dp(), 1e-6 * ddp);
+		assert_close(f->second.y(), r.y(), 1e-6 * kick);
+	}
+
+	delete model;
+	delete wake;
+	return 0;
+}
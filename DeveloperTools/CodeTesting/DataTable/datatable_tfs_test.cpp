@@ -56,6 +56,40 @@ void write_read(DataTable dt)
 	}
 }
 
+void write_format()
+{
+	cout << "write_format()" << endl;
+	stringstream ss;
+
+	auto dt = make_example_dt();
+	DataTableWriterTFS(&ss).Write(dt);
+
+	const string expected =
+		"@ x                %le 9.9               \n"
+		"@ y                %d 9       \n"
+		"@ z                %4s \"test\"\n"
+		"* a b c \n"
+		"$ %s %le %d \n"
+		" \"alpha\" 1.1                1       \n"
+		" \"beta\" 2.1                -2      \n"
+		" \"gamma\" 3.1                100     \n";
+	assert(ss.str() == expected);
+}
+
+void write_threads()
+{
+	cout << "write_threads()" << endl;
+
+	auto dt = DataTableReaderTFS(find_data_file("twiss.7.0tev.b1_new.tfs")).Read();
+
+	stringstream ss1, ss3;
+	DataTableWriterTFS(&ss1).Write(dt);
+	DataTableWriterTFS writer(&ss3);
+	writer.SetThreads(3);
+	writer.Write(dt);
+	assert(ss1.str() == ss3.str());
+}
+
 void read_big()
 {
 	cout << "read_big()" << endl;
@@ -74,12 +108,31 @@ void read_big()
 	assert_close(dt.Get_d("S", 4), 2.0915000000000003E+01, 1e-8);
 }
 
+void read_threads()
+{
+	cout << "read_threads()" << endl;
+
+	string lattice_path = find_data_file("twiss.7.0tev.b1_new.tfs");
+	auto dt1 = DataTableReaderTFS(lattice_path).Read();
+	DataTableReaderTFS reader(lattice_path);
+	reader.SetThreads(3);
+	auto dt3 = reader.Read();
+
+	stringstream ss1, ss3;
+	DataTableWriterTFS(&ss1).Write(dt1);
+	DataTableWriterTFS(&ss3).Write(dt3);
+	assert(ss1.str() == ss3.str());
+}
+
 int main()
 {
 	auto dt1 = make_example_dt();
 
 	write_read(dt1);
+	write_format();
 	read_big();
+	write_threads();
+	read_threads();
 
 	return 0;
 }
@@ -0,0 +1,126 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+#include <cmath>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "NumericalConstants.h"
+#include "ParticleBunchTypes.h"
+#include "ParticleTracker.h"
+#include "TransferMatrix.h"
+#include "BPMTurnByTurnBuffer.h"
+
+/* Record turn-by-turn BPM readings of a kicked particle in a ring of identical
+ * FODO cells, and check the harmonic analysis against the one turn matrix.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+using namespace ParticleTracking;
+
+int main(int argc, char* argv[])
+{
+	const double beam_energy = 450.0 * GeV;
+	const double brho = beam_energy / eV / SpeedOfLight;
+	const int ncells = 12;
+	const double h = twoPi / (2 * ncells * 5 * meter);
+
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	vector<BPM*> bpms;
+	for(int cell = 0; cell < ncells; cell++)
+	{
+		bpms.push_back(new BPM("bpm"));
+		ctor->AppendComponent(bpms.back());
+		ctor->AppendComponent(new Quadrupole("qf", 0.5 * meter, 0.05 * brho));
+		ctor->AppendComponent(new SectorBend("mb", 5 * meter, h, brho * h));
+		ctor->AppendComponent(new Quadrupole("qd", 0.5 * meter, -0.05 * brho));
+		ctor->AppendComponent(new SectorBend("mb", 5 * meter, h, brho * h));
+	}
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+
+	// expected tunes from the one turn matrix
+	RealMatrix M(6);
+	TransferMatrix tm(model, beam_energy);
+	tm.FindTM(M);
+	double qx = acos((M(0, 0) + M(1, 1)) / 2) / twoPi;
+	double qy = acos((M(2, 2) + M(3, 3)) / 2) / twoPi;
+	qx = M(0, 1) > 0 ? qx : 1 - qx;
+	qy = M(2, 3) > 0 ? qy : 1 - qy;
+	qx = min(qx, 1 - qx);
+	qy = min(qy, 1 - qy);
+
+	const size_t nturns = 512;
+	BPMTurnByTurnBuffer tbt(nturns);
+	for(size_t i = 0; i < bpms.size(); i++)
+	{
+		bpms[i]->AddBuffer(&tbt);
+	}
+
+	Particle p(0);
+	p.x() = 1e-5;
+	p.y() = -2e-5;
+	PSvectorArray particles(1, p);
+	ProtonBunch* bunch = new ProtonBunch(beam_energy, 1, particles);
+	ParticleTracker tracker(model->GetBeamline(), bunch, false);
+	for(size_t turn = 0; turn < nturns + 10; turn++)
+	{
+		tracker.Track(bunch);
+	}
+
+	assert(tbt.GetNumberOfBPMs() == size_t(ncells));
+	assert(tbt.GetNumberOfTurns(0) == nturns);
+	assert(tbt.GetReadings(0, ps_X)[0] == 1e-5);
+	assert(tbt.GetReadings(0, ps_Y)[0] == -2e-5);
+
+	tbt.Analyse(2);
+	assert_close(tbt.GetTune(ps_X), qx, 1e-6);
+	assert_close(tbt.GetTune(ps_Y), qy, 1e-6);
+
+	// identical cells: equal phase advances, whose sum over the ring has the
+	// fractional part of the tune, and no beta-beating
+	vector<double> mux = tbt.GetPhaseAdvances(ps_X);
+	vector<double> muy = tbt.GetPhaseAdvances(ps_Y);
+	vector<double> beat = tbt.GetBetaBeating(ps_X, vector<double>(ncells, 1.0));
+	assert(mux.size() == size_t(ncells - 1));
+	for(size_t i = 0; i < mux.size(); i++)
+	{
+		assert_close(mux[i], mux[0], 1e-6);
+		assert_close(muy[i], muy[0], 1e-6);
+	}
+	assert_close(fmod(ncells * mux[0], 1.0), qx, 1e-5);
+	assert_close(fmod(ncells * muy[0], 1.0), qy, 1e-5);
+	for(size_t i = 0; i < beat.size(); i++)
+	{
+		assert_close(beat[i], 0, 1e-6);
+	}
+
+	// with a decimation of 2 every other turn is kept
+	BPMTurnByTurnBuffer tbt2(16, 2);
+	bpms[0]->AddBuffer(&tbt2);
+	vector<double> xs;
+	for(size_t turn = 0; turn < 32; turn++)
+	{
+		xs.push_back(bunch->GetParticles()[0].x());
+		tracker.Track(bunch);
+	}
+	assert(tbt2.GetNumberOfBPMs() == 1);
+	assert(tbt2.GetNumberOfTurns(0) == 16);
+	for(size_t i = 0; i < 16; i++)
+	{
+		assert(tbt2.GetReadings(0, ps_X)[i] == xs[2 * i]);
+	}
+
+	delete model;
+	cout << "all turn by turn tests successful" << endl;
+}
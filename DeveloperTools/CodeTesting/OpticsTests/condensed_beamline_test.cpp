@@ -0,0 +1,157 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "ParticleBunchTypes.h"
+#include "ParticleTracker.h"
+#include "CondensedBeamline.h"
+#include "Aperture.h"
+#include "CollimateParticleProcess.h"
+
+/* Track a bunch through a FODO line element by element, and through the same line
+ * with most cells condensed into a map. Small amplitude particles must agree to
+ * second order, and particles beyond the validity amplitude must be tracked exactly,
+ * keeping their place in the bunch. With apertures, the particles that can reach
+ * them must be lost by the collimation process of the fall-back tracker.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+using namespace ParticleTracking;
+
+int main(int argc, char* argv[])
+{
+	const double beam_energy = 450.0 * GeV;
+	const double brho = beam_energy / eV / SpeedOfLight;
+	const double h = 1e-3;
+
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	for(int cell = 0; cell < 8; cell++)
+	{
+		ctor->AppendComponent(new Quadrupole("qf", 0.5 * meter, 0.05 * brho));
+		ctor->AppendComponent(new Sextupole("sf", 0.2 * meter, 0.5 * brho));
+		ctor->AppendComponent(new SectorBend("mb", 5 * meter, h, brho * h));
+		ctor->AppendComponent(new Quadrupole("qd", 0.5 * meter, -0.05 * brho));
+		ctor->AppendComponent(new Sextupole("sd", 0.2 * meter, -0.5 * brho));
+		ctor->AppendComponent(new SectorBend("mb", 5 * meter, h, brho * h));
+	}
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+
+	CondensedBeamline condensed(model, beam_energy);
+	condensed.Condense(6, 41);
+	condensed.SetValidityAmplitude(1e-3, 1e-3);
+	condensed.Build();
+	assert(condensed.size() == 48 - 36 + 1);
+
+	// small amplitudes (last column 1) take the map, large ones fall back to element tracking
+	double coords[][6] =
+	{
+		{1e-5, 0, 0, 0, 0, 1},
+		{5e-3, 0, 0, 0, 0, 0},
+		{0, 1e-7, -1e-5, 0, 0, 1},
+		{2e-5, 0, 1e-5, 1e-7, 1e-4, 1},
+		{0, 0, 4e-3, 1e-6, 1e-4, 0},
+		{-1e-5, 0, 0, -1e-7, -2e-4, 1},
+	};
+	size_t npart = sizeof(coords) / sizeof(coords[0]);
+
+	PSvectorArray particles;
+	for(size_t i = 0; i < npart; i++)
+	{
+		Particle p(0);
+		p.x() = coords[i][0];
+		p.xp() = coords[i][1];
+		p.y() = coords[i][2];
+		p.yp() = coords[i][3];
+		p.dp() = coords[i][4];
+		particles.push_back(p);
+	}
+
+	const PSvectorArray initial = particles;
+	PSvectorArray particles2 = particles;
+	ProtonBunch* full_bunch = new ProtonBunch(beam_energy, 1, particles);
+	ProtonBunch* condensed_bunch = new ProtonBunch(beam_energy, 1, particles2);
+
+	ParticleTracker full_tracker(model->GetBeamline());
+	full_tracker.Track(full_bunch);
+	ParticleTracker condensed_tracker(condensed.GetBeamline());
+	condensed_tracker.Track(condensed_bunch);
+
+	assert(condensed_bunch->size() == npart);
+	// the map advances the reference time by the length of the section it replaces
+	assert_close(condensed_bunch->GetReferenceTime(), full_bunch->GetReferenceTime(), 1e-9);
+	for(size_t i = 0; i < npart; i++)
+	{
+		const Particle& p1 = full_bunch->GetParticles()[i];
+		const Particle& p2 = condensed_bunch->GetParticles()[i];
+		for(int k = 0; k < 6; k++)
+		{
+			if(coords[i][5] != 0)
+			{
+				assert_close(p1[k], p2[k], 1e-7);
+			}
+			else
+			{
+				assert(p1[k] == p2[k]);
+			}
+		}
+	}
+
+	delete full_bunch;
+	delete condensed_bunch;
+
+	// with apertures in the condensed section, the large amplitudes are lost there
+	CircularAperture aperture(3e-3);
+	AcceleratorModel::Beamline bl = model->GetBeamline(6, 41);
+	for(AcceleratorModel::BeamlineIterator f = bl.begin(); f != bl.end(); f++)
+	{
+		(*f)->GetComponent().SetAperture(&aperture);
+	}
+
+	ParticleTracker fallback_tracker(model->GetBeamline());
+	CollimateParticleProcess* fallback_collimation = new CollimateParticleProcess(2, 4);
+	fallback_collimation->SetLossThreshold(101);
+	fallback_tracker.AddProcess(fallback_collimation);
+	condensed.SetFallbackTracker(&fallback_tracker);
+	condensed.Build();
+
+	PSvectorArray particles3 = initial;
+	PSvectorArray particles4 = initial;
+	full_bunch = new ProtonBunch(beam_energy, 1, particles3);
+	condensed_bunch = new ProtonBunch(beam_energy, 1, particles4);
+
+	ParticleTracker full_tracker2(model->GetBeamline());
+	full_tracker2.AddProcess(new CollimateParticleProcess(2, 4));
+	full_tracker2.Track(full_bunch);
+	ParticleTracker condensed_tracker2(condensed.GetBeamline());
+	condensed_tracker2.AddProcess(new CollimateParticleProcess(2, 4));
+	condensed_tracker2.Track(condensed_bunch);
+
+	assert(full_bunch->size() == 4);
+	assert(condensed_bunch->size() == full_bunch->size());
+	assert_close(condensed_bunch->GetReferenceTime(), full_bunch->GetReferenceTime(), 1e-9);
+	for(size_t i = 0; i < full_bunch->size(); i++)
+	{
+		for(int k = 0; k < 6; k++)
+		{
+			assert_close(full_bunch->GetParticles()[i][k], condensed_bunch->GetParticles()[i][k], 1e-7);
+		}
+	}
+
+	delete full_bunch;
+	delete condensed_bunch;
+	delete model;
+	cout << "all condensed beamline tests successful" << endl;
+}
@@ -0,0 +1,195 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+#include <sstream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "ParticleBunchTypes.h"
+#include "ParticleTracker.h"
+#include "RandomNG.h"
+#include "TLASimp.h"
+#include "DispersionFreeSteering.h"
+
+/* Dispersion free steering of a FODO line with random vertical kicks. The
+ * correction must remove most of the orbit and dispersion, agree with a plain
+ * SVD of the whole weighted response matrix, and be the same for one thread
+ * and for one thread per state, and through a shared design response.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+using namespace ParticleTracking;
+
+const double p0 = 10.0 * GeV;
+
+class BeamState: public DispersionFreeSteering::EnergyState
+{
+public:
+	BeamState(AcceleratorModel* m, double p) :
+		model(m), p(p)
+	{
+	}
+	void Track()
+	{
+		ParticleTracker tracker(model->GetBeamline(), Particle(0), p);
+		tracker.Run();
+	}
+	AcceleratorModel* model;
+	double p;
+};
+
+// Counts the readings it is sent
+class CountingBuffer: public BPM::Buffer
+{
+public:
+	CountingBuffer() :
+		count(0)
+	{
+	}
+	void Record(const BPM& aBPM, const BPM::Data& data)
+	{
+		count++;
+	}
+	size_t count;
+};
+
+AcceleratorModel* BuildLine()
+{
+	const double brho = p0 / eV / SpeedOfLight;
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	for(int cell = 0; cell < 20; cell++)
+	{
+		for(int half = 0; half < 2; half++)
+		{
+			ostringstream n;
+			n << cell << "_" << half;
+			ctor->AppendComponent(new Quadrupole("Q" + n.str(), 0.5 * meter, (half ? -0.4 : 0.4) * brho));
+			ctor->AppendComponent(new YCor("ERR" + n.str(), 0.1 * meter, RandomNG::normal(0, 1) * 1e-5 * brho));
+			ctor->AppendComponent(new Drift("D", 2.0 * meter));
+			ctor->AppendComponent(new YCor("YC" + n.str(), 0.1 * meter));
+			ctor->AppendComponent(new BPM("BPM" + n.str()));
+		}
+	}
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+	return model;
+}
+
+int main(int argc, char* argv[])
+{
+	RandomNG::init(42);
+	AcceleratorModel* model = BuildLine();
+
+	vector<BPM*> bpms;
+	model->ExtractTypedElements(bpms, "BPM*");
+	vector<RWChannel*> chnls;
+	model->GetRWChannels("YCor.YC*.B0", chnls);
+	RWChannelArray cors(chnls);
+	assert(bpms.size() == 40 && cors.Size() == 40);
+
+	// The reference orbit is that of the line without errors
+	vector<RWChannel*> err_chnls;
+	model->GetRWChannels("YCor.ERR*.B0", err_chnls);
+	RWChannelArray errs(err_chnls);
+	RealVector errors(errs.Size());
+	errs.ReadAll(errors);
+	errs.WriteAll(0.0);
+
+	// The DFS objects detach from the BPMs before the model is deleted
+	{
+		DispersionFreeSteering dfs(model, bpms, ps_Y, cors);
+		dfs.AddEnergyState(new BeamState(model, p0));
+		dfs.AddEnergyState(new BeamState(model, 0.9 * p0));
+		dfs.AddEnergyState(new BeamState(model, 1.1 * p0));
+		dfs.SetWeights(1.0, 10.0);
+		dfs.CalculateResponse();
+
+		errs.WriteAll(errors);
+
+		RealVector x = dfs.CalculateCorrection();
+		const double dev0 = dfs.GetRMSDeviation();
+		assert(dev0 > 1e-5);
+
+		// Same as a plain weighted SVD of the whole response, as in the ILCDFS example
+		const RealMatrix& M = dfs.GetResponseMatrix();
+		RealVector w(M.nrows());
+		w = 10.0;
+		w[Range(0, bpms.size() - 1)] = 1.0;
+		TLAS::SVDMatrix<double> svd(M, w);
+		RealVector xsvd = svd(dfs.GetDeviation());
+		double norm = 0;
+		for(size_t c = 0; c < x.size(); c++)
+		{
+			norm = max(norm, fabs(x[c]));
+		}
+		for(size_t c = 0; c < x.size(); c++)
+		{
+			assert(fabs(x[c] - xsvd[c]) < 1e-9 * norm);
+		}
+
+		// One thread, with the response of dfs
+		vector<RWChannel*> chnls1;
+		model->GetRWChannels("YCor.YC*.B0", chnls1);
+		RWChannelArray cors1(chnls1);
+		DispersionFreeSteering serial(model, bpms, ps_Y, cors1, 1);
+		serial.AddEnergyState(new BeamState(model, p0));
+		serial.AddEnergyState(new BeamState(model, 0.9 * p0));
+		serial.AddEnergyState(new BeamState(model, 1.1 * p0));
+		serial.SetWeights(1.0, 10.0);
+		serial.SetResponse(dfs);
+		RealVector x1 = serial.CalculateCorrection();
+		for(size_t c = 0; c < x.size(); c++)
+		{
+			assert(x[c] == x1[c]);
+		}
+
+		// With BPM noise the readings follow the caller's seed, whatever the threads, and
+		// another buffer on the BPMs is sent the readings of the nominal state only
+		CountingBuffer other;
+		for(size_t b = 0; b < bpms.size(); b++)
+		{
+			bpms[b]->SetResolution(0, 1e-6);
+			bpms[b]->AddBuffer(&other);
+		}
+		RandomNG::init(7);
+		RealVector r(dfs.RecordTrajectories());
+		assert(other.count == bpms.size());
+		RandomNG::init(7);
+		const RealVector& r1 = serial.RecordTrajectories();
+		RealVector r2(dfs.RecordTrajectories());
+		double diff = 0;
+		for(size_t i = 0; i < r.size(); i++)
+		{
+			assert(r[i] == r1[i]);
+			diff = max(diff, fabs(r[i] - r2[i]));
+		}
+		// a second recording has fresh noise
+		assert(diff > 1e-8);
+		for(size_t b = 0; b < bpms.size(); b++)
+		{
+			bpms[b]->SetResolution(0, 0);
+			bpms[b]->RemoveBuffer(&other);
+		}
+
+		for(int iter = 0; iter < 3; iter++)
+		{
+			dfs.ApplyCorrection();
+			dfs.CalculateCorrection();
+			cout << "iteration " << iter << " deviation " << dfs.GetRMSDeviation() << " (initially " << dev0 << ")" << endl;
+		}
+		assert(dfs.GetRMSDeviation() < 1e-2 * dev0);
+	}
+
+	delete model;
+	cout << "all DFS tests successful" << endl;
+}
@@ -193,6 +193,30 @@ int main(int argc, char* argv[])
 		xm++;
 	}
 
+	// indexed lookups agree with the rows they index
+	const vector<double>& spos = twiss_table->Column(0, 0, 0);
+	const vector<double>& betx = twiss_table->Column(1, 1, 1);
+	for(size_t n = 1; n + 1 < spos.size(); n++)
+	{
+		int row = twiss_table->GetSPosIndex(spos[n]);
+		assert(spos[row] == spos[n] && (row == 0 || spos[row - 1] < spos[n]));
+		int n1, n2;
+		twiss_table->GetSPosRange(spos[n], n1, n2);
+		assert(n1 == row && n2 > int(n) && (n2 == int(spos.size()) || spos[n2] > spos[n]));
+		if(spos[n + 1] > spos[n])
+		{
+			double mid = twiss_table->Interpolate(1, 1, 1, 0.5 * (spos[n] + spos[n + 1]));
+			assert_close(mid, 0.5 * (betx[n] + betx[n + 1]), 1e-9 * betx[n]);
+		}
+	}
+	x = 0;
+	for(const auto &bi : model->GetBeamline())
+	{
+		int row = twiss_table->GetRowIndex(bi->GetComponent().GetName());
+		assert(row >= 0 && row <= int(x));
+		x++;
+	}
+
 	delete myMADinterface;
 	delete model;
 	delete twiss_table;
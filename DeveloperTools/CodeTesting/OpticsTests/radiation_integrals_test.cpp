@@ -0,0 +1,119 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+
+#include "AcceleratorModelConstructor.h"
+#include "Components.h"
+#include "PhysicalUnits.h"
+#include "PhysicalConstants.h"
+#include "NumericalConstants.h"
+#include "TransferMatrix.h"
+#include "RadiationIntegrals.h"
+#include "EquilibriumDistribution.h"
+
+/* Radiation integrals of an electron FODO ring with combined function bends.
+ * I2 and I3 are known exactly, I1 must match the path length of the off-momentum
+ * closed orbit from the one-turn matrix, and splitting each bend into slices must not change any integral. With
+ * a weak RF cavity the horizontal mode integral of the eigenvector method is I5/2, and the emittance from the
+ * integrals agrees with that of EquilibriumDistribution::CalculateEmittance().
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace PhysicalConstants;
+
+const int ncells = 16;
+const double h = pi / ncells / 2.0;
+
+AcceleratorModel* BuildRing(double p0, int nslice, double rf = 0)
+{
+	const double brho = p0 / eV / SpeedOfLight;
+	const double lbend = 2.0 * meter;
+
+	AcceleratorModelConstructor* ctor = new AcceleratorModelConstructor();
+	for(int cell = 0; cell < ncells; cell++)
+	{
+		for(int half = 0; half < 2; half++)
+		{
+			ctor->AppendComponent(new Quadrupole(half ? "QD" : "QF", 0.3 * meter, (half ? -0.6 : 0.6) * brho));
+			ctor->AppendComponent(new Drift("D", 1.0 * meter));
+			for(int n = 0; n < nslice; n++)
+			{
+				SectorBend* mb = new SectorBend("MB", lbend / nslice, h, brho * h);
+				mb->SetB1(0.01 * brho);
+				ctor->AppendComponent(mb);
+			}
+			ctor->AppendComponent(new Drift("D", 1.0 * meter));
+		}
+	}
+	if(rf != 0)
+	{
+		ctor->AppendComponent(new TWRFStructure("RF", 1.0 * meter, 500 * MHz, rf, pi / 2));
+	}
+	AcceleratorModel* model = ctor->GetModel();
+	delete ctor;
+	return model;
+}
+
+int main(int argc, char* argv[])
+{
+	const double p0 = 3.0 * GeV;
+
+	AcceleratorModel* model = BuildRing(p0, 1);
+	RadiationIntegrals ri(model, p0);
+	ri.Calculate();
+
+	assert_close(ri.I(2), twoPi * h, 1e-12);
+	assert_close(ri.I(3), twoPi * h * h, 1e-12);
+	assert(ri.I(1) > 0 && ri.I(5) > 0);
+
+	RealMatrix M(6);
+	TransferMatrix tm(model, p0);
+	tm.FindTM(M);
+	const double dct = M(4, 0) * ri.DispersionX() + M(4, 1) * ri.DispersionPX() + M(4, 5);
+	assert_close(fabs(dct) / ri.I(1), 1.0, 1e-6);
+
+	// the focusing gradient of the bends lowers the horizontal damping partition
+	assert(ri.DampingPartition(0) < 1 && ri.DampingPartition(2) > 2);
+	assert_close(ri.DampingPartition(0) + ri.DampingPartition(1) + ri.DampingPartition(2), 4.0, 1e-12);
+
+	AcceleratorModel* sliced = BuildRing(p0, 10);
+	RadiationIntegrals ri_sliced(sliced, p0);
+	ri_sliced.Calculate(1);
+	for(int n = 1; n <= 5; n++)
+	{
+		cout << "I" << n << " " << ri.I(n) << " " << ri_sliced.I(n) << endl;
+		assert_close(ri.I(n) / ri_sliced.I(n), 1.0, 1e-9);
+	}
+	assert_close(ri.BetaX() / ri_sliced.BetaX(), 1.0, 1e-9);
+
+	cout << "emittance " << ri.Emittance() << " energy spread " << ri.EnergySpread() << endl;
+
+	AcceleratorModel* ring_rf = BuildRing(p0, 1, 0.005 * MV / meter);
+	RadiationIntegrals ri_rf(ring_rf, p0);
+	ri_rf.Calculate();
+	cout << "horizontal mode integral " << ri_rf.ModeIntegral(0) << " I5/2 " << ri_rf.I(5) / 2 << endl;
+	assert_close(ri_rf.ModeIntegral(0) / (ri_rf.I(5) / 2), 1.0, 1e-2);
+	assert(ri_rf.ModeIntegral(1) < 1e-10);
+	assert(ri_rf.ModePlane(0) == 0);
+	assert_close(ri_rf.ModeDampingConstant(0), ri_rf.DampingConstant(0), 1e-15);
+
+	EquilibriumDistribution tracked(ring_rf, p0);
+	tracked.CalculateEmittance();
+	EquilibriumDistribution integrated(ring_rf, p0);
+	integrated.CalculateEmittanceFromIntegrals();
+	cout << "horizontal emittance " << tracked.Emittance(0) << " tracked, " << integrated.Emittance(0)
+		 << " from integrals" << endl;
+	assert_close(integrated.Emittance(0) / tracked.Emittance(0), 1.0, 2e-3);
+
+	delete model;
+	delete sliced;
+	delete ring_rf;
+	cout << "all radiation integrals tests successful" << endl;
+}
@@ -0,0 +1,113 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <iostream>
+
+#include "Components.h"
+#include "CollimatorAperture.h"
+#include "AcceleratorModelConstructor.h"
+
+#include "ParticleTracker.h"
+#include "ParticleBunchTypes.h"
+
+#include "CollimateProtonProcess.h"
+#include "ScatteringModelsMerlin.h"
+#include "MaterialData.h"
+
+#include "PhysicalUnits.h"
+#include "RandomNG.h"
+
+/* Scatter protons through a tilted, tapered collimator with different
+ * output bin sizes and the same seed. The scattering follows the particles
+ * from jaw surface to jaw surface, so the surviving bunches must be the same.
+ */
+
+using namespace std;
+using namespace PhysicalUnits;
+using namespace ParticleTracking;
+using namespace Collimation;
+
+const double beam_energy = 7000.0;
+
+ProtonBunch* Track(AcceleratorModel* model, ScatteringModel* scatter, const PSvectorArray& initial, double bin_size)
+{
+	RandomNG::init(2);
+
+	ProtonBunch* bunch = new ProtonBunch(beam_energy, 1);
+	for(size_t i = 0; i < initial.size(); i++)
+	{
+		bunch->AddParticle(initial[i]);
+	}
+
+	ParticleTracker tracker(model->GetBeamline(), bunch);
+	CollimateProtonProcess* proc = new CollimateProtonProcess(2, 4);
+	proc->SetScatteringModel(scatter);
+	proc->ScatterAtCollimator(true);
+	proc->SetLossThreshold(101.0);
+	proc->SetLogStream(nullptr);
+	proc->SetOutputBinSize(bin_size);
+	tracker.AddProcess(proc);
+	tracker.Track(bunch);
+	return bunch;
+}
+
+int main()
+{
+	StandardMaterialData mat;
+
+	const double length = 0.6;
+	const double halfgap = 1.0e-3;
+	Collimator* coll = new Collimator("TC", length);
+	coll->SetMaterialProperties(mat.property["Cu"]);
+	CollimatorAperture* ap = new CollimatorAperture(2 * halfgap, 2 * halfgap, 0.3, length, 0, 0);
+	ap->SetExitWidth(1.6 * halfgap);
+	ap->SetExitHeight(1.6 * halfgap);
+	coll->SetAperture(ap);
+
+	AcceleratorModelConstructor ctor;
+	ctor.NewModel();
+	ctor.AppendComponent(coll);
+	AcceleratorModel* model = ctor.GetModel();
+
+	// Particles start close to the jaw surfaces, on paths which leave and enter the jaws
+	RandomNG::init(1);
+	PSvectorArray initial;
+	for(size_t i = 0; i < 2000; i++)
+	{
+		PSvector p(0);
+		p.x() = RandomNG::normal(0, 0.3 * halfgap * halfgap);
+		p.y() = (i % 2 ? 1 : -1) * (halfgap + RandomNG::normal(0, 1e-10));
+		p.xp() = RandomNG::normal(0, 1e-10);
+		p.yp() = RandomNG::normal(0, 1e-10);
+		initial.push_back(p);
+	}
+
+	// Both runs share the model, whose cross section tables are made on first use
+	ScatteringModelMerlin scatter;
+	delete Track(model, &scatter, initial, length);
+	ProtonBunch* whole = Track(model, &scatter, initial, length);
+	ProtonBunch* binned = Track(model, &scatter, initial, 0.07);
+	cout << "Surviving particles: " << whole->size() << " of " << initial.size() << ", " << binned->size()
+		 << " with short bins" << endl;
+
+	assert(whole->size() > 0);
+	assert(whole->size() < initial.size());
+	assert(whole->size() == binned->size());
+	for(size_t i = 0; i < whole->size(); i++)
+	{
+		for(int j = 0; j < 6; j++)
+		{
+			assert(whole->GetParticles()[i][j] == binned->GetParticles()[i][j]);
+		}
+	}
+
+	delete whole;
+	delete binned;
+	delete model;
+	return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "../tests.h"
+#include <cmath>
+#include <iostream>
+
+#include "ScatteringModelsMerlin.h"
+#include "MaterialData.h"
+#include "PhysicalConstants.h"
+#include "RandomNG.h"
+
+/* Sample path lengths in copper at the reference energy and well below it.
+ * The mean must be the mean free path of the SixTrack cross sections at
+ * the particle energy, not at the reference energy.
+ */
+
+using namespace std;
+using namespace PhysicalConstants;
+using namespace Collimation;
+
+// Proton-nucleon elastic and single diffractive cross sections of the SixTrack model at energy E (GeV)
+double Quasielastic(MaterialProperties* mat, double E)
+{
+	double s = 2 * ProtonMassGeV * E + ProtonMassGeV * ProtonMassGeV;
+	double free = 1.618 * pow(mat->A, 0.333);
+	return free * 0.007 * pow(E / 450.0, 0.04792) + free * 0.00068 * log(0.15 * s);
+}
+
+// Mean free path at energy E of a material whose total cross section is given at E0
+double MeanFreePath(MaterialProperties* mat, double E, double E0)
+{
+	double sigma = mat->sigma_T + mat->sigma_R + Quasielastic(mat, E) - Quasielastic(mat, E0);
+	return mat->A * 1.E-3 / (sigma * mat->density * 1.E-28 * 6.022E23);
+}
+
+double MeanPathLength(ScatteringModel& model, MaterialProperties* mat, double E, size_t n)
+{
+	double sum = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		sum += model.PathLength(mat, E);
+	}
+	return sum / n;
+}
+
+int main()
+{
+	RandomNG::init(1);
+
+	const double E0 = 7000;
+	const size_t n = 1000000;
+	StandardMaterialData materials;
+	MaterialProperties* cu = materials.property["Cu"];
+
+	ScatteringModelSixTrack model;
+	model.ConfigureMaterials(&materials, E0);
+
+	double high = MeanPathLength(model, cu, E0, n);
+	double low = MeanPathLength(model, cu, E0 / 50, n);
+	cout << "Mean path length " << high << " at E0, " << low << " at E0/50" << endl;
+
+	assert_close(high / (MeanFreePath(cu, E0, E0)), 1.0, 5e-3);
+	assert_close(low / (MeanFreePath(cu, E0 / 50, E0)), 1.0, 5e-3);
+
+	// The cross sections shrink by about 2% over this range
+	assert(low > 1.01 * high);
+
+	return 0;
+}
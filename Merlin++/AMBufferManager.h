@@ -58,10 +58,37 @@ public:
 	 */
 	bool empty() const;
 
+	/*
+	 *	While an Exclusive object exists, the data sent from the thread
+	 *	that created it go to buf alone, for the monitors buf is added
+	 *	to, and not to the other or the default buffers. A null buf
+	 *	restores delivery to all buffers.
+	 */
+	class Exclusive
+	{
+	public:
+		explicit Exclusive(B* buf) :
+			outer(exclusive)
+		{
+			exclusive = buf;
+		}
+		~Exclusive()
+		{
+			exclusive = outer;
+		}
+
+	private:
+		B* outer;
+
+		Exclusive(const Exclusive&);
+		Exclusive& operator=(const Exclusive&);
+	};
+
 private:
 
 	std::set<B*> buffers;
 	static B* defBuffer;
+	static thread_local B* exclusive;
 };
 
 template<class M, class B, class D>
@@ -73,6 +100,9 @@ inline bool AMBufferManager<M, B, D>::empty() const
 template<class M, class B, class D>
 B * AMBufferManager<M, B, D>::defBuffer = nullptr;
 
+template<class M, class B, class D>
+thread_local B * AMBufferManager<M, B, D>::exclusive = nullptr;
+
 template<class M, class B, class D>
 void AMBufferManager<M, B, D>::AddBuffer(B* buf)
 {
@@ -106,6 +136,14 @@ void AMBufferManager<M, B, D>::SetDefaultBuffer(B* buf)
 template<class M, class B, class D>
 void AMBufferManager<M, B, D>::SendToBuffers(const M& monitor, const D& data)
 {
+	if(exclusive != nullptr)
+	{
+		if(buffers.count(exclusive) != 0)
+		{
+			exclusive->Record(monitor, data);
+		}
+		return;
+	}
 	if(defBuffer != nullptr)
 	{
 		defBuffer->Record(monitor, data);
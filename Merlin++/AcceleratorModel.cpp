@@ -366,6 +366,15 @@ size_t AcceleratorModel::GetAcceleratorSupports(AcceleratorSupportList& supports
 	return eas.nFound;
 }
 
+void AcceleratorModel::UpdateFrameCaches()
+{
+	for(FlatLattice::iterator f = lattice.begin(); f != lattice.end(); f++)
+	{
+		(*f)->GetEntrancePlaneTransform();
+		(*f)->GetExitPlaneTransform();
+	}
+}
+
 static bool SortComponent(const AcceleratorComponent* first, const AcceleratorComponent* last)
 {
 	return first->GetComponentLatticePosition() < last->GetComponentLatticePosition();
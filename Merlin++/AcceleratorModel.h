@@ -473,6 +473,16 @@ public:
 	 */
 	size_t GetAcceleratorSupports(AcceleratorSupportList& supports);
 
+	/**
+	 * Brings the frame caches used by tracking up to date: the support
+	 * transformations of each SupportStructure, which are recalculated
+	 * without synchronisation on first use after a support has moved,
+	 * and the global entrance and exit plane transformations of each
+	 * component frame. Call it on one thread after changing the
+	 * alignment and before tracking the model on several threads.
+	 */
+	void UpdateFrameCaches();
+
 	/**
 	 * Find the lattice position of a given element.
 	 * @param[in] RequestedElement The name of the requested element to find.
@@ -7,6 +7,7 @@
 
 #include <cmath>
 #include "AcceleratorSupport.h"
+#include "LatticeFrame.h"
 
 using namespace std;
 
@@ -15,3 +16,33 @@ double AcceleratorSupport::DistanceTo(const AcceleratorSupport& aSupport) const
 	Point2D dx = aSupport.pos - pos;
 	return sqrt(dx * dx);
 }
+
+// The supporting frame takes the offset into its local frame transformation
+
+void AcceleratorSupport::SetOffset(const Vector3D& X)
+{
+	offset = X;
+	Modified();
+}
+
+const Vector3D& AcceleratorSupport::IncrementOffset(const Vector3D& dX)
+{
+	offset += dX;
+	Modified();
+	return offset;
+}
+
+void AcceleratorSupport::Reset()
+{
+	offset = Vector3D(0, 0, 0);
+	Modified();
+}
+
+void AcceleratorSupport::Modified()
+{
+	modified = true;
+	if(frame)
+	{
+		frame->Invalidate();
+	}
+}
@@ -23,6 +23,7 @@
  *	An array of AcceleratorSupport pointers.
  */
 class AcceleratorSupport;
+class LatticeFrame;
 typedef std::vector<AcceleratorSupport*> AcceleratorSupportList;
 
 class AcceleratorSupport
@@ -93,15 +94,26 @@ public:
 
 private:
 
+	/**
+	 *	Marks the offset as changed, and invalidates the cached
+	 *	transformations of the supported frame.
+	 */
+	void Modified();
+
 	Vector3D offset;
 	bool modified;
 	Point2D pos;
 	double s_pos;
+
+	/**
+	 *	The frame resting on this support, set by SupportStructure.
+	 */
+	const LatticeFrame* frame;
 	friend class SupportStructure;
 };
 
 inline AcceleratorSupport::AcceleratorSupport() :
-	offset(0, 0, 0), modified(false), pos(0, 0), s_pos(0)
+	offset(0, 0, 0), modified(false), pos(0, 0), s_pos(0), frame(nullptr)
 {
 }
 
@@ -127,12 +139,6 @@ inline void AcceleratorSupport::SetOffset(double x, double y, double z)
 	SetOffset(Vector3D(x, y, z));
 }
 
-inline void AcceleratorSupport::SetOffset(const Vector3D& X)
-{
-	offset = X;
-	modified = true;
-}
-
 inline const Vector3D& AcceleratorSupport::GetOffset() const
 {
 	return offset;
@@ -143,16 +149,4 @@ inline const Vector3D& AcceleratorSupport::IncrementOffset(double dx, double dy,
 	return IncrementOffset(Vector3D(dx, dy, dz));
 }
 
-inline const Vector3D& AcceleratorSupport::IncrementOffset(const Vector3D& dX)
-{
-	modified = true;
-	return offset += dX;
-}
-
-inline void AcceleratorSupport::Reset()
-{
-	modified = true;
-	offset = Vector3D(0, 0, 0);
-}
-
 #endif
@@ -53,6 +53,17 @@ public:
 	 */
 	virtual std::string GetType() = 0;
 
+	/**
+	 *	Conservative inscribed size of the aperture: any particle with
+	 *	|x| + |y| below this value is inside the aperture at every z.
+	 *	The default of zero makes no guarantee.
+	 *	@return inscribed half-diagonal of the aperture
+	 */
+	virtual double GetInscribedRadius() const
+	{
+		return 0;
+	}
+
 	/**
 	 *	Function/interface for setting aperture type
 	 *	@return string of aperture typename
@@ -131,6 +142,11 @@ public:
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
 
+	double GetInscribedRadius() const
+	{
+		return radius;
+	}
+
 	/**
 	 *  get new CircularAperture instance - only called by ApertureFactory::GetInstance class
 	 *  @return constructed Aperture pointer of assigned type CircularAperture
@@ -196,6 +212,11 @@ public:
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
 
+	double GetInscribedRadius() const
+	{
+		return minDim;
+	}
+
 	/**
 	 *  get new RectangularAperture instance - only called by ApertureFactory::GetInstance class
 	 *  @return constructed Aperture pointer of assigned type RectangularAperture
@@ -254,6 +275,11 @@ public:
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
 
+	double GetInscribedRadius() const
+	{
+		return minDim;
+	}
+
 	/**
 	 *  get new EllipticalAperture instance - only called by ApertureFactory::GetInstance class
 	 *  @return constructed Aperture pointer of assigned type EllipticalAperture
@@ -340,6 +366,11 @@ public:
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
 
+	double GetInscribedRadius() const
+	{
+		return minDim;
+	}
+
 	/**
 	 *  get new RectEllipseAperture instance - only called by ApertureFactory::GetInstance class
 	 *  @return constructed Aperture pointer of assigned type RectEllipseAperture
@@ -444,6 +475,11 @@ public:
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
 
+	double GetInscribedRadius() const
+	{
+		return minDim;
+	}
+
 	/**
 	 *  get new OctagonalAperture instance - only called by ApertureFactory::GetInstance class
 	 *  @return constructed Aperture pointer of assigned type OctagonalAperture
@@ -0,0 +1,311 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "BPMTurnByTurnBuffer.h"
+#include "ParallelFor.h"
+#include "NumericalConstants.h"
+#include "PSvector.h"
+#include "MerlinException.h"
+
+using namespace std;
+
+namespace
+{
+
+typedef complex<double> Complex;
+
+// In place radix-2 FFT, a.size() must be a power of 2
+void FFT(vector<Complex>& a)
+{
+	const size_t n = a.size();
+	for(size_t i = 1, j = 0; i < n; i++)
+	{
+		size_t bit = n >> 1;
+		for(; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+		if(i < j)
+		{
+			swap(a[i], a[j]);
+		}
+	}
+
+	for(size_t len = 2; len <= n; len <<= 1)
+	{
+		const Complex wl = polar(1.0, -twoPi / len);
+		for(size_t i = 0; i < n; i += len)
+		{
+			Complex w = 1;
+			for(size_t k = 0; k < len / 2; k++)
+			{
+				Complex u = a[i + k];
+				Complex v = a[i + k + len / 2] * w;
+				a[i + k] = u + v;
+				a[i + k + len / 2] = u - v;
+				w *= wl;
+			}
+		}
+	}
+}
+
+// Copy of data with the mean removed and a Hann window applied
+void Window(const double* data, size_t n, vector<double>& w, double& wsum)
+{
+	double mean = 0;
+	for(size_t k = 0; k < n; k++)
+	{
+		mean += data[k];
+	}
+	mean /= n;
+
+	w.resize(n);
+	wsum = 0;
+	for(size_t k = 0; k < n; k++)
+	{
+		double h = sin(pi * k / n);
+		h *= h;
+		w[k] = (data[k] - mean) * h;
+		wsum += h;
+	}
+}
+
+// Windowed spectrum at tune q
+Complex Spectrum(const vector<double>& w, double q)
+{
+	const Complex step = polar(1.0, -twoPi * q);
+	Complex e = 1;
+	Complex s = 0;
+	for(size_t k = 0; k < w.size(); k++)
+	{
+		s += w[k] * e;
+		e *= step;
+	}
+	return s;
+}
+
+// Tune of the largest peak: the FFT peak, refined by a golden section
+// search for the maximum of the spectrum within one FFT bin
+double FindTune(const vector<double>& w)
+{
+	size_t nfft = 1;
+	while(nfft < 2 * w.size())
+	{
+		nfft <<= 1;
+	}
+	vector<Complex> a(nfft, 0.0);
+	copy(w.begin(), w.end(), a.begin());
+	FFT(a);
+
+	size_t peak = 1;
+	for(size_t j = 2; j < nfft / 2; j++)
+	{
+		if(norm(a[j]) > norm(a[peak]))
+		{
+			peak = j;
+		}
+	}
+
+	const double g = (sqrt(5.0) - 1) / 2;
+	double q1 = (peak - 1.0) / nfft;
+	double q2 = (peak + 1.0) / nfft;
+	double qa = q2 - g * (q2 - q1);
+	double qb = q1 + g * (q2 - q1);
+	double fa = norm(Spectrum(w, qa));
+	double fb = norm(Spectrum(w, qb));
+	while(q2 - q1 > 1.0e-12)
+	{
+		if(fa > fb)
+		{
+			q2 = qb;
+			qb = qa;
+			fb = fa;
+			qa = q2 - g * (q2 - q1);
+			fa = norm(Spectrum(w, qa));
+		}
+		else
+		{
+			q1 = qa;
+			qa = qb;
+			fa = fb;
+			qb = q1 + g * (q2 - q1);
+			fb = norm(Spectrum(w, qb));
+		}
+	}
+	return (q1 + q2) / 2;
+}
+
+double Median(vector<double> v)
+{
+	if(v.empty())
+	{
+		return 0;
+	}
+	nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+	return v[v.size() / 2];
+}
+
+} // end anonymous namespace
+
+BPMTurnByTurnBuffer::BPMTurnByTurnBuffer(size_t nt, size_t dec) :
+	nturns(nt), decimation(dec == 0 ? 1 : dec), nextRow(0), qx(0), qy(0)
+{
+}
+
+size_t BPMTurnByTurnBuffer::AddBPM(const BPM* aBPM)
+{
+	pair<unordered_map<const BPM*, size_t>::iterator, bool> rv = rows.insert(make_pair(aBPM, bpms.size()));
+	if(rv.second)
+	{
+		bpms.push_back(aBPM);
+		count.push_back(0);
+		calls.push_back(0);
+		xdata.resize(bpms.size() * nturns);
+		ydata.resize(bpms.size() * nturns);
+	}
+	return rv.first->second;
+}
+
+size_t BPMTurnByTurnBuffer::Row(const BPM* aBPM)
+{
+	size_t row = nextRow;
+	if(row >= bpms.size() || bpms[row] != aBPM)
+	{
+		unordered_map<const BPM*, size_t>::const_iterator r = rows.find(aBPM);
+		row = r != rows.end() ? r->second : AddBPM(aBPM);
+	}
+	nextRow = row + 1 < bpms.size() ? row + 1 : 0;
+	return row;
+}
+
+void BPMTurnByTurnBuffer::Record(const BPM& aBPM, const BPM::Data& data)
+{
+	const size_t row = Row(&aBPM);
+	if(calls[row]++ % decimation != 0 || count[row] == nturns)
+	{
+		return;
+	}
+	const size_t n = row * nturns + count[row]++;
+	xdata[n] = data.x.value;
+	ydata[n] = data.y.value;
+}
+
+void BPMTurnByTurnBuffer::Reset()
+{
+	fill(count.begin(), count.end(), 0);
+	fill(calls.begin(), calls.end(), 0);
+}
+
+const double* BPMTurnByTurnBuffer::GetReadings(size_t row, int plane) const
+{
+	return &(plane == ps_X ? xdata : ydata)[row * nturns];
+}
+
+void BPMTurnByTurnBuffer::Analyse(size_t nthreads)
+{
+	const size_t nrows = bpms.size();
+	xfit.assign(nrows, Harmonic());
+	yfit.assign(nrows, Harmonic());
+
+	// Too few samples to find a tune
+	const size_t nmin = 8;
+
+	ParallelFor(nrows, nthreads, [this, nmin](size_t r)
+	{
+		if(count[r] >= nmin)
+		{
+			vector<double> w;
+			double wsum;
+			Window(GetReadings(r, ps_X), count[r], w, wsum);
+			xfit[r].tune = FindTune(w);
+			Window(GetReadings(r, ps_Y), count[r], w, wsum);
+			yfit[r].tune = FindTune(w);
+		}
+	});
+
+	vector<double> tx, ty;
+	for(size_t r = 0; r < nrows; r++)
+	{
+		if(count[r] >= nmin)
+		{
+			tx.push_back(xfit[r].tune);
+			ty.push_back(yfit[r].tune);
+		}
+	}
+	qx = Median(tx);
+	qy = Median(ty);
+
+	// The amplitudes and phases are found at a common tune, so that the
+	// phase advances are not affected by the scatter of the tunes
+	ParallelFor(nrows, nthreads, [this, nmin](size_t r)
+	{
+		if(count[r] >= nmin)
+		{
+			vector<double> w;
+			double wsum;
+			Window(GetReadings(r, ps_X), count[r], w, wsum);
+			Complex s = Spectrum(w, qx);
+			xfit[r].amplitude = 2 * abs(s) / wsum;
+			xfit[r].phase = arg(s);
+			Window(GetReadings(r, ps_Y), count[r], w, wsum);
+			s = Spectrum(w, qy);
+			yfit[r].amplitude = 2 * abs(s) / wsum;
+			yfit[r].phase = arg(s);
+		}
+	});
+}
+
+const BPMTurnByTurnBuffer::Harmonic& BPMTurnByTurnBuffer::GetHarmonic(size_t row, int plane) const
+{
+	return plane == ps_X ? xfit[row] : yfit[row];
+}
+
+double BPMTurnByTurnBuffer::GetTune(int plane) const
+{
+	return plane == ps_X ? qx : qy;
+}
+
+std::vector<double> BPMTurnByTurnBuffer::GetPhaseAdvances(int plane) const
+{
+	const vector<Harmonic>& fit = plane == ps_X ? xfit : yfit;
+	vector<double> mu;
+	for(size_t r = 1; r < fit.size(); r++)
+	{
+		double dmu = (fit[r].phase - fit[r - 1].phase) / twoPi;
+		mu.push_back(dmu - floor(dmu));
+	}
+	return mu;
+}
+
+std::vector<double> BPMTurnByTurnBuffer::GetBetaBeating(int plane, const std::vector<double>& model_beta) const
+{
+	const vector<Harmonic>& fit = plane == ps_X ? xfit : yfit;
+	if(model_beta.size() != fit.size())
+	{
+		throw MerlinException("BPMTurnByTurnBuffer::GetBetaBeating: need one model beta per BPM");
+	}
+
+	vector<double> beat(fit.size());
+	double mean = 0;
+	for(size_t r = 0; r < fit.size(); r++)
+	{
+		beat[r] = fit[r].amplitude * fit[r].amplitude / model_beta[r];
+		mean += beat[r];
+	}
+	mean /= fit.size();
+
+	for(size_t r = 0; r < fit.size(); r++)
+	{
+		beat[r] = beat[r] / mean - 1;
+	}
+	return beat;
+}
@@ -0,0 +1,158 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef BPMTurnByTurnBuffer_h
+#define BPMTurnByTurnBuffer_h 1
+
+#include "merlin_config.h"
+#include <unordered_map>
+#include <vector>
+#include "BPM.h"
+
+/**
+ *	A BPM buffer which records the turn-by-turn (x,y) readings of
+ *	many BPMs. Each BPM has a row of nturns samples per plane, held
+ *	in one contiguous block, so that recording does not allocate
+ *	once all the BPMs are known. Rows are added in the order the
+ *	BPMs first record, or up front with AddBPM(). With a decimation
+ *	of k only every k-th reading of each BPM is kept. Readings
+ *	beyond nturns are ignored.
+ *
+ *	Analyse() fits the main harmonic of each row (tune, amplitude
+ *	and phase of x = A cos(2 pi Q n + phi)) with a Hann windowed FFT
+ *	followed by a NAFF-like refinement of the peak. The BPMs are
+ *	shared between threads. The fitted tunes lie in [0, 0.5]; for
+ *	a fractional tune above 0.5 the phases change sign.
+ *
+ * 	BPMTurnByTurnBuffer tbt(1024);
+ * 	for each bpm: bpm->AddBuffer(&tbt);
+ * 	for each turn: tracker.Track(bunch);
+ * 	tbt.Analyse();
+ * 	vector<double> mux = tbt.GetPhaseAdvances(ps_X);
+ */
+
+class BPMTurnByTurnBuffer: public BPM::Buffer
+{
+public:
+
+	/**
+	 *	Result of the harmonic fit of one row
+	 */
+	struct Harmonic
+	{
+		double tune;
+		double amplitude;
+		double phase;
+
+		Harmonic() :
+			tune(0), amplitude(0), phase(0)
+		{
+		}
+	};
+
+	BPMTurnByTurnBuffer(size_t nturns, size_t decimation = 1);
+
+	/**
+	 *	Record the data to the row of aBPM.
+	 */
+	virtual void Record(const BPM& aBPM, const BPM::Data& data);
+
+	/**
+	 *	Add a row for aBPM, if it does not have one. Returns the row.
+	 */
+	size_t AddBPM(const BPM* aBPM);
+
+	/**
+	 *	Clear the recorded samples, keeping the BPMs.
+	 */
+	void Reset();
+
+	size_t GetNumberOfBPMs() const
+	{
+		return bpms.size();
+	}
+
+	const BPM* GetBPM(size_t row) const
+	{
+		return bpms[row];
+	}
+
+	/**
+	 *	Number of samples recorded for a row
+	 */
+	size_t GetNumberOfTurns(size_t row) const
+	{
+		return count[row];
+	}
+
+	/**
+	 *	The samples of a row, for plane ps_X or ps_Y
+	 */
+	const double* GetReadings(size_t row, int plane) const;
+
+	/**
+	 *	Fit the main harmonic of every row in both planes, using
+	 *	nthreads threads (0 for ParallelThreads(0): one per hardware
+	 *	thread, or one within another parallel loop). The
+	 *	amplitudes and phases are evaluated at the median tune of
+	 *	all the BPMs.
+	 */
+	void Analyse(size_t nthreads = 0);
+
+	/**
+	 *	Harmonic of a row for plane ps_X or ps_Y, after Analyse()
+	 */
+	const Harmonic& GetHarmonic(size_t row, int plane) const;
+
+	/**
+	 *	Median tune of all the BPMs, after Analyse()
+	 */
+	double GetTune(int plane) const;
+
+	/**
+	 *	Phase advances (in units of 2 pi) from each BPM to the
+	 *	next, in row order, after Analyse()
+	 */
+	std::vector<double> GetPhaseAdvances(int plane) const;
+
+	/**
+	 *	Relative beta-beating (beta/beta_model - 1) at each BPM,
+	 *	from the fitted amplitudes (beta proportional to amplitude
+	 *	squared), normalised to the mean over all BPMs.
+	 */
+	std::vector<double> GetBetaBeating(int plane, const std::vector<double>& model_beta) const;
+
+private:
+
+	size_t Row(const BPM* aBPM);
+
+	size_t nturns;
+	size_t decimation;
+
+	/**
+	 *	Rows of the BPMs. The BPMs record in the same order each
+	 *	turn, so the row after the last one recorded is tried first.
+	 */
+	std::unordered_map<const BPM*, size_t> rows;
+	size_t nextRow;
+	std::vector<const BPM*> bpms;
+	std::vector<size_t> count;
+	std::vector<size_t> calls;
+
+	/**
+	 *	Samples indexed [row * nturns + turn]
+	 */
+	std::vector<double> xdata;
+	std::vector<double> ydata;
+
+	std::vector<Harmonic> xfit;
+	std::vector<Harmonic> yfit;
+	double qx;
+	double qy;
+};
+
+#endif
@@ -0,0 +1,734 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "BlockedLinearAlgebra.h"
+#include "ParallelFor.h"
+#include "TLAS.h"
+
+using namespace std;
+
+namespace
+{
+
+size_t blockedThreshold = 128;
+size_t blockedThreads = 0;
+
+// Width of the QR panels
+const size_t panelWidth = 32;
+
+// Columns of a block reflector update done at a time
+const size_t tileWidth = 256;
+
+// Element (i, j) of the Householder vectors of the panel starting at column k0
+inline double V(const double* a, size_t lda, size_t k0, size_t i, size_t j)
+{
+	return i == k0 + j ? 1.0 : a[i * lda + k0 + j];
+}
+
+// Upper triangular factor T of the block reflector of the kb Householder
+// vectors of the panel at k0: H(k0) ... H(k0+kb-1) = I - V T V^T
+void BlockReflectorFactor(const double* a, size_t m, size_t lda, size_t k0, size_t kb, const double* tau, vector<
+		double>& t)
+{
+	t.assign(kb * kb, 0.0);
+	vector<double> z(kb);
+	for(size_t j = 0; j < kb; j++)
+	{
+		// z = V(:, 0:j)^T v(j), over the rows of v(j)
+		const size_t r0 = k0 + j;
+		for(size_t l = 0; l < j; l++)
+		{
+			z[l] = a[r0 * lda + k0 + l];
+		}
+		for(size_t i = r0 + 1; i < m; i++)
+		{
+			const double vij = a[i * lda + k0 + j];
+			for(size_t l = 0; l < j; l++)
+			{
+				z[l] += a[i * lda + k0 + l] * vij;
+			}
+		}
+		// T(0:j, j) = -tau(j) T(0:j, 0:j) z
+		for(size_t l = 0; l < j; l++)
+		{
+			double s = 0;
+			for(size_t q = l; q < j; q++)
+			{
+				s += t[l * kb + q] * z[q];
+			}
+			t[l * kb + j] = -tau[j] * s;
+		}
+		t[j * kb + j] = tau[j];
+	}
+}
+
+// Apply I - V T V^T (or its transpose) to rows [k0, m) and columns [c0, c1) of c
+void ApplyBlockReflector(const double* a, size_t m, size_t lda, size_t k0, size_t kb, const vector<double>& t,
+	bool transpose, double* c, size_t ldc, size_t c0, size_t c1)
+{
+	vector<double> w(kb * tileWidth);
+	for(size_t cb = c0; cb < c1; cb += tileWidth)
+	{
+		const size_t nc = min(tileWidth, c1 - cb);
+
+		// w = V^T c, by rows of c, four rows of w at a time
+		fill(w.begin(), w.end(), 0.0);
+		for(size_t i = k0; i < m; i++)
+		{
+			const double* ci = c + i * ldc + cb;
+			const size_t lmax = min(kb, i - k0 + 1);
+			size_t l = 0;
+			for(; l + 4 <= lmax; l += 4)
+			{
+				const double v0 = V(a, lda, k0, i, l);
+				const double v1 = V(a, lda, k0, i, l + 1);
+				const double v2 = V(a, lda, k0, i, l + 2);
+				const double v3 = V(a, lda, k0, i, l + 3);
+				double* w0 = &w[l * tileWidth];
+				double* w1 = w0 + tileWidth;
+				double* w2 = w1 + tileWidth;
+				double* w3 = w2 + tileWidth;
+				for(size_t k = 0; k < nc; k++)
+				{
+					const double x = ci[k];
+					w0[k] += v0 * x;
+					w1[k] += v1 * x;
+					w2[k] += v2 * x;
+					w3[k] += v3 * x;
+				}
+			}
+			for(; l < lmax; l++)
+			{
+				const double vil = V(a, lda, k0, i, l);
+				double* wl = &w[l * tileWidth];
+				for(size_t k = 0; k < nc; k++)
+				{
+					wl[k] += vil * ci[k];
+				}
+			}
+		}
+
+		// w = T w, or T^T w
+		if(transpose)
+		{
+			for(size_t l = kb; l-- > 0;)
+			{
+				double* wl = &w[l * tileWidth];
+				for(size_t k = 0; k < nc; k++)
+				{
+					wl[k] *= t[l * kb + l];
+				}
+				for(size_t q = 0; q < l; q++)
+				{
+					const double tql = t[q * kb + l];
+					const double* wq = &w[q * tileWidth];
+					for(size_t k = 0; k < nc; k++)
+					{
+						wl[k] += tql * wq[k];
+					}
+				}
+			}
+		}
+		else
+		{
+			for(size_t l = 0; l < kb; l++)
+			{
+				double* wl = &w[l * tileWidth];
+				for(size_t k = 0; k < nc; k++)
+				{
+					wl[k] *= t[l * kb + l];
+				}
+				for(size_t q = l + 1; q < kb; q++)
+				{
+					const double tlq = t[l * kb + q];
+					const double* wq = &w[q * tileWidth];
+					for(size_t k = 0; k < nc; k++)
+					{
+						wl[k] += tlq * wq[k];
+					}
+				}
+			}
+		}
+
+		// c -= V w
+		for(size_t i = k0; i < m; i++)
+		{
+			double* ci = c + i * ldc + cb;
+			const size_t lmax = min(kb, i - k0 + 1);
+			size_t l = 0;
+			for(; l + 4 <= lmax; l += 4)
+			{
+				const double v0 = V(a, lda, k0, i, l);
+				const double v1 = V(a, lda, k0, i, l + 1);
+				const double v2 = V(a, lda, k0, i, l + 2);
+				const double v3 = V(a, lda, k0, i, l + 3);
+				const double* w0 = &w[l * tileWidth];
+				const double* w1 = w0 + tileWidth;
+				const double* w2 = w1 + tileWidth;
+				const double* w3 = w2 + tileWidth;
+				for(size_t k = 0; k < nc; k++)
+				{
+					ci[k] -= v0 * w0[k] + v1 * w1[k] + v2 * w2[k] + v3 * w3[k];
+				}
+			}
+			for(; l < lmax; l++)
+			{
+				const double vil = V(a, lda, k0, i, l);
+				const double* wl = &w[l * tileWidth];
+				for(size_t k = 0; k < nc; k++)
+				{
+					ci[k] -= vil * wl[k];
+				}
+			}
+		}
+	}
+}
+
+// Apply the block reflector to columns [c0, c1) of c, shared out between threads
+void ApplyBlockReflectorParallel(const double* a, size_t m, size_t lda, size_t k0, size_t kb,
+	const vector<double>& t, bool transpose, double* c, size_t ldc, size_t c0, size_t c1)
+{
+	const size_t ntiles = (c1 - c0 + tileWidth - 1) / tileWidth;
+	ParallelRanges(ntiles, blockedThreads, ntiles, [&](size_t t0, size_t t1)
+	{
+		ApplyBlockReflector(a, m, lda, k0, kb, t, transpose, c, ldc, c0 + t0 * tileWidth, min(c1, c0 + t1
+			* tileWidth));
+	});
+}
+
+// Householder reflector I - tau v v^T of the n elements x[0], x[stride], ...
+// On return x[0] is the reflected element (beta) and the others are v,
+// with v[0] = 1 implied. Returns tau, 0 if x needs no reflection.
+double Householder(double* x, size_t n, size_t stride)
+{
+	double xnorm = 0;
+	for(size_t i = 1; i < n; i++)
+	{
+		xnorm += x[i * stride] * x[i * stride];
+	}
+	if(xnorm == 0)
+	{
+		return 0;
+	}
+	xnorm = sqrt(xnorm);
+	const double alpha = x[0];
+	const double beta = alpha >= 0 ? -hypot(alpha, xnorm) : hypot(alpha, xnorm);
+	const double scale = 1 / (alpha - beta);
+	for(size_t i = 1; i < n; i++)
+	{
+		x[i * stride] *= scale;
+	}
+	x[0] = beta;
+	return (beta - alpha) / beta;
+}
+
+// Reduce the n x n matrix b to upper bidiagonal form B = Qb D Pb^T, with
+// diagonal d and super-diagonal e. Qb = H(0) ... H(n-1) is left as the
+// Householder vectors below the diagonal, Pb = G(0) ... G(n-2) as those
+// right of the super-diagonal.
+void Bidiagonalise(double* b, size_t n, vector<double>& d, vector<double>& e, vector<double>& tauq,
+	vector<double>& taup)
+{
+	d.resize(n);
+	e.assign(n, 0.0);
+	tauq.resize(n);
+	taup.assign(n, 0.0);
+	vector<double> w(n);
+	for(size_t i = 0; i < n; i++)
+	{
+		// H(i) from column i, applied to row i
+		tauq[i] = Householder(b + i * n + i, n - i, n);
+		d[i] = b[i * n + i];
+		const size_t nc = n - i - 1;
+		if(nc == 0)
+		{
+			break;
+		}
+		double* bi = b + i * n + i + 1;
+		if(tauq[i] != 0)
+		{
+			copy(bi, bi + nc, w.begin());
+			for(size_t r = i + 1; r < n; r++)
+			{
+				const double vr = b[r * n + i];
+				const double* br = b + r * n + i + 1;
+				for(size_t k = 0; k < nc; k++)
+				{
+					w[k] += vr * br[k];
+				}
+			}
+			for(size_t k = 0; k < nc; k++)
+			{
+				bi[k] -= tauq[i] * w[k];
+			}
+		}
+
+		// G(i) from row i
+		taup[i] = Householder(bi, nc, 1);
+		e[i] = bi[0];
+
+		// H(i) and G(i) applied to the rows below, one pass over each row
+		ParallelRanges(nc, blockedThreads, nc / tileWidth, [&](size_t r0, size_t r1)
+		{
+			for(size_t r = i + 1 + r0; r < i + 1 + r1; r++)
+			{
+				double* br = b + r * n + i + 1;
+				if(tauq[i] != 0)
+				{
+					const double f = tauq[i] * b[r * n + i];
+					for(size_t k = 0; k < nc; k++)
+					{
+						br[k] -= f * w[k];
+					}
+				}
+				if(taup[i] != 0)
+				{
+					double g = br[0];
+					for(size_t k = 1; k < nc; k++)
+					{
+						g += br[k] * bi[k];
+					}
+					g *= taup[i];
+					br[0] -= g;
+					for(size_t k = 1; k < nc; k++)
+					{
+						br[k] -= g * bi[k];
+					}
+				}
+			}
+		});
+	}
+}
+
+// The transpose of the product of the Householder reflectors left in b by
+// Bidiagonalise(): Qb^T (left) or Pb^T (right)
+void ReflectorProductTranspose(const double* b, size_t n, const vector<double>& tau, bool left, double* pt)
+{
+	const size_t shift = left ? 0 : 1;
+	const size_t nref = n - shift;
+
+	// Built backwards, M = H(i) M, so that only the trailing block is full
+	vector<double> m(n * n, 0.0);
+	for(size_t i = 0; i < n; i++)
+	{
+		m[i * n + i] = 1;
+	}
+	vector<double> v(n);
+	vector<double> w(n);
+	for(size_t i = nref; i-- > 0;)
+	{
+		if(tau[i] == 0)
+		{
+			continue;
+		}
+		const size_t k0 = i + shift;
+		v[k0] = 1;
+		for(size_t r = k0 + 1; r < n; r++)
+		{
+			v[r] = left ? b[r * n + i] : b[i * n + r];
+		}
+		const size_t nc = n - k0;
+		ParallelRanges(nc, blockedThreads, nc / tileWidth, [&](size_t c0, size_t c1)
+		{
+			for(size_t k = k0 + c0; k < k0 + c1; k++)
+			{
+				w[k] = 0;
+			}
+			for(size_t r = k0; r < n; r++)
+			{
+				const double* mr = &m[r * n];
+				for(size_t k = k0 + c0; k < k0 + c1; k++)
+				{
+					w[k] += v[r] * mr[k];
+				}
+			}
+			for(size_t r = k0; r < n; r++)
+			{
+				const double f = tau[i] * v[r];
+				double* mr = &m[r * n];
+				for(size_t k = k0 + c0; k < k0 + c1; k++)
+				{
+					mr[k] -= f * w[k];
+				}
+			}
+		});
+	}
+
+	for(size_t r = 0; r < n; r++)
+	{
+		for(size_t k = 0; k < n; k++)
+		{
+			pt[k * n + r] = m[r * n + k];
+		}
+	}
+}
+
+// A plane rotation of rows p and q: (p, q) -> (c p + s q, c q - s p)
+struct Rotation
+{
+	size_t p;
+	size_t q;
+	double c;
+	double s;
+};
+
+// Apply the rotations, in order, to the rows of the n x n matrix x, by
+// tiles of columns shared out between threads
+void ApplyRotations(const vector<Rotation>& rot, double* x, size_t n)
+{
+	const size_t ntiles = (n + tileWidth - 1) / tileWidth;
+	ParallelRanges(ntiles, blockedThreads, rot.size() * n / (tileWidth * tileWidth), [&](size_t t0, size_t t1)
+	{
+		for(size_t t = t0; t < t1; t++)
+		{
+			const size_t k0 = t * tileWidth;
+			const size_t k1 = min(n, k0 + tileWidth);
+			for(size_t ir = 0; ir < rot.size(); ir++)
+			{
+				const Rotation& g = rot[ir];
+				double* xp = x + g.p * n;
+				double* xq = x + g.q * n;
+				for(size_t k = k0; k < k1; k++)
+				{
+					const double y = xp[k];
+					const double z = xq[k];
+					xp[k] = y * g.c + z * g.s;
+					xq[k] = z * g.c - y * g.s;
+				}
+			}
+		}
+	});
+}
+
+// Diagonalise the upper bidiagonal matrix with diagonal w and super-diagonal
+// e by implicit shifted QR (Golub-Kahan, as in svdcmp), applying the
+// rotations to the rows of ut and vt after each QR step
+void DiagonaliseBidiagonal(vector<double>& w, const vector<double>& e, double* ut, double* vt, size_t n)
+{
+	// rv1[i] is the element (i-1, i)
+	vector<double> rv1(n, 0.0);
+	double anorm = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		rv1[i] = i ? e[i - 1] : 0.0;
+		anorm = max(anorm, fabs(w[i]) + fabs(rv1[i]));
+	}
+
+	vector<Rotation> urot;
+	vector<Rotation> vrot;
+	for(int k = n - 1; k >= 0; k--)
+	{
+		for(int its = 1;; its++)
+		{
+			// Test for splitting. rv1[0] is always zero.
+			bool flag = true;
+			int l;
+			int nm = 0;
+			for(l = k; l >= 0; l--)
+			{
+				nm = l - 1;
+				if(fabs(rv1[l]) + anorm == anorm)
+				{
+					flag = false;
+					break;
+				}
+				if(fabs(w[nm]) + anorm == anorm)
+				{
+					break;
+				}
+			}
+
+			urot.clear();
+			vrot.clear();
+			if(flag)
+			{
+				// Cancel rv1[l] if w[l-1] is zero
+				double c = 0;
+				double s = 1;
+				for(int i = l; i <= k; i++)
+				{
+					const double f = s * rv1[i];
+					rv1[i] = c * rv1[i];
+					if(fabs(f) + anorm == anorm)
+					{
+						break;
+					}
+					const double g = w[i];
+					const double h = hypot(f, g);
+					w[i] = h;
+					c = g / h;
+					s = -f / h;
+					urot.push_back(Rotation {size_t(nm), size_t(i), c, s});
+				}
+			}
+
+			double z = w[k];
+			if(l == k)
+			{
+				// Converged: make the singular value non-negative
+				ApplyRotations(urot, ut, n);
+				if(z < 0)
+				{
+					w[k] = -z;
+					for(size_t j = 0; j < n; j++)
+					{
+						vt[k * n + j] = -vt[k * n + j];
+					}
+				}
+				break;
+			}
+			if(its == 30)
+			{
+				throw TLAS::ConvergenceFailure();
+			}
+
+			// Shift from the bottom 2 x 2 minor
+			double x = w[l];
+			nm = k - 1;
+			double y = w[nm];
+			double g = rv1[nm];
+			double h = rv1[k];
+			double f = ((y - z) * (y + z) + (g - h) * (g + h)) / (2 * h * y);
+			g = hypot(f, 1.0);
+			f = ((x - z) * (x + z) + h * ((y / (f + (f >= 0 ? fabs(g) : -fabs(g)))) - h)) / x;
+
+			// QR step
+			double c = 1;
+			double s = 1;
+			for(int j = l; j <= nm; j++)
+			{
+				const int i = j + 1;
+				g = rv1[i];
+				y = w[i];
+				h = s * g;
+				g = c * g;
+				z = hypot(f, h);
+				rv1[j] = z;
+				c = f / z;
+				s = h / z;
+				f = x * c + g * s;
+				g = g * c - x * s;
+				h = y * s;
+				y *= c;
+				vrot.push_back(Rotation {size_t(j), size_t(i), c, s});
+				z = hypot(f, h);
+				w[j] = z;
+				if(z != 0)
+				{
+					c = f / z;
+					s = h / z;
+				}
+				f = c * g + s * y;
+				x = c * y - s * g;
+				urot.push_back(Rotation {size_t(j), size_t(i), c, s});
+			}
+			rv1[l] = 0;
+			rv1[k] = f;
+			w[k] = x;
+
+			ApplyRotations(urot, ut, n);
+			ApplyRotations(vrot, vt, n);
+		}
+	}
+}
+
+} // end anonymous namespace
+
+namespace TLAS
+{
+
+void SetBlockedThreshold(size_t n)
+{
+	blockedThreshold = n;
+}
+
+size_t GetBlockedThreshold()
+{
+	return blockedThreshold ? blockedThreshold : numeric_limits<size_t>::max();
+}
+
+void SetBlockedThreads(size_t n)
+{
+	blockedThreads = n;
+}
+
+void BlockedQR(Matrix<double>& a, Vector<double>& tau)
+{
+	const size_t m = a.nrows();
+	const size_t n = a.ncols();
+	const size_t kmax = min(m, n);
+	double* A = a.begin();
+	tau.redim(kmax);
+
+	vector<double> t;
+	vector<double> w(panelWidth);
+	for(size_t k0 = 0; k0 < kmax; k0 += panelWidth)
+	{
+		const size_t kb = min(panelWidth, kmax - k0);
+		const size_t ke = k0 + kb;
+
+		// Unblocked QR of the panel
+		for(size_t j = k0; j < ke; j++)
+		{
+			tau[j] = Householder(A + j * n + j, m - j, n);
+			if(tau[j] == 0)
+			{
+				continue;
+			}
+
+			// H(j) applied to the rest of the panel
+			const size_t nc = ke - j - 1;
+			for(size_t c = 0; c < nc; c++)
+			{
+				w[c] = A[j * n + j + 1 + c];
+			}
+			for(size_t i = j + 1; i < m; i++)
+			{
+				const double vi = A[i * n + j];
+				for(size_t c = 0; c < nc; c++)
+				{
+					w[c] += vi * A[i * n + j + 1 + c];
+				}
+			}
+			for(size_t c = 0; c < nc; c++)
+			{
+				A[j * n + j + 1 + c] -= tau[j] * w[c];
+			}
+			for(size_t i = j + 1; i < m; i++)
+			{
+				const double f = tau[j] * A[i * n + j];
+				for(size_t c = 0; c < nc; c++)
+				{
+					A[i * n + j + 1 + c] -= f * w[c];
+				}
+			}
+		}
+
+		// The panel applied to the trailing columns as one block reflector
+		if(ke < n)
+		{
+			BlockReflectorFactor(A, m, n, k0, kb, tau.begin() + k0, t);
+			ApplyBlockReflectorParallel(A, m, n, k0, kb, t, true, A, n, ke, n);
+		}
+	}
+}
+
+void ApplyBlockedQ(const Matrix<double>& qr, const Vector<double>& tau, Matrix<double>& c)
+{
+	const size_t m = qr.nrows();
+	const size_t n = qr.ncols();
+	if(c.nrows() != m)
+	{
+		throw DimensionError();
+	}
+	const double* A = qr.begin();
+	const size_t kmax = tau.size();
+
+	vector<double> t;
+	for(size_t k0 = ((kmax + panelWidth - 1) / panelWidth) * panelWidth; k0 > 0;)
+	{
+		k0 -= panelWidth;
+		const size_t kb = min(panelWidth, kmax - k0);
+		BlockReflectorFactor(A, m, n, k0, kb, tau.begin() + k0, t);
+		ApplyBlockReflectorParallel(A, m, n, k0, kb, t, false, c.begin(), c.ncols(), 0, c.ncols());
+	}
+}
+
+void BlockedSVD(Matrix<double>& a, Vector<double>& w, Matrix<double>& v)
+{
+	const size_t m = a.nrows();
+	const size_t n = a.ncols();
+	if(m < n)
+	{
+		throw DimensionError();
+	}
+
+	// a = Q R, R = Qb D Pb^T with D bidiagonal, and D = Ud W Vd^T, so that
+	// U = Q Qb Ud and V = Pb Vd
+	Vector<double> tau;
+	BlockedQR(a, tau);
+
+	Matrix<double> r(n, n, 0.0);
+	for(size_t i = 0; i < n; i++)
+	{
+		for(size_t k = i; k < n; k++)
+		{
+			r(i, k) = a(i, k);
+		}
+	}
+	vector<double> d, e, tauq, taup;
+	Bidiagonalise(r.begin(), n, d, e, tauq, taup);
+
+	// The rotations of the QR steps work on the rows of U^T and V^T
+	Matrix<double> ut(n, n);
+	Matrix<double> vt(n, n);
+	ReflectorProductTranspose(r.begin(), n, tauq, true, ut.begin());
+	ReflectorProductTranspose(r.begin(), n, taup, false, vt.begin());
+	DiagonaliseBidiagonal(d, e, ut.begin(), vt.begin(), n);
+
+	Matrix<double> u(m, n, 0.0);
+	for(size_t i = 0; i < n; i++)
+	{
+		for(size_t k = 0; k < n; k++)
+		{
+			u(i, k) = ut(k, i);
+		}
+	}
+	ApplyBlockedQ(a, tau, u);
+	a = u;
+
+	w.redim(n);
+	v.redim(n, n);
+	for(size_t i = 0; i < n; i++)
+	{
+		w[i] = d[i];
+		for(size_t k = 0; k < n; k++)
+		{
+			v(k, i) = vt(i, k);
+		}
+	}
+}
+
+void BlockedEigenSystemSymmetric(Matrix<double>& m, Vector<double>& eigenvalues)
+{
+	const size_t n = m.nrows();
+	if(m.ncols() != n)
+	{
+		throw NonSquareMatrix();
+	}
+
+	// Shifted by the largest row sum, m is positive semi-definite, and its
+	// left singular vectors are its eigenvectors
+	double shift = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		double s = 0;
+		for(size_t k = 0; k < n; k++)
+		{
+			s += fabs(m(i, k));
+		}
+		shift = max(shift, s);
+	}
+	for(size_t i = 0; i < n; i++)
+	{
+		m(i, i) += shift;
+	}
+
+	Matrix<double> v;
+	BlockedSVD(m, eigenvalues, v);
+	for(size_t i = 0; i < n; i++)
+	{
+		eigenvalues[i] -= shift;
+	}
+}
+
+} // end namespace TLAS
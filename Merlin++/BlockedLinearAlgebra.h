@@ -0,0 +1,85 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef _h_BlockedLinearAlgebra
+#define _h_BlockedLinearAlgebra
+
+#include <cstddef>
+
+#include "TMatrixLib.h"
+
+// Blocked, multi-threaded dense linear algebra for large matrices (response
+// matrices, correlation matrices), on TLAS::Matrix<double>.
+//
+// The routines work on the rows of the matrices, which are contiguous, in
+// tiles that stay in cache, and share the tiles out between threads:
+//
+//	BlockedQR() is a Householder QR by panels, each panel being applied
+//	to the rest of the matrix as one block reflector I - V T V^T.
+//
+//	BlockedSVD() reduces the matrix to R with BlockedQR(), R to bidiagonal
+//	form, and diagonalises that by the implicit QR steps of svdcmp(). The
+//	rotations of each step are applied to the singular vectors together,
+//	by tiles of columns.
+//
+//	BlockedEigenSystemSymmetric() is the SVD of the matrix shifted to be
+//	positive semi-definite.
+//
+// SVDMatrix and EigenSystemSymmetricMatrix() use these routines for
+// matrices of GetBlockedThreshold() columns or more, below which the
+// unblocked routines are faster.
+
+namespace TLAS
+{
+
+/**
+ *	Number of columns from which SVDMatrix and
+ *	EigenSystemSymmetricMatrix() use the blocked routines. 0 switches
+ *	the blocked routines off.
+ */
+void SetBlockedThreshold(size_t n);
+size_t GetBlockedThreshold();
+
+/**
+ *	Number of threads used by the blocked routines (0, the default, for
+ *	ParallelThreads(0): one per hardware thread, or one when called from
+ *	the body of a parallel loop).
+ */
+void SetBlockedThreads(size_t n);
+
+/**
+ *	QR decomposition of a. On return R is on and above the diagonal of a,
+ *	and Q = H(0) H(1) ... H(k-1), k = min(nrows, ncols), is stored as the
+ *	Householder vectors below the diagonal (with an implied unit
+ *	diagonal) and their factors tau: H(i) = I - tau(i) v(i) v(i)^T.
+ */
+void BlockedQR(Matrix<double>& a, Vector<double>& tau);
+
+/**
+ *	Replace c by Q c, for Q from BlockedQR(). c must have as many rows
+ *	as qr.
+ */
+void ApplyBlockedQ(const Matrix<double>& qr, const Vector<double>& tau, Matrix<double>& c);
+
+/**
+ *	Singular value decomposition a = U W V^T of an m x n matrix, m >= n,
+ *	as svdcmp(): a is replaced by U, w is set to the singular values and
+ *	v to V. The columns of V for zero singular values are zero. Throws
+ *	ConvergenceFailure() if the rotations do not converge.
+ */
+void BlockedSVD(Matrix<double>& a, Vector<double>& w, Matrix<double>& v);
+
+/**
+ *	Eigensystem of a real symmetric matrix m, as
+ *	EigenSystemSymmetricMatrix(): m is replaced by the eigenvectors, in
+ *	its columns.
+ */
+void BlockedEigenSystemSymmetric(Matrix<double>& m, Vector<double>& eigenvalues);
+
+} // end namespace TLAS
+
+#endif // _h_BlockedLinearAlgebra
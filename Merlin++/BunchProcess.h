@@ -23,6 +23,13 @@ class Bunch;
  *	to all Bunch model types , or may be specific to a
  *	concrete bunch model (see for example ParticleBunch and
  *	ParticleBunchTransortProcess).
+ *
+ *	A process holds the state of the tracking run it belongs to
+ *	(the current bunch and component, counters, outputs), so a
+ *	process object must only be used by one tracker at a time.
+ *	Processes keep no static state, so any number of trackers,
+ *	each with its own processes, can run concurrently on a shared
+ *	AcceleratorModel (see SeedEnsemble).
  */
 
 class BunchProcess
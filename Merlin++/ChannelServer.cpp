@@ -6,6 +6,7 @@
  */
 
 #include <cassert>
+#include <algorithm>
 #include "MerlinIO.h"
 #include "Channels.h"
 #include "ModelElement.h"
@@ -57,23 +58,7 @@ struct TYPE_CMP
 
 };
 
-struct FindType
-{
-	string type;
-	bool neg;
-
-	FindType(const string& aType, bool negate = false) :
-		type(aType), neg(negate)
-	{
-	}
-
-	bool operator()(const ChannelServer::CtorTable::value_type& ctor)
-	{
-		bool ok = (ctor.second)->GetType() == type;
-		return neg ? !ok : ok;
-	}
-
-};
+typedef map<string, set<ChannelServer::ChannelCtor*> > CtorCache;
 
 } // end anonymous namespace
 
@@ -173,6 +158,7 @@ size_t ChannelServer::GetROChannels(AcceleratorModel::Beamline& aBeamline, const
 {
 	CHPath chpath(chid);
 	StringPattern idpat(chpath.eid());
+	CtorCache ctorCache;
 	size_t count = 0;
 
 	for(AcceleratorModel::BeamlineIterator cmpi = aBeamline.begin(); cmpi != aBeamline.end(); cmpi++)
@@ -185,11 +171,17 @@ size_t ChannelServer::GetROChannels(AcceleratorModel::Beamline& aBeamline, const
 			if(idpat(component.GetQualifiedName()))
 			{
 
-				set<ChannelCtor*> ctors;
-				FindCtors(component.GetType(), chpath.key, ctors);
+				// The constructors for each type are only looked up once
+				CtorCache::iterator ct = ctorCache.find(component.GetType());
+				if(ct == ctorCache.end())
+				{
+					ct = ctorCache.insert(CtorCache::value_type(component.GetType(), set<ChannelCtor*>())).first;
+					FindCtors(component.GetType(), chpath.key, ct->second);
+				}
+				const set<ChannelCtor*>& ctors = ct->second;
 
 				// Now construct the channels for the current component
-				for(set<ChannelCtor*>::iterator ci = ctors.begin(); ci != ctors.end(); ci++)
+				for(set<ChannelCtor*>::const_iterator ci = ctors.begin(); ci != ctors.end(); ci++)
 				{
 					ROChannel* ch = (*ci)->ConstructRO(&component);
 					assert(ch != 0);
@@ -208,6 +200,7 @@ size_t ChannelServer::GetRWChannels(AcceleratorModel::Beamline& aBeamline, const
 {
 	CHPath chpath(chid);
 	StringPattern idpat(chpath.eid());
+	CtorCache ctorCache;
 	size_t count = 0;
 
 	for(AcceleratorModel::BeamlineIterator cmpi = aBeamline.begin(); cmpi != aBeamline.end(); cmpi++)
@@ -220,11 +213,17 @@ size_t ChannelServer::GetRWChannels(AcceleratorModel::Beamline& aBeamline, const
 			if(idpat(component.GetQualifiedName()))
 			{
 
-				set<ChannelCtor*> ctors;
-				FindCtors(component.GetType(), chpath.key, ctors);
+				// The constructors for each type are only looked up once
+				CtorCache::iterator ct = ctorCache.find(component.GetType());
+				if(ct == ctorCache.end())
+				{
+					ct = ctorCache.insert(CtorCache::value_type(component.GetType(), set<ChannelCtor*>())).first;
+					FindCtors(component.GetType(), chpath.key, ct->second);
+				}
+				const set<ChannelCtor*>& ctors = ct->second;
 
 				// Now construct the channels for the current component
-				for(set<ChannelCtor*>::iterator ci = ctors.begin(); ci != ctors.end(); ci++)
+				for(set<ChannelCtor*>::const_iterator ci = ctors.begin(); ci != ctors.end(); ci++)
 				{
 					RWChannel* ch = (*ci)->ConstructRW(&component);
 					assert(ch != 0);
@@ -254,14 +253,9 @@ void ChannelServer::FindCtors(const string& type, const string& keypat, std::set
 {
 	ctors.clear();
 
-	CtorTable::iterator c1 = find_if(chCtors.begin(), chCtors.end(), FindType(type));
-
-	if(c1 == chCtors.end())
-	{
-		return;
-	}
-
-	CtorTable::iterator c2 = find_if(c1, chCtors.end(), FindType(type, true));
+	// The table is keyed by "type.key", so the ctors for type lie between "type." and "type/"
+	CtorTable::iterator c1 = chCtors.lower_bound(type + '.');
+	CtorTable::iterator c2 = chCtors.lower_bound(type + '/');
 
 	// Now find those ctors that match the key pattern
 	StringPattern keyp(keypat);
@@ -277,7 +271,7 @@ void ChannelServer::FindCtors(const string& type, const string& keypat, std::set
 void ChannelServer::FindElements(const std::string& id_pat, std::vector<ModelElement*>& elements)
 {
 	theElements->Find(id_pat, elements);
-	sort(elements.begin(), elements.end(), TYPE_CMP());
+	stable_sort(elements.begin(), elements.end(), TYPE_CMP());
 }
 
 ChannelServer::~ChannelServer()
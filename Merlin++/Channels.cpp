@@ -13,6 +13,22 @@
 
 using namespace std;
 
+void ROChannel::ReadBlock(ROChannel* const* chnls, size_t n, RealVector& values, size_t i0) const
+{
+	for(size_t i = 0; i < n; i++)
+	{
+		values[i0 + i] = chnls[i]->Read();
+	}
+}
+
+void RWChannel::WriteBlock(ROChannel* const* chnls, size_t n, const RealVector& values, size_t i0)
+{
+	for(size_t i = 0; i < n; i++)
+	{
+		static_cast<RWChannel*>(chnls[i])->Write(values[i0 + i]);
+	}
+}
+
 ROChannelArray::~ROChannelArray()
 {
 	DestroyChannels();
@@ -23,12 +39,36 @@ void ROChannelArray::DestroyChannels()
 	for_each(channels.begin(), channels.end(), deleter<ROChannel>());
 }
 
+void ROChannelArray::FindBlocks()
+{
+	blocks.clear();
+	for(size_t i = 0; i < channels.size(); )
+	{
+		const void* key = channels[i]->GetBlockKey();
+		size_t n = 1;
+		while(key && i + n < channels.size() && channels[i + n]->GetBlockKey() == key)
+		{
+			n++;
+		}
+		blocks.push_back(make_pair(i, n));
+		i += n;
+	}
+}
+
 void ROChannelArray::ReadAll(RealVector& vec) const
 {
 	assert(vec.size() == Size());
-	for(size_t i = 0; i < Size(); i++)
+	for(size_t b = 0; b < blocks.size(); b++)
 	{
-		vec[i] = channels[i]->Read();
+		const size_t i = blocks[b].first;
+		if(blocks[b].second == 1)
+		{
+			vec[i] = channels[i]->Read();
+		}
+		else
+		{
+			channels[i]->ReadBlock(&channels[i], blocks[b].second, vec, i);
+		}
 	}
 }
 
@@ -67,12 +107,14 @@ RWChannelArray::RWChannelArray(const std::vector<RWChannel*>& chnls) :
 	ROChannelArray(chnls.size())
 {
 	std::copy(chnls.begin(), chnls.end(), channels.begin());
+	FindBlocks();
 }
 
 RWChannelArray::RWChannelArray(RWChannelArray& rhs) :
 	ROChannelArray(rhs.Size())
 {
 	std::copy(rhs.channels.begin(), rhs.channels.end(), channels.begin());
+	blocks.swap(rhs.blocks);
 	rhs.channels.clear();
 }
 
@@ -85,6 +127,7 @@ size_t RWChannelArray::SetChannels(const std::vector<RWChannel*>& chnls)
 	DestroyChannels();
 	channels.resize(chnls.size());
 	std::copy(chnls.begin(), chnls.end(), channels.begin());
+	FindBlocks();
 	return channels.size();
 }
 
@@ -99,9 +142,17 @@ void RWChannelArray::WriteAll(double value)
 void RWChannelArray::WriteAll(const RealVector& values)
 {
 	assert(values.size() == Size());
-	for(size_t i = 0; i < Size(); i++)
+	for(size_t b = 0; b < blocks.size(); b++)
 	{
-		RWCh(i)->Write(values[i]);
+		const size_t i = blocks[b].first;
+		if(blocks[b].second == 1)
+		{
+			RWCh(i)->Write(values[i]);
+		}
+		else
+		{
+			RWCh(i)->WriteBlock(&channels[i], blocks[b].second, values, i);
+		}
 	}
 }
 
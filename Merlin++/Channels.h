@@ -36,6 +36,23 @@ public:
 	 *	associated with the channel.
 	 */
 	virtual double Read() const = 0;
+
+	/**
+	 *	Channels returning the same non-null key access the same
+	 *	parameter of elements of one type, and can be read or
+	 *	written together with ReadBlock() and WriteBlock().
+	 *	The default key is null (no block access).
+	 */
+	virtual const void* GetBlockKey() const
+	{
+		return nullptr;
+	}
+
+	/**
+	 *	Reads the n channels chnls[0..n-1], which all have the
+	 *	same block key as this channel, into values[i0..i0+n-1].
+	 */
+	virtual void ReadBlock(ROChannel* const* chnls, size_t n, RealVector& values, size_t i0) const;
 };
 
 /**
@@ -60,12 +77,24 @@ public:
 	 *	(incremented) value.
 	 */
 	virtual double Increment(double delta);
+
+	/**
+	 *	Writes values[i0..i0+n-1] to the n channels
+	 *	chnls[0..n-1], which all have the same block key as
+	 *	this channel.
+	 */
+	virtual void WriteBlock(ROChannel* const* chnls, size_t n, const RealVector& values, size_t i0);
 };
 
 /**
  *	A linear array (vector) of ROChannels. On destruction,
  *	an ROChannelArray object will destroy its associated
  *	channels.
+ *
+ *	Consecutive channels with the same block key are grouped
+ *	when the array is set up, and ReadAll() and
+ *	RWChannelArray::WriteAll() transfer each group in a
+ *	single call.
  */
 
 class ROChannelArray
@@ -136,7 +165,17 @@ protected:
 
 	void DestroyChannels();
 
+	/**
+	 *	Groups consecutive channels with the same block key.
+	 */
+	void FindBlocks();
+
 	std::vector<ROChannel*> channels;
+
+	/**
+	 *	First channel and number of channels of each group.
+	 */
+	std::vector<std::pair<size_t, size_t> > blocks;
 };
 
 class RWChannelArray: public ROChannelArray
@@ -208,12 +247,14 @@ inline double RWChannel::Increment(double delta)
 inline ROChannelArray::ROChannelArray(const std::vector<ROChannel*>& chnls) :
 	channels(chnls)
 {
+	FindBlocks();
 }
 
 inline ROChannelArray::ROChannelArray(ROChannelArray& rhs) :
 	channels()
 {
 	channels.swap(rhs.channels);
+	blocks.swap(rhs.blocks);
 }
 
 inline ROChannelArray::ROChannelArray(size_t n) :
@@ -229,6 +270,7 @@ inline size_t ROChannelArray::SetChannels(const std::vector<ROChannel*>& chnls)
 {
 	DestroyChannels();
 	channels = chnls;
+	FindBlocks();
 	return channels.size();
 }
 
@@ -16,8 +16,10 @@
 #include "InterpolatedApertures.h"
 #include "CollimatorAperture.h"
 #include "Collimator.h"
+#include "Drift.h"
 
 #include "ParticleComponentTracker.h"
+#include "MerlinIO.h"
 
 #include "CollimateParticleProcess.h"
 
@@ -31,6 +33,9 @@ namespace
 
 using namespace ParticleTracking;
 
+// Precision to which aperture crossings are located within a step
+const double loss_tolerance = 1.0 * PhysicalUnits::millimeter;
+
 void OutputIndexParticles(const PSvectorArray lost_p, const list<size_t>& lost_i, ostream& os)
 {
 	PSvectorArray::const_iterator p = lost_p.begin();
@@ -52,8 +57,9 @@ namespace ParticleTracking
 
 CollimateParticleProcess::CollimateParticleProcess(int priority, int mode, std::ostream* osp) :
 	ParticleBunchProcess("PARTICLE COLLIMATION", priority), cmode(mode), os(osp), createLossFiles(false), file_prefix(
-		""), lossThreshold(1), nstart(0), pindex(nullptr), CollimationOutputSet(false), ColParProTurn(0),
-	FirstElementSet(0), scatter(false), bin_size(0.1 * PhysicalUnits::meter), Imperfections(false)
+		""), lossThreshold(1), nstart(0), pindex(nullptr), entrySafetyFactor(2), nunresolved(0),
+	CollimationOutputSet(false), ColParProTurn(0), FirstElementSet(0), scatter(false), bin_size(0.1 * PhysicalUnits::meter),
+	Imperfections(false), lossBunch(nullptr), lossTracker(nullptr)
 {
 }
 
@@ -63,6 +69,8 @@ CollimateParticleProcess::~CollimateParticleProcess()
 	{
 		delete pindex;
 	}
+	delete lossTracker;
+	delete lossBunch;
 }
 
 void CollimateParticleProcess::InitialiseProcess(Bunch& bunch)
@@ -73,6 +81,7 @@ void CollimateParticleProcess::InitialiseProcess(Bunch& bunch)
 	{
 		nstart = currentBunch->size();
 		nlost = 0;
+		nunresolved = 0;
 		if(pindex != nullptr)
 		{
 			pindex->clear();
@@ -108,6 +117,17 @@ void CollimateParticleProcess::SetCurrentComponent(AcceleratorComponent& compone
 		const CollimatorAperture* tap = dynamic_cast<const CollimatorAperture*> (currentComponent->GetAperture());
 		is_collimator = scatter && tap;
 
+		//Drifts and collimators are straight paths, so a bunch that stays within the inscribed size of the aperture
+		//over the whole element cannot lose particles, and the element needs no collimation points. Magnets are
+		//never skipped: defocusing fields and dispersion can take a particle beyond its drift-extrapolated amplitude.
+		if((is_collimator || component.GetIndex() == Drift::ID) && BunchWithinInscribedRadius())
+		{
+			active = false;
+			s_total += component.GetLength();
+			currentComponent = nullptr;
+			return;
+		}
+
 		if(!is_collimator)
 		{
 			// not a collimator, so set up for normal hard-edge collimation
@@ -126,11 +146,12 @@ void CollimateParticleProcess::SetCurrentComponent(AcceleratorComponent& compone
 		}
 
 		//For precision tracking of lost particles in non-collimators
-		//make a copy of the input array if we are a magnet.
+		//store the entry coordinates of the particles which may be lost in this magnet.
 		//This should also occur before any tracking, hence also any poleface rotations on a dipole, etc
+		EntryStates.clear();
 		if(!is_collimator)
 		{
-			InputArray = currentBunch->GetParticles();
+			StoreEntryStates();
 		}
 	}
 	else
@@ -144,7 +165,7 @@ void CollimateParticleProcess::DoProcess(double ds)
 {
 	s += ds;
 
-	if(fequal(s, next_s))
+	if(is_collimator || fequal(s, next_s))
 	{
 		//This lets the scattering routine know how far down the collimator we are for aperture checking inside the scattering step.
 		int_s = s - ds;
@@ -162,14 +183,7 @@ void CollimateParticleProcess::DoProcess(double ds)
 
 double CollimateParticleProcess::GetMaxAllowedStepSize() const
 {
-	if(!is_collimator)
-	{
-		return next_s - s;
-	}
-	else
-	{
-		return bin_size;
-	}
+	return next_s - s;
 }
 
 void CollimateParticleProcess::IndexParticles(bool index)
@@ -202,36 +216,20 @@ void CollimateParticleProcess::SetLossThreshold(double losspc)
 
 void CollimateParticleProcess::DoCollimation()
 {
-	//The aperture of this element
 	const Aperture *ap = currentComponent->GetAperture();
 
 	// If there are no losses there is no need to go through the expensive
 	// process of copying all the particles to a new bunch. So check first
 	bool any_loss = false;
 	size_t first_loss = 0;
-	if(is_collimator)
+	double z_jaw = 0;
+	for(PSvectorArray::iterator p = currentBunch->begin(); p != currentBunch->end(); p++)
 	{
-
-		for(PSvectorArray::iterator p = currentBunch->begin(); p != currentBunch->end(); p++)
+		if(HitsAperture(*p, z_jaw))
 		{
-			if(!ap->CheckWithinApertureBoundaries((*p).x() - bin_size * (*p).xp(), (*p).y() - bin_size * (*p).yp(), s))
-			{
-				any_loss = true;
-				first_loss = p - currentBunch->begin();
-				break;
-			}
-		}
-	}
-	else
-	{
-		for(PSvectorArray::iterator p = currentBunch->begin(); p != currentBunch->end(); p++)
-		{
-			if(!ap->CheckWithinApertureBoundaries((*p).x(), (*p).y(), s))
-			{
-				any_loss = true;
-				first_loss = p - currentBunch->begin();
-				break;
-			}
+			any_loss = true;
+			first_loss = p - currentBunch->begin();
+			break;
 		}
 	}
 
@@ -257,38 +255,24 @@ void CollimateParticleProcess::DoCollimation()
 
 	size_t particle_number = 0;
 
-	if(is_collimator)
+	for(PSvectorArray::iterator p = currentBunch->begin(); p != currentBunch->end();)
 	{
-		for(PSvectorArray::iterator p = currentBunch->begin(); p != currentBunch->end();)
+		bool hit = particle_number >= first_loss && HitsAperture(*p, z_jaw);
+		if(hit && is_collimator)
 		{
-			(*p).x() -= bin_size * (*p).xp();
-			(*p).y() -= bin_size * (*p).yp();
-			p++;
+			// Move a particle that enters the jaw in this bin back to the jaw surface, and scatter from there
+			(*p).x() -= (s - z_jaw) * (*p).xp();
+			(*p).y() -= (s - z_jaw) * (*p).yp();
+			scatter_s = z_jaw;
 		}
-	}
 
-	for(PSvectorArray::iterator p = currentBunch->begin(); p != currentBunch->end();)
-	{
-		// If we are collimating at the end of the element, track back a drift
-		// Do not do this at the start of the element.
-
-//		if(is_collimator)
-//		{
-//			(*p).x() -= bin_size * (*p).xp();
-//			(*p).y() -= bin_size * (*p).yp();
-//		}
-		if(particle_number >= first_loss && !ap->CheckWithinApertureBoundaries((*p).x(), (*p).y(), s))
+		if(hit)
 		{
 			// If the 'aperture' is a collimator, then the particle is lost
 			// if the DoScatter(*p) returns true (energy cut)
 			// If not a collimator, then do not scatter and directly remove the particle.
 			if(!is_collimator || DoScatter(*p))
 			{
-				if(is_collimator)
-				{
-					(*p).ct() += (s - bin_size);
-				}
-
 				lost.push_back(*p);
 
 				// This is slow for a STL Vector - instead we place the surviving particles into a new bunch and then swap - this is faster
@@ -315,12 +299,6 @@ void CollimateParticleProcess::DoCollimation()
 		}
 		else
 		{
-			if(is_collimator)
-			{
-				(*p).x() += bin_size * (*p).xp();
-				(*p).y() += bin_size * (*p).yp();
-			}
-
 			//Not interacting with the collimator: "Inside" the aperture; particle lives
 			NewBunch->AddParticle(*p);
 			p++;
@@ -340,147 +318,375 @@ void CollimateParticleProcess::DoCollimation()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//Only copy the output if we are not a collimator and there are lost particles
+//Only locate the losses if we are not a collimator and there are lost particles
 	if(LostParticlePositions.size() != 0 && !is_collimator)
 	{
-		//make a new particle bunch to track the lost particles
-		ParticleBunch* LostBunch = new ParticleBunch(currentBunch->GetReferenceMomentum(),
-			currentBunch->GetTotalCharge() / currentBunch->size());
-		double length = currentComponent->GetLength();
-		//If we are dealing with a non-zero length element, we must do tracking
-		if(length != 0)
+		LocateLosses(ap, lost);
+	}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	nlost += lost.size();
+	// Old loss output - depreciated due to CollimationOutput
+	//DoOutput(lost,lost_i);
+
+	//make sure to clear up
+	if(!is_collimator)
+	{
+		UpdateEntryStates();        //Re-key the stored entry states for any later collimation point in this element
+	}
+	LostParticlePositions.clear();  //A list of particles we want to use in the input array
+
+	if(double(nlost) / double(nstart) >= lossThreshold)
+	{
+		std::cout << "nlost: " << nlost << "\tnstart: " << nstart << std::endl;
+		throw ExcessiveParticleLoss(currentComponent->GetQualifiedName(), lossThreshold, nlost, nstart);
+	}
+}
+
+bool CollimateParticleProcess::BunchWithinInscribedRadius() const
+{
+	double r_in = currentComponent->GetAperture()->GetInscribedRadius();
+	if(r_in == 0)
+	{
+		return false;
+	}
+
+	//The same drift-extrapolated amplitude as StoreEntryStates(), over the full length of the element
+	double length = currentComponent->GetLength();
+	for(PSvectorArray::const_iterator p = currentBunch->begin(); p != currentBunch->end(); p++)
+	{
+		double amp = fabs((*p).x()) + fabs((*p).y()) + length * (fabs((*p).xp()) + fabs((*p).yp()));
+		if(amp * entrySafetyFactor >= r_in)
 		{
-			//Clear out the old lost particles, these will all be at the end of the element which we do not want for a magnet.
-			lost.clear();
+			return false;
+		}
+	}
+	return true;
+}
 
-			//Grab the lost particles from the copied input particle array and add them to the new particle bunch
-			for(vector<unsigned int>::iterator p = LostParticlePositions.begin(); p != LostParticlePositions.end(); p++)
+bool CollimateParticleProcess::HitsAperture(const PSvector& p, double& z_jaw) const
+{
+	if(is_collimator)
+	{
+		return JawEntry(p, z_jaw);
+	}
+	return !currentComponent->GetAperture()->CheckWithinApertureBoundaries(p.x(), p.y(), s);
+}
+
+bool CollimateParticleProcess::JawEntry(const PSvector& p, double& z_jaw) const
+{
+	//The particle is at the end of the bin (s), and has drifted in a straight line from the start of the bin (int_s).
+	//Find where that path first meets the jaw material, if anywhere.
+	const CollimatorAperture* colap = static_cast<const CollimatorAperture*>(currentComponent->GetAperture());
+	double ds = s - int_s;
+	double z_in, z_out;
+	if(!colap->GapInterval(p.x() - ds * p.xp(), p.xp(), p.y() - ds * p.yp(), p.yp(), int_s, s, z_in, z_out)
+		|| z_in > int_s)
+	{
+		z_jaw = int_s;
+		return true;
+	}
+
+	z_jaw = z_out;
+	return z_out < s;
+}
+
+void CollimateParticleProcess::LocateLosses(const Aperture* ap, PSvectorArray& lost)
+{
+	//If the element has zero length nothing needs to be done since all the losses will have occurred at the same point anyway.
+	//So PSvectorArray lost will contain the correct information
+	double length = currentComponent->GetLength();
+	if(length == 0)
+	{
+		return;
+	}
+
+	//The particles in lost are at the collimation point, which we do not want for a magnet.
+	PSvectorArray exitStates;
+	exitStates.swap(lost);
+
+	if(lossBunch == nullptr)
+	{
+		lossBunch = new ParticleBunch(currentBunch->GetReferenceMomentum());
+		lossTracker = new ParticleComponentTracker();
+	}
+	lossBunch->clear();
+	lossBunch->SetReferenceMomentum(currentBunch->GetReferenceMomentum());
+
+	//Drifts are straight lines, so the path between the entry and exit states is exact and needs no tracking
+	bool is_drift = currentComponent->GetIndex() == Drift::ID;
+
+	vector<pair<size_t, PSvector> >::const_iterator e = EntryStates.begin();
+	for(size_t k = 0; k < LostParticlePositions.size(); k++)
+	{
+		while(e != EntryStates.end() && e->first < LostParticlePositions[k])
+		{
+			e++;
+		}
+
+		if(e != EntryStates.end() && e->first == LostParticlePositions[k])
+		{
+			if(is_drift)
 			{
-				LostBunch->AddParticle(InputArray[*p]);
+				LocateOnChord(ap, e->second, exitStates[k], 0, s, lost);
 			}
-			//Create a new tracker
-			ParticleComponentTracker* LostParticleTracker = new ParticleComponentTracker();
+			else
+			{
+				lossBunch->AddParticle(e->second);
+			}
+			continue;
+		}
 
-			//Tell the new tracker to use the particle bunch of lost particles that has been made
-			LostParticleTracker->SetBunch(*LostBunch);
+		//No entry state was stored, so the particle moved further than the safety bound allowed.
+		//Fall back to locating the loss at the collimation point.
+		RecordLoss(exitStates[k], s, lost);
+		nunresolved++;
+	}
 
-			//Prepare the tracker to use the current accelerator component
-			currentComponent->PrepareTracker(*LostParticleTracker);
+	if(lossBunch->size() == 0)
+	{
+		return;
+	}
 
-			//While we are still inside the component
-			while((LostParticleTracker->GetRemainingLength()) >= 0 && LostBunch->size() != 0)
+	//Track all remaining lost particles of this element together, in bin_size steps up to the collimation point.
+	//Particles are retired as soon as they are found outside, and the bin containing the crossing is kept for
+	//refinement on the element map once the batch is done.
+	lossPrevious.assign(lossBunch->begin(), lossBunch->end());
+	lossTracker->Reset();
+	lossTracker->SetBunch(*lossBunch);
+	currentComponent->PrepareTracker(*lossTracker);
+
+	vector<LossBracket> brackets;
+	PSvectorArray& particles = lossBunch->GetParticles();
+	double z = 0;
+	double z_prev = 0;
+	while(!particles.empty())
+	{
+		for(size_t i = 0; i < particles.size();)
+		{
+			if(ap->CheckWithinApertureBoundaries(particles[i].x(), particles[i].y(), z))
 			{
-				double StepSize = bin_size;
-				//If the remaining length of component is less than the step size, set the step size to this value
-				if((LostParticleTracker->GetRemainingLength() - StepSize) < 0)
-				{
-					StepSize = LostParticleTracker->GetRemainingLength();
-				}
+				i++;
+				continue;
+			}
 
-				//Track the appropriate step length
+			if(z == 0)
+			{
+				RecordLoss(particles[i], 0, lost);
+			}
+			else
+			{
+				brackets.push_back(LossBracket{lossPrevious[i], particles[i], z_prev, z});
+			}
 
-				double IntegratedLength = LostParticleTracker->GetIntegratedLength();
-				//Now loop over each particle in turn
-				for(PSvectorArray::iterator p = LostBunch->begin(); p != LostBunch->end();)
-				{
-					//Check if the particle is outside the aperture
-					//s, is where the integrator will start
-					//LostParticleTracker->GetIntegratedLength() will give the position integrated past this point
-					//(*p).ct() will give the offset for this specific particle
-
-					if(!ap->CheckWithinApertureBoundaries((*p).x(), (*p).y(), IntegratedLength))
-					{
-						//if not, delete the particle, and add the coordinates to the lost bunch list (PSvectorArray lost)
-
-						//Also set p.ct() as the length along the element!
-						(*p).ct() += IntegratedLength;
-						if((*p).ct() < 0)
-						{
-							(*p).ct() = 0;
-						}
-						if((*p).ct() > length)
-						{
-
-							(*p).ct() = length;
-						}
-
-						lost.push_back(*p);
-
-						//CollimationOutput loss
-						if(CollimationOutputSet && !is_collimator)
-						{
-							for(CollimationOutputIterator = CollimationOutputVector.begin();
-								CollimationOutputIterator != CollimationOutputVector.end();
-								++CollimationOutputIterator)
-							{
-								(*CollimationOutputIterator)->Dispose(*currentComponent, IntegratedLength, (*p), ColParProTurn);
-							}
-						}
-						p = LostBunch->erase(p);
-					}
-					//else, the particle is inside and can be kept for this step
-					else
-					{
-						p++;
-					}
-				}
+			particles[i] = particles.back();
+			particles.pop_back();
+			lossPrevious[i] = lossPrevious.back();
+			lossPrevious.pop_back();
+		}
 
-				//Now move forward...
-				if((LostParticleTracker->GetRemainingLength()) > 0)
-				{
-					LostParticleTracker->TrackStep(StepSize);
-				}
-				if(LostParticleTracker->GetRemainingLength() == 0)
-				{
-					break;
-				}
-			}
+		if(particles.empty() || z >= s || fequal(z, s))
+		{
+			break;
+		}
+
+		double step = std::min(bin_size, s - z);
+		lossPrevious.assign(particles.begin(), particles.end());
+		lossTracker->TrackStep(step);
+		z_prev = z;
+		z += step;
+	}
+
+	//Particles which were outside at the collimation point in the main tracking, but are still inside here, can
+	//not be located. Record them at the collimation point and count them as unresolved.
+	if(!particles.empty())
+	{
+		MERLIN_ERR << "CollimateParticleProcess: " << particles.size() << " lost particles still inside the aperture of "
+				   << currentComponent->GetQualifiedName() << " at s = " << z << " (length " << length
+				   << "), recorded at the collimation point" << endl;
+		for(PSvectorArray::iterator p = particles.begin(); p != particles.end(); p++)
+		{
+			RecordLoss(*p, z, lost);
+		}
+		nunresolved += particles.size();
+		particles.clear();
+	}
+
+	for(vector<LossBracket>::iterator b = brackets.begin(); b != brackets.end(); b++)
+	{
+		LocateOnMap(ap, *b, lost);
+	}
+}
+
+void CollimateParticleProcess::LocateOnMap(const Aperture* ap, const LossBracket& b, PSvectorArray& lost)
+{
+	//The particle is inside at z0 and outside at z1. Bisect on the tracked position within this bin, tracking the
+	//state at z0 afresh through the element map to each trial point, down to loss_tolerance.
+	double lo = b.z0;
+	double hi = b.z1;
+	PSvector p_hi(b.outside);
+	while(hi - lo > loss_tolerance)
+	{
+		double zt = 0.5 * (lo + hi);
+		PSvector p = TrackFrom(b.inside, b.z0, zt);
+		if(ap->CheckWithinApertureBoundaries(p.x(), p.y(), zt))
+		{
+			lo = zt;
+		}
+		else
+		{
+			hi = zt;
+			p_hi = p;
+		}
+	}
+	RecordLoss(p_hi, hi, lost);
+}
 
-			//If there is anything left - possible bug.
-			if(LostBunch->size() != 0)
+PSvector CollimateParticleProcess::TrackFrom(const PSvector& p0, double z0, double z)
+{
+	//The integrator only knows its position from the length it has tracked, so bring it to z0 with no particles
+	//before adding p0. Any entrance map is then applied to p0 only if z0 is the entrance.
+	lossBunch->clear();
+	lossTracker->Reset();
+	lossTracker->SetBunch(*lossBunch);
+	currentComponent->PrepareTracker(*lossTracker);
+	if(z0 > 0)
+	{
+		lossTracker->TrackStep(z0);
+	}
+
+	lossBunch->AddParticle(p0);
+	lossTracker->TrackStep(z - z0);
+	return lossBunch->GetParticles().front();
+}
+
+void CollimateParticleProcess::LocateOnChord(const Aperture* ap, const PSvector& p0, const PSvector& p1, double z0,
+	double z1, PSvectorArray& lost)
+{
+	//p0 is inside at z0, and p1 outside at z1. Scan the straight path between them on the bin grid for the first
+	//point outside, then bisect within that bin down to loss_tolerance.
+	double lo = 0;
+	double hi = 1;
+	double dz = z1 - z0;
+	if(!ap->CheckWithinApertureBoundaries(p0.x(), p0.y(), z0))
+	{
+		hi = 0;
+	}
+	else if(dz > bin_size)
+	{
+		double dt = bin_size / dz;
+		for(double t = dt; t < 1; t += dt)
+		{
+			if(!ap->CheckWithinApertureBoundaries(p0.x() + t * (p1.x() - p0.x()), p0.y() + t * (p1.y() - p0.y()), z0
+				+ t * dz))
 			{
-				std::cout << "POSSIBLE BUG: Leftovers: " << LostBunch->size() << "\t"
-						  << currentComponent->GetQualifiedName() << "\t"
-						  << LostParticleTracker->GetIntegratedLength() << "\t" << length << std::endl;
-				for(PSvectorArray::iterator p = LostBunch->begin(); p != LostBunch->end(); p++)
-				{
-					(*p).ct() += LostParticleTracker->GetIntegratedLength();
-					if((*p).ct() > length)
-					{
-						(*p).ct() = length;
-					}
-					lost.push_back(*p);
-				}
+				hi = t;
+				break;
 			}
+			lo = t;
+		}
+	}
 
-			//clean up the tracker
-			delete LostParticleTracker;
-			//and the "lost particle bunch"
-			delete LostBunch;
+	while((hi - lo) * dz > loss_tolerance)
+	{
+		double t = 0.5 * (lo + hi);
+		if(ap->CheckWithinApertureBoundaries(p0.x() + t * (p1.x() - p0.x()), p0.y() + t * (p1.y() - p0.y()), z0 + t
+			* dz))
+		{
+			lo = t;
+		}
+		else
+		{
+			hi = t;
 		}
-		//if the element has zero length nothing needs to be done since all the losses will have occurred at the same point anyway.
-		//So PSvectorArray loss will contain the correct information
 	}
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	PSvector p(p0);
+	p.x() += hi * (p1.x() - p0.x());
+	p.xp() += hi * (p1.xp() - p0.xp());
+	p.y() += hi * (p1.y() - p0.y());
+	p.yp() += hi * (p1.yp() - p0.yp());
+	RecordLoss(p, z0 + hi * dz, lost);
+}
 
-	nlost += lost.size();
-	// Old loss output - depreciated due to CollimationOutput
-	//DoOutput(lost,lost_i);
+void CollimateParticleProcess::RecordLoss(PSvector& p, double z, PSvectorArray& lost)
+{
+	//Set p.ct() as the length along the element!
+	double length = currentComponent->GetLength();
+	p.ct() += z;
+	if(p.ct() < 0)
+	{
+		p.ct() = 0;
+	}
+	if(p.ct() > length)
+	{
+		p.ct() = length;
+	}
 
-	//make sure to clear up
-	InputArray.clear();             //The input array
-	LostParticlePositions.clear();  //A list of particles we want to use in the input array
+	lost.push_back(p);
 
-	if(double(nlost) / double(nstart) >= lossThreshold)
+	//CollimationOutput loss
+	if(CollimationOutputSet)
 	{
-		std::cout << "nlost: " << nlost << "\tnstart: " << nstart << std::endl;
-		throw ExcessiveParticleLoss(currentComponent->GetQualifiedName(), lossThreshold, nlost, nstart);
+		for(CollimationOutputIterator = CollimationOutputVector.begin();
+			CollimationOutputIterator != CollimationOutputVector.end();
+			++CollimationOutputIterator)
+		{
+			(*CollimationOutputIterator)->Dispose(*currentComponent, z, p, ColParProTurn);
+		}
 	}
 }
 
+void CollimateParticleProcess::StoreEntryStates()
+{
+	//Zero length elements locate all losses at the collimation point, so nothing is re-tracked
+	double length = currentComponent->GetLength();
+	if(length == 0)
+	{
+		return;
+	}
+
+	//A particle whose drift-extrapolated amplitude stays well inside the inscribed aperture cannot be lost here.
+	//Only the remaining (at risk) particles are copied, so the cost scales with the halo, not the bunch.
+	double r_in = currentComponent->GetAperture()->GetInscribedRadius();
+	size_t n = 0;
+	for(PSvectorArray::const_iterator p = currentBunch->begin(); p != currentBunch->end(); p++, n++)
+	{
+		double amp = fabs((*p).x()) + fabs((*p).y()) + length * (fabs((*p).xp()) + fabs((*p).yp()));
+		if(amp * entrySafetyFactor >= r_in)
+		{
+			EntryStates.push_back(make_pair(n, *p));
+		}
+	}
+}
+
+void CollimateParticleProcess::UpdateEntryStates()
+{
+	//Drop the entries of lost particles, and shift the remaining keys to the new bunch positions
+	vector<unsigned int>::const_iterator l = LostParticlePositions.begin();
+	vector<pair<size_t, PSvector> >::iterator out = EntryStates.begin();
+	size_t nremoved = 0;
+	for(vector<pair<size_t, PSvector> >::iterator e = EntryStates.begin(); e != EntryStates.end(); e++)
+	{
+		while(l != LostParticlePositions.end() && *l < e->first)
+		{
+			l++;
+			nremoved++;
+		}
+		if(l != LostParticlePositions.end() && *l == e->first)
+		{
+			continue;
+		}
+		out->first = e->first - nremoved;
+		out->second = e->second;
+		out++;
+	}
+	EntryStates.erase(out, EntryStates.end());
+}
+
 void CollimateParticleProcess::SetNextS()
 {
 
@@ -504,17 +710,13 @@ void CollimateParticleProcess::SetNextS()
 		active = false;
 	}
 
+	//Each step through a collimator, which runs to the exit unless another process shortens it, ends in a
+	//collimation point. The scattering follows the particles between the jaw surfaces, so bin_size only bins the
+	//output.
 	if(is_collimator)
 	{
-		active = true;
-		if((s + bin_size) > currentComponent->GetLength())
-		{
-			next_s = currentComponent->GetLength();
-		}
-		else
-		{
-			next_s = s + bin_size;
-		}
+		next_s = currentComponent->GetLength();
+		active = !fequal(s, next_s);
 	}
 }
 
@@ -666,4 +868,13 @@ void CollimateParticleProcess::EnableImperfections(bool enable)
 {
 	Imperfections = enable;
 }
+
+void CollimateParticleProcess::SetEntryStateSafetyFactor(double f)
+{
+	if(!(f >= 1))
+	{
+		throw MerlinException("CollimateParticleProcess::SetEntryStateSafetyFactor: the factor must be at least 1");
+	}
+	entrySafetyFactor = f;
+}
 } // end namespace ParticleTracking
@@ -14,6 +14,7 @@
 
 #include "merlin_config.h"
 #include "ParticleBunchProcess.h"
+#include "ParticleComponentTracker.h"
 #include "PSTypes.h"
 #include "CollimationOutput.h"
 #include "MerlinException.h"
@@ -141,6 +142,27 @@ public:
 	 */
 	void EnableImperfections(bool);
 
+	/**
+	 * Sets the safety factor used to decide which particles need their
+	 * entry coordinates stored for precise loss location in magnets. A
+	 * particle is stored unless its drift-extrapolated amplitude through
+	 * the element, multiplied by this factor, lies inside the inscribed
+	 * aperture (see Aperture::GetInscribedRadius()). Default 2. The same
+	 * test over the whole bunch lets drifts and collimators be skipped;
+	 * magnets always get their collimation points. Throws MerlinException
+	 * if f is less than 1, which would skip particles that can be lost.
+	 */
+	void SetEntryStateSafetyFactor(double f);
+
+	/**
+	 * Returns the number of lost particles for which no entry state was
+	 * stored, and which were therefore located at the collimation point.
+	 */
+	size_t GetUnresolvedLossCount() const
+	{
+		return nunresolved;
+	}
+
 	virtual double GetOutputBinSize() const;
 	virtual void SetOutputBinSize(double);
 
@@ -166,15 +188,26 @@ protected:
 	IDTBL idtbl;
 
 	/**
-	 * The input array
+	 * Entry coordinates of the particles at risk of loss in the current
+	 * element, keyed by their current position in the bunch (ascending).
 	 */
-	PSvectorArray InputArray;
+	std::vector<std::pair<size_t, PSvector> > EntryStates;
+	double entrySafetyFactor;
+	size_t nunresolved;
 
 	double s_total;
 	double s;
 	double next_s;
 	double int_s;
 
+	/**
+	 * Position in the collimator at which the particle passed to
+	 * DoScatter() enters the jaw material. The scattering path starts
+	 * here, and a particle lost in the jaw has its ct() set to the
+	 * position of the loss along the collimator.
+	 */
+	double scatter_s;
+
 	/**
 	 * physical length
 	 */
@@ -207,6 +240,65 @@ private:
 
 	virtual void DoCollimation();
 	void SetNextS();
+	void StoreEntryStates();
+	void UpdateEntryStates();
+
+	/**
+	 * Returns true if every particle of the bunch stays within the
+	 * inscribed size of the current aperture (see
+	 * Aperture::GetInscribedRadius()) along its straight path through
+	 * the whole element, allowing for the entry state safety factor.
+	 */
+	bool BunchWithinInscribedRadius() const;
+
+	/**
+	 * Returns true if p is outside the aperture at the current collimation
+	 * point (for a collimator: enters the jaw in the current bin, with z_jaw
+	 * set as for JawEntry).
+	 */
+	bool HitsAperture(const PSvector& p, double& z_jaw) const;
+
+	/**
+	 * Returns true if the straight path of p through the current bin
+	 * meets the collimator jaw material, with z_jaw the first point in
+	 * the material.
+	 */
+	bool JawEntry(const PSvector& p, double& z_jaw) const;
+
+	/**
+	 * Finds the position of each lost particle's aperture crossing in
+	 * the current element, starting from the stored entry states.
+	 * Drifts use the straight path to the collimation point. Other
+	 * elements are tracked as one batch to find the bin of each
+	 * crossing, which is then refined on the element map.
+	 */
+	void LocateLosses(const Aperture* ap, PSvectorArray& lost);
+
+	/**
+	 * A lost particle's tracked states at the ends of the bin containing
+	 * its crossing: inside at z0, and outside at z1.
+	 */
+	struct LossBracket
+	{
+		PSvector inside;
+		PSvector outside;
+		double z0;
+		double z1;
+	};
+
+	/**
+	 * Bisects a bracketed crossing down to the loss tolerance, tracking
+	 * the state at z0 through the element to each trial position.
+	 */
+	void LocateOnMap(const Aperture* ap, const LossBracket& b, PSvectorArray& lost);
+
+	/**
+	 * Tracks the state p0 at z0 through the current element to z.
+	 */
+	PSvector TrackFrom(const PSvector& p0, double z0, double z);
+	void LocateOnChord(const Aperture* ap, const PSvector& p0, const PSvector& p1, double z0, double z1,
+		PSvectorArray& lost);
+	void RecordLoss(PSvector& p, double z, PSvectorArray& lost);
 	virtual void DoOutput(const PSvectorArray& lostb, const std::list<size_t>& lost_i);
 	void bin_lost_output(const PSvectorArray& lostb);
 
@@ -225,6 +317,13 @@ private:
 	 * A list of particles we want to use in the input array
 	 */
 	std::vector<unsigned int> LostParticlePositions;
+
+	/**
+	 * Reused by LocateLosses() for tracking lost particles
+	 */
+	ParticleBunch* lossBunch;
+	ParticleComponentTracker* lossTracker;
+	std::vector<PSvector> lossPrevious;
 };
 
 inline void CollimateParticleProcess::CreateParticleLossFiles(bool flg, string fprefix)
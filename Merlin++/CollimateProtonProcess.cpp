@@ -53,7 +53,7 @@ bool CollimateProtonProcess::DoScatter(Particle& p)
 	// Length of the collimator
 	double coll_length = currentComponent->GetLength();
 
-	double z = int_s;
+	double z = scatter_s;
 	double lengthtogo = s - z;
 	Collimator* C = static_cast<Collimator*>(currentComponent);
 
@@ -83,7 +83,7 @@ bool CollimateProtonProcess::DoScatter(Particle& p)
         }
     }
  */
-	const Aperture *colap = C->GetAperture();
+	const CollimatorAperture *colap = static_cast<const CollimatorAperture*>(C->GetAperture());
 
 	//set scattering model
 	if(scattermodel == nullptr)
@@ -92,19 +92,49 @@ bool CollimateProtonProcess::DoScatter(Particle& p)
 		std::cout << "Use 'myCollimateProcess->SetScatteringModel(myScatter);'" << std::endl;
 		exit(EXIT_FAILURE);
 	}
+	//Paths closer than this to a jaw surface are taken to be on it
+	const double surface_tolerance = 1.0e-12;
+
 	while(lengthtogo > 0)
 	{
+		//The gap is convex, so the straight path to the end of the step meets it in at most one interval [z_in, z_out]
+		double cz = sqrt(1 - p.xp() * p.xp() - p.yp() * p.yp());
+		double z_end = z + lengthtogo * cz;
+		double z_in, z_out;
+		bool gap = colap->GapInterval(p.x(), p.xp() / cz, p.y(), p.yp() / cz, z, z_end, z_in, z_out)
+			&& z_out > z + surface_tolerance;
+		if(gap && z_in <= z + surface_tolerance)
+		{
+			if(z_out >= z_end)
+			{
+				//escaped jaw, so propagate to the end of the step
+				p.x() += p.xp() * lengthtogo;
+				p.y() += p.yp() * lengthtogo;
+				return false;
+			}
+
+			//cross the gap to where the path meets the jaw again, after which it stays in the material
+			double gap_length = (z_out - z) / cz;
+			p.x() += p.xp() * gap_length;
+			p.y() += p.yp() * gap_length;
+			z = z_out;
+			lengthtogo -= gap_length;
+			gap = false;
+		}
+
+		//The material runs to where the path leaves the jaw, or to the end of the step
+		double material_length = gap ? (z_in - z) / cz : lengthtogo;
+
 		double E1 = E0 * (1 + p.dp());
-		//Note that pathlength should be calculated with E0
 
-		double xlen = scattermodel->PathLength(C->GetMaterialProperties(), E0);
+		//Mean free path at the particle energy
+		double xlen = scattermodel->PathLength(C->GetMaterialProperties(), E1);
 
 		double E2 = 0;
 
-		bool interacted = (lengthtogo > xlen);
-		double step_size = interacted ? xlen : lengthtogo;
-
-		double zstep = step_size * sqrt(1 - p.xp() * p.xp() - p.yp() * p.yp());
+		bool interacted = (material_length > xlen);
+		double step_size = interacted ? xlen : material_length;
+		double zstep = step_size * cz;
 
 		p.x() += step_size * p.xp();
 		p.y() += step_size * p.yp();
@@ -155,23 +185,7 @@ bool CollimateProtonProcess::DoScatter(Particle& p)
 			scattermodel->ScatterPlot(p, z, ColParProTurn, ColName);
 		}
 
-		if((colap->CheckWithinApertureBoundaries((p.x()), (p.y()), z)))
-		{
-                    // check it does not come back in
-                        double extrax=p.x()+p.xp()*lengthtogo;
-                        double extray=p.y()+p.yp()*lengthtogo;
-                        if(colap->CheckWithinApertureBoundaries(extrax,extray,z+lengthtogo)){
-			//escaped jaw, so propagate to end of element
-			p.x() =extrax;
-			p.y() =extray;
-			return false;
-                        }
-		}
-
-		if(xlen > lengthtogo)
-		{
-			return false;
-		}
+		lengthtogo -= step_size;
 
 		//Scattering - use E2
 
@@ -207,13 +221,10 @@ bool CollimateProtonProcess::DoScatter(Particle& p)
 			}
 			return true;
 		}
-
-		lengthtogo -= step_size;
-
 	}
 
-	//If we reached here the particle hits the end of the collimator, and thus survives
-	return true;
+	//If we reached here the particle is still in the jaw at the end of the step, and thus survives it
+	return false;
 }
 
 void CollimateProtonProcess::SetScatteringModel(Collimation::ScatteringModel* s)
@@ -40,6 +40,13 @@ public:
 private:
 	Collimation::ScatteringModel* scattermodel;
 
+	/**
+	 * Scatters the particle through the jaws from scatter_s to the end of
+	 * the step. Each material step ends at the next interaction or where
+	 * the straight path leaves the jaw, and a path that crosses the gap
+	 * continues from where it meets the jaw again. Returns true if the
+	 * particle is lost.
+	 */
 	bool DoScatter(Particle&) override;
 
 };
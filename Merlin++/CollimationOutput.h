@@ -189,6 +189,15 @@ public:
 	{
 	}
 
+	/**
+	 * Appends the losses recorded by another output, e.g. one filled by a separate seed
+	 * of a SeedEnsemble. Call before Finalise().
+	 */
+	virtual void Merge(const CollimationOutput& other)
+	{
+		DeadParticles.insert(DeadParticles.end(), other.DeadParticles.begin(), other.DeadParticles.end());
+	}
+
 	/**
 	 * Output type switch
 	 */
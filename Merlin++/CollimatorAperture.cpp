@@ -5,9 +5,40 @@
  * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
  */
 
+#include <limits>
+
 #include "CollimatorAperture.h"
 #include "RandomNG.h"
 
+namespace
+{
+
+// Restricts the interval [lo, hi] to the z satisfying c * z < d
+inline void ClipLinear(double c, double d, double& lo, double& hi)
+{
+	if(c > 0)
+	{
+		hi = fmin(hi, d / c);
+	}
+	else if(c < 0)
+	{
+		lo = fmax(lo, d / c);
+	}
+	else if(d <= 0)
+	{
+		lo = std::numeric_limits<double>::infinity();
+	}
+}
+
+// Restricts [lo, hi] to where |a + b * z| * 2 < w + dw * z
+inline void ClipSlab(double a, double b, double w, double dw, double& lo, double& hi)
+{
+	ClipLinear(2 * b - dw, w - 2 * a, lo, hi);
+	ClipLinear(-2 * b - dw, w + 2 * a, lo, hi);
+}
+
+} // end anonymous namespace
+
 CollimatorAperture::CollimatorAperture(double w, double h, double t, double length, double x_off, double y_off) :
 	RectEllipseAperture(), alpha(t), CollimatorLength(length), x_offset_entry(x_off), y_offset_entry(y_off),
 	x_offset_exit(0), y_offset_exit(
@@ -40,6 +71,38 @@ inline bool CollimatorAperture::CheckWithinApertureBoundaries(double x, double y
 	return fabs(x1) * 2 < x_jaw && fabs(y1) * 2 < y_jaw;
 }
 
+double CollimatorAperture::GetInscribedRadius() const
+{
+	if(x_offset_entry != 0 || y_offset_entry != 0 || x_offset_exit != 0 || y_offset_exit != 0)
+	{
+		return 0;
+	}
+	return fmax(0.0, fmin(fmin(rectHalfX, rectHalfY), fmin(w_exit, h_exit) / 2));
+}
+
+bool CollimatorAperture::GapInterval(double x, double xp, double y, double yp, double z0, double z1, double& z_in,
+	double& z_out) const
+{
+	// Along the path the jaw frame coordinates u, v and the gap widths are all linear in z
+	double dxo = (x_offset_entry - x_offset_exit) / CollimatorLength;
+	double dyo = (y_offset_entry - y_offset_exit) / CollimatorLength;
+	double ax = x - xp * z0 - x_offset_entry;
+	double ay = y - yp * z0 - y_offset_entry;
+	double bx = xp + dxo;
+	double by = yp + dyo;
+
+	double W = GetFullEntranceWidth();
+	double H = GetFullEntranceHeight();
+	double dW = (w_exit - W) / CollimatorLength;
+	double dH = (h_exit - H) / CollimatorLength;
+
+	z_in = z0;
+	z_out = z1;
+	ClipSlab(ax * cosalpha - ay * sinalpha, bx * cosalpha - by * sinalpha, W, dW, z_in, z_out);
+	ClipSlab(ax * sinalpha + ay * cosalpha, bx * sinalpha + by * cosalpha, H, dH, z_in, z_out);
+	return z_in < z_out;
+}
+
 void CollimatorAperture::SetEntranceWidth(double width)
 {
 	w_entrance = width;
@@ -143,6 +206,19 @@ inline bool UnalignedCollimatorAperture::CheckWithinApertureBoundaries(double x,
 	return fabs(x1) * 2 < GetFullEntranceWidth() && fabs(y1) * 2 < GetFullEntranceHeight();
 }
 
+bool UnalignedCollimatorAperture::GapInterval(double x, double xp, double y, double yp, double z0, double z1,
+	double& z_in, double& z_out) const
+{
+	double ax = x - xp * z0 - x_offset_entry;
+	double ay = y - yp * z0 - y_offset_entry;
+
+	z_in = z0;
+	z_out = z1;
+	ClipSlab(ax * cosalpha - ay * sinalpha, xp * cosalpha - yp * sinalpha, GetFullEntranceWidth(), 0, z_in, z_out);
+	ClipSlab(ax * sinalpha + ay * cosalpha, xp * sinalpha + yp * cosalpha, GetFullEntranceHeight(), 0, z_in, z_out);
+	return z_in < z_out;
+}
+
 inline bool CollimatorApertureWithErrors::CheckWithinApertureBoundaries(double x, double y, double z) const
 {
 	double x_off = (z * (x_offset_entry - x_offset_exit) / CollimatorLength) - x_offset_entry;
@@ -185,6 +261,22 @@ inline bool OneSidedUnalignedCollimatorAperture::CheckWithinApertureBoundaries(d
 	}
 }
 
+bool OneSidedUnalignedCollimatorAperture::GapInterval(double x, double xp, double y, double yp, double z0, double z1,
+	double& z_in, double& z_out) const
+{
+	double ax = x - xp * z0 - x_offset_entry;
+	double ay = y - yp * z0 - y_offset_entry;
+	double au = ax * cosalpha - ay * sinalpha;
+	double bu = xp * cosalpha - yp * sinalpha;
+	double sign = JawSide ? 1 : -1;
+
+	z_in = z0;
+	z_out = z1;
+	ClipLinear(sign * 2 * bu, GetFullEntranceWidth() - sign * 2 * au, z_in, z_out);
+	ClipSlab(ax * sinalpha + ay * cosalpha, xp * sinalpha + yp * cosalpha, GetFullEntranceHeight(), 0, z_in, z_out);
+	return z_in < z_out;
+}
+
 void OneSidedUnalignedCollimatorAperture::SetJawSide(bool side)
 {
 	JawSide = side;
@@ -141,6 +141,24 @@ public:
 	 */
 	virtual bool CheckWithinApertureBoundaries(double x, double y, double z) const;
 
+	/**
+	 *  CollimatorAperture override of Aperture member function GetInscribedRadius()
+	 *  Only centred jaws give a non-zero value: the smallest of the entrance and exit half gaps.
+	 *  @return inscribed half-diagonal of the jaw gap
+	 */
+	virtual double GetInscribedRadius() const;
+
+	/**
+	 *  Finds, in closed form, where a straight path lies inside the jaw gap.
+	 *  The path is (x + xp * (z - z0), y + yp * (z - z0)) for z in [z0, z1].
+	 *  The gap is bounded by planes, so the part inside is a single interval.
+	 *  @param[out] z_in start of the part of the path inside the gap
+	 *  @param[out] z_out end of the part of the path inside the gap
+	 *  @return true if some part of the path is inside the gap
+	 */
+	virtual bool GapInterval(double x, double xp, double y, double yp, double z0, double z1, double& z_in, double& z_out)
+	const;
+
 protected:
 	double alpha;
 	double CollimatorLength;
@@ -171,6 +189,11 @@ public:
 	 *  @return true/false flag
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
+
+	/**
+	 *  UnalignedCollimatorAperture override of CollimatorAperture member function GapInterval()
+	 */
+	bool GapInterval(double x, double xp, double y, double yp, double z0, double z1, double& z_in, double& z_out) const;
 };
 
 class CollimatorApertureWithErrors: public CollimatorAperture
@@ -218,6 +241,12 @@ public:
 	 *  @return true/false flag
 	 */
 	bool CheckWithinApertureBoundaries(double x, double y, double z) const;
+
+	/**
+	 *  OneSidedUnalignedCollimatorAperture override of CollimatorAperture member function GapInterval()
+	 */
+	bool GapInterval(double x, double xp, double y, double yp, double z0, double z1, double& z_in, double& z_out) const;
+
 	bool JawSide;
 
 	/**
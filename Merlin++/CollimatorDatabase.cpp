@@ -166,20 +166,29 @@ double CollimatorDatabase::ConfigureCollimators(AcceleratorModel* model, double
 		CollimatorMap.insert(pair<string, Collimator*>((*c)->GetName(), (*c)));
 	}
 
+	const vector<double>& spos = twiss->Column(0, 0, 0);
+	const vector<double>& betx = twiss->Column(1, 1, 1);
+	const vector<double>& bety = twiss->Column(3, 3, 2);
+	const vector<double>& orbx = twiss->Column(1, 0, 0);
+	const vector<double>& orby = twiss->Column(3, 0, 0);
+
 	for(size_t i = 0; i < number_collimators; i++)
 	{
 		//Time to search for the collimator we are currently using
 		CMapit = CollimatorMap.find(CollData[i].name);
 		if(CMapit != CollimatorMap.end())
 		{
-			for(int j = 0; j <= twiss->NumberOfRows(); j++)
+			//Only rows at the collimator position can match, and the s column is sorted
+			int n1, n2;
+			twiss->GetSPosRange((CMapit->second)->GetComponentLatticePosition(), n1, n2);
+			for(int j = n1; j < n2; j++)
 			{
-				if((CMapit->second)->GetComponentLatticePosition() == twiss->Value(0, 0, 0, j))
+				if((CMapit->second)->GetComponentLatticePosition() == spos[j])
 				{
 					if(logFlag)
 					{
 						*log << std::setw(20) << (CMapit->second)->GetName() << std::setw(7) << j << std::setw(14)
-							 << twiss->Value(0, 0, 0, j);
+							 << spos[j];
 					}
 
 					if(ErrorLogFlag)
@@ -187,21 +196,23 @@ double CollimatorDatabase::ConfigureCollimators(AcceleratorModel* model, double
 						*ErrorLog << std::setw(20) << (CMapit->second)->GetName() << std::setw(7) << j;
 					}
 
-					double beta_x = twiss->Value(1, 1, 1, j);      //Beta x
-					double beta_y = twiss->Value(3, 3, 2, j);      //Beta y
+					double beta_x = betx[j];      //Beta x
+					double beta_y = bety[j];      //Beta y
 
 					//Added x and y orbit parameters to center collimators on where the beam actually goes.
-					double x_orbit = twiss->Value(1, 0, 0, j);
-					double y_orbit = twiss->Value(3, 0, 0, j);
+					double x_orbit = orbx[j];
+					double y_orbit = orby[j];
 					double collimator_aperture_tilt = CollData[i].tilt;
 
 					//New - we also want to align the collimator to the reference orbit and the beta function
-					double beta_x_exit = twiss->Value(1, 1, 1, j + 1);       //Beta x
-					double beta_y_exit = twiss->Value(3, 3, 2, j + 1);       //Beta y
+					//A collimator in the last row has no following row, so its exit takes the entrance values
+					size_t k = static_cast<size_t>(j) + 1 < spos.size() ? j + 1 : j;
+					double beta_x_exit = betx[k];       //Beta x
+					double beta_y_exit = bety[k];       //Beta y
 
 					//Added x and y orbit parameters to center collimators on where the beam actually goes.
-					double x_orbit_exit = twiss->Value(1, 0, 0, j + 1);
-					double y_orbit_exit = twiss->Value(3, 0, 0, j + 1);
+					double x_orbit_exit = orbx[k];
+					double y_orbit_exit = orby[k];
 
 					if(logFlag)
 					{
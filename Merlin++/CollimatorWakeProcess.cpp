@@ -31,205 +31,169 @@ using namespace PhysicalUnits;
 using namespace PhysicalConstants;
 using namespace ParticleTracking;
 
-namespace
-{
-inline double powd(double x, int y)
-{
-	double product(1);
-	for(int i = 1; i <= y; i++)
-	{
-		product *= x;
-	}
-	return product;
-}
-}
-
 namespace ParticleTracking
 {
 
 // Constructor
 
 CollimatorWakeProcess::CollimatorWakeProcess(int modes, int prio, size_t nb, double ns) :
-	WakeFieldProcess(prio, nb, ns)
+	WakeFieldProcess(prio, nb, ns), nmodes(modes), Cm(modes + 1), Sm(modes + 1), wake_sl(modes + 1), wake_cl(modes
+	+ 1), wake_ct(modes + 1), wake_st(modes + 1), wtrans(modes + 1), wlong(modes + 1), tableVersion(0), tableDz(0),
+	collimator_wake(nullptr)
 {
-	nmodes = modes;
-	Cm = new double*[modes + 1];
-	Sm = new double*[modes + 1];
-	wake_ct = new double*[modes + 1];
-	wake_st = new double*[modes + 1];
-	wake_cl = new double*[modes + 1];
-	wake_sl = new double*[modes + 1];
-	for(int i = 0; i <= nmodes; i++)
-	{
-		Cm[i] = new double[1000];
-		Sm[i] = new double[1000];
-		wake_ct[i] = new double[1000];
-		wake_st[i] = new double[1000];
-		wake_cl[i] = new double[1000];
-		wake_sl[i] = new double[1000];
-	}
 }
 
 // Destructor
 
 CollimatorWakeProcess::~CollimatorWakeProcess()
 {
-	for(int i = 0; i < nmodes; i++)
+}
+
+// Calculates the moments Cm and Sm for each slice. r^m cos(m theta) and r^m sin(m theta)
+// are the real and imaginary parts of (x + iy)^m, found by recurrence from mode m - 1.
+void CollimatorWakeProcess::CalculateMoments()
+{
+	for(int m = 1; m <= nmodes; m++)
 	{
-		delete[] Cm[i];
-		delete[] Sm[i];
-		delete[] wake_ct[i];
-		delete[] wake_st[i];
-		delete[] wake_cl[i];
-		delete[] wake_sl[i];
+		Cm[m].assign(nbins + 1, 0.0);
+		Sm[m].assign(nbins + 1, 0.0);
 	}
 
-	delete[] Cm;
-	delete[] Sm;
-	delete[] wake_ct;
-	delete[] wake_st;
-	delete[] wake_cl;
-	delete[] wake_sl;
+	for(size_t slice = 0; slice < nbins; slice++)
+	{
+		for(ParticleBunch::iterator p = bunchSlices[slice]; p != bunchSlices[slice + 1]; p++)
+		{
+			const double x = p->x();
+			const double y = p->y();
+			double c = 1;
+			double s = 0;
+			for(int m = 1; m <= nmodes; m++)
+			{
+				const double cn = c * x - s * y;
+				s = c * y + s * x;
+				c = cn;
+				Cm[m][slice] += c;
+				Sm[m][slice] += s;
+			}
+		}
+	}
 }
 
-// Calculates the moments Cm for each slice
-double CollimatorWakeProcess::CalculateCm(int mode, int slice)
+void CollimatorWakeProcess::TabulateWakes(double dz)
 {
-	double x = 0;
-	for(ParticleBunch::iterator p = bunchSlices[slice]; p != bunchSlices[slice + 1]; p++)
+	if(tableVersion == collimator_wake->GetVersion() && tableDz == dz && wtrans[nmodes].size() == nbins)
 	{
-		double r = sqrt(powd(p->x(), 2) + powd(p->y(), 2));
-		double theta = atan2(p->y(), p->x());
-		x += powd(r, mode) * cos(mode * theta);
+		return;
 	}
-	return x;
-}
 
-// Calculates  the moments Sm for each slice
-double CollimatorWakeProcess::CalculateSm(int mode, int slice)
-{
-	double x = 0;
-	for(ParticleBunch::iterator p = bunchSlices[slice]; p != bunchSlices[slice + 1]; p++)
+	for(int m = 1; m <= nmodes; m++)
 	{
-		double r = sqrt(powd(p->x(), 2) + powd(p->y(), 2));
-		double theta = atan2(p->y(), p->x());
-		x += powd(r, mode) * sin(mode * theta);
+		wtrans[m].resize(nbins);
+		wlong[m].resize(nbins);
+		for(size_t k = 0; k < nbins; k++)
+		{
+			wtrans[m][k] = collimator_wake->Wtrans(k * dz, m);
+			wlong[m][k] = collimator_wake->Wlong(k * dz, m);
+		}
 	}
-	return x;
+	tableVersion = collimator_wake->GetVersion();
+	tableDz = dz;
 }
 
 // Calculate the transverse wake with modes
 void CollimatorWakeProcess::CalculateWakeT(double dz, int currmode)
 {
-	vector<double> w(nbins);
-	for(size_t slice = 0; slice < nbins; slice++)
-	{
-		w[slice] = collimator_wake->Wtrans(slice * dz, currmode);
-	}
+	TabulateWakes(dz);
+	const vector<double>& w = wtrans[currmode];
+	wake_ct[currmode].assign(nbins + 1, 0.0);
+	wake_st[currmode].assign(nbins + 1, 0.0);
 
-	for(size_t slice = 0; slice < nbins; slice++)
+	for(size_t i = 0; i < nbins; i++)
 	{
-		int i = slice;
-		wake_ct[currmode][i] = 0;
-		wake_st[currmode][i] = 0;
-
-		for(size_t j = slice; j < bunchSlices.size() - 1; j++)
+		double ct = 0;
+		double st = 0;
+		for(size_t j = i; j < bunchSlices.size() - 1; j++)
 		{
-			wake_ct[currmode][i] += w[j - i] * Cm[currmode][j];
-			wake_st[currmode][i] += w[j - i] * Sm[currmode][j];
+			ct += w[j - i] * Cm[currmode][j];
+			st += w[j - i] * Sm[currmode][j];
 		}
+		wake_ct[currmode][i] = ct;
+		wake_st[currmode][i] = st;
 	}
 }
 
 // This function calculates the longitudinal wake with modes
 void CollimatorWakeProcess::CalculateWakeL(double dz, int currmode)
 {
-	vector<double> w(nbins);
-	for(size_t slice = 0; slice < nbins; slice++)
-	{
-		w[slice] = collimator_wake->Wlong(slice * dz, currmode);
-	}
+	TabulateWakes(dz);
+	const vector<double>& w = wlong[currmode];
+	wake_cl[currmode].assign(nbins + 1, 0.0);
+	wake_sl[currmode].assign(nbins + 1, 0.0);
 
 	for(size_t i = 0; i < nbins; i++)
 	{
-		wake_cl[currmode][i] = 0;
-		wake_sl[currmode][i] = 0;
+		double cl = 0;
+		double sl = 0;
 		for(size_t j = i; j < bunchSlices.size() - 1; j++)
 		{
-			wake_cl[currmode][i] += w[j - i] * Cm[currmode][j];
-			wake_sl[currmode][i] += w[j - i] * Sm[currmode][j];
+			cl += w[j - i] * Cm[currmode][j];
+			sl += w[j - i] * Sm[currmode][j];
 		}
+		wake_cl[currmode][i] = cl;
+		wake_sl[currmode][i] = sl;
 	}
 }
 
 void CollimatorWakeProcess::ApplyWakefield(double ds) //  int nmodes)
 {
 	collimator_wake = (CollimatorWakePotentials *) currentWake;
+	if(recalc)
+	{
+		Init();
+	}
+
+	CalculateMoments();
 	for(int m = 1; m <= nmodes; m++)
 	{
-		for(size_t n = 0; n < nbins; n++)
-		{
-			Cm[m][n] = CalculateCm(m, n);
-			Sm[m][n] = CalculateSm(m, n);
-		}
+		CalculateWakeT(dz, m);
+		CalculateWakeL(dz, m);
 	}
 
-	double wake_x, wake_y, wake_z;
 	double macrocharge = currentBunch->GetTotalCharge() / currentBunch->size();
 	double a0 = macrocharge * ElectronCharge * Volt;
 	a0 /= 4 * pi * FreeSpacePermittivity;
 	double p0 = currentBunch->GetReferenceMomentum();
 
-	if(recalc)
+	// All modes are applied in one pass. For each particle the modes are applied in turn,
+	// with (c1, s1) = r^(m-1) (cos, sin)((m-1) theta) and (c, s) = r^m (cos, sin)(m theta).
+	for(size_t nslice = 0; nslice < nbins; nslice++)
 	{
-		Init();
-	}
-	double bload = 0;
-
-#define WAKE_GRADIENT(wake) ((wake[currmode][nslice + 1] - wake[currmode][nslice]) / dz)
-
-	for(int currmode = 1; currmode <= nmodes; currmode++)
-	{
-		CalculateWakeT(dz, currmode);
-		CalculateWakeL(dz, currmode);
-		double z = zmin;
-
-		for(size_t nslice = 0; nslice < nbins; nslice++)
+		for(ParticleBunch::iterator p = bunchSlices[nslice]; p != bunchSlices[nslice + 1]; p++)
 		{
-			double g_ct = WAKE_GRADIENT(wake_ct);
-			double g_st = WAKE_GRADIENT(wake_st);
-			double g_cl = WAKE_GRADIENT(wake_cl);
-			double g_sl = WAKE_GRADIENT(wake_sl);
-			g_ct = g_st = g_cl = g_sl = 0;
-
-			for(ParticleBunch::iterator p = bunchSlices[nslice]; p != bunchSlices[nslice + 1]; p++)
+			const double x = p->x();
+			const double y = p->y();
+			double c = 1;
+			double s = 0;
+			for(int m = 1; m <= nmodes; m++)
 			{
-				double r = sqrt(powd(p->x(), 2) + powd(p->y(), 2));
-				double theta = atan2(p->y(), p->x());
-				double zz = p->ct() - z;
-				double wxc = cos((currmode - 1) * theta) * (wake_ct[currmode][nslice] + g_ct * zz);
-				double wxs = sin((currmode - 1) * theta) * (wake_st[currmode][nslice] + g_st * zz);
-				double wys = cos((currmode - 1) * theta) * (wake_st[currmode][nslice] + g_st * zz);
-				double wyc = sin((currmode - 1) * theta) * (wake_ct[currmode][nslice] + g_ct * zz);
-				wake_x = currmode * powd(r, currmode - 1) * (wxc + wxs);
-				wake_y = currmode * powd(r, currmode - 1) * (wys - wyc);
-				wake_x *= a0;
-				wake_y *= a0;
-				double wzc = cos(currmode * theta) * (wake_cl[currmode][nslice] + g_cl * zz);
-				double wzs = sin(currmode * theta) * (wake_sl[currmode][nslice] + g_sl * zz);
-				wake_z = powd(r, currmode) * (wzc - wzs);
-				wake_z *= a0;
+				const double c1 = c;
+				const double s1 = s;
+				c = c1 * x - s1 * y;
+				s = c1 * y + s1 * x;
+
+				const double wct = wake_ct[m][nslice];
+				const double wst = wake_st[m][nslice];
+				double wake_x = m * (c1 * wct + s1 * wst) * a0;
+				double wake_y = m * (c1 * wst - s1 * wct) * a0;
+				double wake_z = (c * wake_cl[m][nslice] - s * wake_sl[m][nslice]) * a0;
+
 				double ddp = -wake_z / p0;
 				p->dp() += ddp;
-				bload += ddp;
 				double dxp = inc_tw ? wake_x / p0 : 0;
 				double dyp = inc_tw ? wake_y / p0 : 0;
 				p->xp() = (p->xp() + dxp) / (1 + ddp);
-				double oldpy = p->yp();
 				p->yp() = (p->yp() + dyp) / (1 + ddp);
 			}
-
-			z += dz;
 		}
 	}
 }
@@ -9,6 +9,7 @@
 #define _h_CollimatorWakeProcess
 
 #include "merlin_config.h"
+#include <vector>
 
 #include "WakeFieldProcess.h"
 
@@ -35,22 +36,40 @@ public:
 
 private:
 
-	double CalculateSm(int, int);
-	double CalculateCm(int, int);
+	/**
+	 * Calculates the moments Cm and Sm of all modes for each slice
+	 * in a single pass over the bunch
+	 */
+	void CalculateMoments();
+
+	/**
+	 * Tabulates the wake potentials of all modes on the slice grid.
+	 * The tables are kept while the version of the wake, dz and nbins are
+	 * unchanged. Potentials whose parameters are modified must call
+	 * WakePotentials::Changed() for the tables to be rebuilt.
+	 */
+	void TabulateWakes(double dz);
 
 	int nmodes;
 
-//    double Cm[5][1000];
-	double** Cm;
-//    double Sm[5][1000];
-	double** Sm;
-//	double wake_s;
-//	double wake_c;
-
-	double** wake_sl;
-	double** wake_cl;
-	double** wake_ct;
-	double** wake_st;
+	/**
+	 * Slice moments and wakes, indexed [mode][slice]
+	 */
+	std::vector<std::vector<double> > Cm;
+	std::vector<std::vector<double> > Sm;
+
+	std::vector<std::vector<double> > wake_sl;
+	std::vector<std::vector<double> > wake_cl;
+	std::vector<std::vector<double> > wake_ct;
+	std::vector<std::vector<double> > wake_st;
+
+	/**
+	 * Wake potentials indexed [mode][slice separation]
+	 */
+	std::vector<std::vector<double> > wtrans;
+	std::vector<std::vector<double> > wlong;
+	size_t tableVersion;
+	double tableDz;
 
 	CollimatorWakePotentials* collimator_wake;
 
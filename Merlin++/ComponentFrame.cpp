@@ -13,6 +13,7 @@ ComponentFrame::~ComponentFrame()
 
 void ComponentFrame::Invalidate() const
 {
+	LatticeFrame::Invalidate();
 }
 
 const string& ComponentFrame::GetType() const
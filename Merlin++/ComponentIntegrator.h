@@ -117,6 +117,15 @@ protected:
 	{
 	}
 
+	/**
+	 * Advance the integrated length by ds. Used by integrators
+	 * which override Track().
+	 */
+	void IncrIntegratedLength(double ds)
+	{
+		cur_S += ds;
+	}
+
 private:
 
 	double cur_S; /// current integrated length
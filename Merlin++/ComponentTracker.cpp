@@ -8,7 +8,6 @@
 #include "merlin_config.h"
 #include <cassert>
 #include <algorithm>
-#include <map>
 #include <limits>
 #include <iostream>
 #include "deleters.h"
@@ -34,32 +33,27 @@ public:
 
 ComponentTracker::IntegratorSet::~IntegratorSet()
 {
-	//	std::for_each(itsMap.begin(),itsMap.end(),map_deleter<IndexType,Integrator>());
 	for(IMap::iterator i = itsMap.begin(); i != itsMap.end(); i++)
 	{
-		delete (*i).second;
+		delete *i;
 	}
 }
 
 bool ComponentTracker::IntegratorSet::Add(ComponentIntegrator* intg)
 {
-	using namespace std;
-
-	pair<IMap::iterator, bool> rt = itsMap.insert(
-		IMap::value_type(intg->GetComponentIndex(), intg));
-
-	if(!rt.second)   // override
+	size_t n = intg->GetComponentIndex();
+	if(n >= itsMap.size())
 	{
-		delete (*rt.first).second;
-		(*rt.first).second = intg;
+		itsMap.resize(n + 1, nullptr);
 	}
-	return !rt.second;
-}
 
-ComponentIntegrator* ComponentTracker::IntegratorSet::GetIntegrator(int n)
-{
-	IMap::iterator i = itsMap.find(n);
-	return i == itsMap.end() ? nullptr : (*i).second;
+	bool replaced = itsMap[n] != nullptr;
+	if(replaced)    // override
+	{
+		delete itsMap[n];
+	}
+	itsMap[n] = intg;
+	return replaced;
 }
 
 void DefaultMarkerIntegrator::TrackStep(double ds)
@@ -11,7 +11,7 @@
 #include "merlin_config.h"
 #include "ComponentIntegrator.h"
 #include "AcceleratorComponent.h"
-#include <map>
+#include <vector>
 
 /**
  *   \class ComponentTracker
@@ -121,11 +121,15 @@ public:
 
 	/**
 	 * IntegratorSet class
+	 *
+	 * Integrators are held in a table indexed by component ID,
+	 * so selecting the integrator for a component is a single
+	 * array look-up.
 	 */
 	class IntegratorSet
 	{
 	public:
-		typedef std::map<int, ComponentIntegrator*> IMap;
+		typedef std::vector<ComponentIntegrator*> IMap;
 		~IntegratorSet();
 
 		/**
@@ -139,7 +143,10 @@ public:
 		 * Return integrator n (or a nullptr if there is
 		 * no associate integrator).
 		 */
-		ComponentIntegrator* GetIntegrator(int n);
+		ComponentIntegrator* GetIntegrator(int n)
+		{
+			return static_cast<size_t>(n) < itsMap.size() ? itsMap[n] : nullptr;
+		}
 
 	private:
 		IMap itsMap;
@@ -256,6 +263,36 @@ public:
 		_C* currentComponent;
 	};
 
+	/**
+	 * Wraps a concrete integrator so that a whole step is a single
+	 * virtual call. The entrance, step and exit maps of _I are
+	 * called directly, and can be inlined, rather than through
+	 * the ComponentIntegrator virtual functions.
+	 */
+	template<class _I>
+	class StaticIntegrator final: public _I
+	{
+	public:
+		double Track(double ds) override
+		{
+			if(this->AtEntrance())
+			{
+				this->_I::TrackEntrance();
+			}
+
+			this->_I::TrackStep(ds);
+			this->IncrIntegratedLength(ds);
+
+			if(this->AtExit())
+			{
+				this->_I::TrackExit();
+			}
+
+			this->currentBunch->IncrReferenceTime(ds);
+			return this->GetRemainingLength();
+		}
+	};
+
 	// Methods
 
 	/**
@@ -286,6 +323,27 @@ public:
 		virtual void Init(TBunchCMPTracker&) const = 0;
 	};
 
+	/**
+	 * Integrator set whose members are fixed at compile time by the
+	 * type list _I. Each integrator is registered as a
+	 * StaticIntegrator, so it tracks without the per-step virtual
+	 * calls of the dynamic sets. Further integrators can still be
+	 * registered on top, as with any other set.
+	 *
+	 * 	typedef ParticleComponentTracker::StaticISet<DriftCI, SectorBendCI> MyISet;
+	 * 	tracker->SetIntegratorSet(new MyISet());
+	 */
+	template<class ... _I>
+	class StaticISet: public ISetBase
+	{
+	public:
+		void Init(TBunchCMPTracker& ct) const
+		{
+			int dummy[] = {0, (ct.Register(new StaticIntegrator<_I>()), 0) ...};
+			(void) dummy;
+		}
+	};
+
 	/**
 	 * Default constructor (uses default integrator set)
 	 */
@@ -0,0 +1,359 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include "CondensedBeamline.h"
+#include "ParticleMapComponent.h"
+#include "ParticleBunch.h"
+#include "ParticleTracker.h"
+#include "TComponentFrame.h"
+#include "TransferMatrix.h"
+#include "Aperture.h"
+#include "MerlinException.h"
+
+using namespace std;
+
+namespace
+{
+
+// Margin on the aperture clearance bound, which is linear in the deviation and
+// only checked at the ends of each element
+const double clearanceSafety = 2;
+
+// Adds the aperture of inscribed size r, at a point where the deviation is R times
+// the deviation at the start of the section, to the clearance coefficients c
+void AddClearance(vector<double>& c, const RealMatrix& R, const PSvector& orbit, double r)
+{
+	double margin = r - fabs(orbit.x()) - fabs(orbit.y());
+	for(int j = 0; j < 6; j++)
+	{
+		double a = clearanceSafety * (fabs(R(0, j)) + fabs(R(2, j)));
+		c[j] = margin > 0 ? max(c[j], a / margin) : numeric_limits<double>::infinity();
+	}
+}
+
+// Puts the tracked fall-back particles back in place in particles, restoring their misc() from the
+// stored values, and closes up the places of those lost. index holds the places of the fall-back
+// particles in ascending order, and misc() of each tracked particle its place.
+void MergeFallback(PSvectorArray& particles, PSvectorArray& tracked, const vector<size_t>& index,
+	const vector<double>& misc)
+{
+	vector<bool> lost(particles.size(), false);
+	for(size_t k = 0; k < index.size(); k++)
+	{
+		lost[index[k]] = true;
+	}
+	for(PSvectorArray::iterator p = tracked.begin(); p != tracked.end(); p++)
+	{
+		size_t i = static_cast<size_t>((*p).misc());
+		(*p).misc() = misc[lower_bound(index.begin(), index.end(), i) - index.begin()];
+		particles[i] = *p;
+		lost[i] = false;
+	}
+
+	size_t n = 0;
+	for(size_t i = 0; i < particles.size(); i++)
+	{
+		if(!lost[i])
+		{
+			particles[n++] = particles[i];
+		}
+	}
+	particles.resize(n);
+}
+
+} // end anonymous namespace
+
+namespace ParticleTracking
+{
+
+CondensedMap::CondensedMap(AcceleratorModel* model, size_t n1, size_t n2, double len, const RdpMtrx& M,
+	const PSvector& in, const PSvector& out, const vector<double>& c) :
+	theModel(model), first(n1), last(n2), length(len), map(M), orbitIn(in), orbitOut(out),
+	maxX(numeric_limits<double>::infinity()), maxY(numeric_limits<double>::infinity()), clearance(c),
+	fallbackTracker(nullptr)
+{
+}
+
+void CondensedMap::SetValidityAmplitude(double ax, double ay)
+{
+	maxX = ax;
+	maxY = ay;
+}
+
+void CondensedMap::SetFallbackTracker(ParticleTracker* tracker)
+{
+	fallbackTracker = tracker;
+}
+
+bool CondensedMap::IsValid(const PSvector& u) const
+{
+	return fabs(u.x()) <= maxX && fabs(u.y()) <= maxY;
+}
+
+bool CondensedMap::IsClear(const PSvector& u) const
+{
+	double a = clearance[0] * fabs(u.x()) + clearance[1] * fabs(u.xp()) + clearance[2] * fabs(u.y())
+		+ clearance[3] * fabs(u.yp()) + clearance[4] * fabs(u.ct()) + clearance[5] * fabs(u.dp());
+	return a < 1;
+}
+
+ParticleBunch& CondensedMap::Apply(ParticleBunch& bunch) const
+{
+	//The particles that do not take the map keep their position in the bunch in misc() while they are tracked
+	PSvectorArray& particles = bunch.GetParticles();
+	PSvectorArray fallback;
+	vector<size_t> index;
+	vector<double> misc;
+
+	for(size_t i = 0; i < particles.size(); i++)
+	{
+		PSvector u = particles[i] - orbitIn;
+		if(IsValid(u) && IsClear(u))
+		{
+			map.Apply(u);
+			if(IsValid(u))
+			{
+				particles[i] = orbitOut + u;
+				continue;
+			}
+		}
+		index.push_back(i);
+		misc.push_back(particles[i].misc());
+		fallback.push_back(particles[i]);
+		fallback.back().misc() = i;
+	}
+
+	//The fall-back particles are tracked in the bunch itself, so that the processes see the caller's bunch type.
+	//The tracked particles are put back even if tracking throws (e.g. on excessive loss), so that the particles
+	//which took the map are not lost with them.
+	const double ct0 = bunch.GetReferenceTime();
+	if(!fallback.empty())
+	{
+		particles.swap(fallback);
+		try
+		{
+			if(fallbackTracker != nullptr)
+			{
+				fallbackTracker->SetBeamline(theModel->GetBeamline(first, last));
+				fallbackTracker->Continue(&bunch);
+			}
+			else
+			{
+				ParticleTracker tracker(theModel->GetBeamline(first, last));
+				tracker.Track(&bunch);
+			}
+		}
+		catch(...)
+		{
+			particles.swap(fallback);
+			MergeFallback(particles, fallback, index, misc);
+			bunch.SetReferenceTime(ct0 + length);
+			throw;
+		}
+		particles.swap(fallback);
+		MergeFallback(particles, fallback, index, misc);
+	}
+	bunch.SetReferenceTime(ct0 + length);
+	return bunch;
+}
+
+void CondensedMap::Invert()
+{
+	throw MerlinException("CondensedMap::Invert: a condensed section can not be inverted");
+}
+
+CondensedBeamline::CondensedBeamline(AcceleratorModel* model, double P0) :
+	theModel(model), p0(P0), orbit0(0), maxX(numeric_limits<double>::infinity()),
+	maxY(numeric_limits<double>::infinity()), fallbackTracker(nullptr)
+{
+}
+
+CondensedBeamline::~CondensedBeamline()
+{
+	Clear();
+}
+
+void CondensedBeamline::Clear()
+{
+	for(size_t n = 0; n < frames.size(); n++)
+	{
+		delete frames[n];
+		delete components[n];
+		delete maps[n];
+	}
+	frames.clear();
+	components.clear();
+	maps.clear();
+	lattice.clear();
+}
+
+void CondensedBeamline::Condense(size_t n1, size_t n2)
+{
+	if(n2 < n1)
+	{
+		throw MerlinException("CondensedBeamline::Condense: range ends before it starts");
+	}
+	ranges.push_back(make_pair(n1, n2));
+}
+
+void CondensedBeamline::SetOrbit(const PSvector& orbit)
+{
+	orbit0 = orbit;
+}
+
+void CondensedBeamline::SetValidityAmplitude(double ax, double ay)
+{
+	maxX = ax;
+	maxY = ay;
+}
+
+void CondensedBeamline::SetFallbackTracker(ParticleTracker* tracker)
+{
+	fallbackTracker = tracker;
+}
+
+PSvector CondensedBeamline::TrackOrbit(const PSvector& orbit, size_t n1, size_t n2)
+{
+	ParticleTracker tracker(theModel->GetBeamline(n1, n2), orbit, p0);
+	tracker.Run();
+	return tracker.GetTrackedBunch().GetParticles().front();
+}
+
+vector<double> CondensedBeamline::FindClearance(TransferMatrix& tm, PSvector orbit, size_t n1, size_t n2)
+{
+	//Bound |x| + |y| at both ends of each element with an aperture, relative to the margin between the orbit and
+	//the inscribed size of the aperture, as a linear function of the deviation at the start of the section
+	vector<double> c(6, 0.0);
+	AcceleratorModel::Beamline bl = theModel->GetBeamline(n1, n2);
+	RealMatrix R(IdentityMatrix(6));
+	size_t k = n1;
+	for(AcceleratorModel::BeamlineIterator f = bl.begin(); f != bl.end(); f++, k++)
+	{
+		const Aperture* ap = (*f)->GetComponent().GetAperture();
+		if(ap != nullptr)
+		{
+			AddClearance(c, R, orbit, ap->GetInscribedRadius());
+		}
+
+		RealMatrix M(6);
+		tm.FindTM(M, orbit, k, k);
+		R = M * R;
+		orbit = TrackOrbit(orbit, k, k);
+
+		if(ap != nullptr)
+		{
+			AddClearance(c, R, orbit, ap->GetInscribedRadius());
+		}
+	}
+	return c;
+}
+
+void CondensedBeamline::Build()
+{
+	Clear();
+	sort(ranges.begin(), ranges.end());
+
+	AcceleratorModel::Beamline bl = theModel->GetBeamline();
+	size_t nelm = bl.end() - bl.begin();
+	for(size_t r = 0; r < ranges.size(); r++)
+	{
+		if(ranges[r].second >= nelm || (r > 0 && ranges[r].first <= ranges[r - 1].second))
+		{
+			throw MerlinException("CondensedBeamline::Build: condensed ranges must lie within the lattice and not overlap");
+		}
+		for(size_t n = ranges[r].first; n <= ranges[r].second; n++)
+		{
+			if((*(bl.begin() + n))->GetComponent().GetWakePotentials() != nullptr)
+			{
+				throw MerlinException("CondensedBeamline::Build: condensed ranges must not contain wake potentials");
+			}
+		}
+	}
+
+	// The T matrix is the derivative of the transfer matrix with momentum, by central difference
+	const double ddp = 1.0e-4;
+	TransferMatrix tm(theModel, p0);
+
+	PSvector orbit = orbit0;
+	size_t next = 0;
+	AcceleratorModel::BeamlineIterator frame = bl.begin();
+	for(size_t r = 0; r < ranges.size(); r++)
+	{
+		size_t n1 = ranges[r].first;
+		size_t n2 = ranges[r].second;
+
+		if(n1 > next)
+		{
+			orbit = TrackOrbit(orbit, next, n1 - 1);
+		}
+		lattice.insert(lattice.end(), frame + next, frame + n1);
+
+		PSvector orbitIn = orbit;
+		RealMatrix R(6), Rp(6), Rm(6), T(6);
+		tm.FindTM(R, orbit, n1, n2);
+		PSvector op = orbit;
+		op.dp() += ddp;
+		tm.FindTM(Rp, op, n1, n2);
+		PSvector om = orbit;
+		om.dp() -= ddp;
+		tm.FindTM(Rm, om, n1, n2);
+		for(int i = 0; i < 6; i++)
+		{
+			for(int j = 0; j < 6; j++)
+			{
+				T(i, j) = (Rp(i, j) - Rm(i, j)) / (2 * ddp);
+			}
+		}
+		vector<double> clearance = FindClearance(tm, orbit, n1, n2);
+		orbit = TrackOrbit(orbit, n1, n2);
+
+		double length = 0;
+		for(size_t n = n1; n <= n2; n++)
+		{
+			length += (*(frame + n))->GetComponent().GetLength();
+		}
+
+		CondensedMap* cmap = new CondensedMap(theModel, n1, n2, length, RdpMtrx(R, T, p0), orbitIn, orbit,
+			clearance);
+		cmap->SetValidityAmplitude(maxX, maxY);
+		cmap->SetFallbackTracker(fallbackTracker);
+
+		AcceleratorComponent& start = (*(frame + n1))->GetComponent();
+		ostringstream id;
+		id << "CONDENSED_" << start.GetName();
+		ParticleMapComponent* pmc = new ParticleMapComponent(id.str(), cmap);
+		pmc->SetComponentLatticePosition(start.GetComponentLatticePosition());
+		ComponentFrame* cf = new TComponentFrame<ParticleMapComponent>(*pmc);
+
+		maps.push_back(cmap);
+		components.push_back(pmc);
+		frames.push_back(cf);
+		lattice.push_back(cf);
+
+		next = n2 + 1;
+	}
+	lattice.insert(lattice.end(), frame + next, bl.end());
+}
+
+AcceleratorModel::Beamline CondensedBeamline::GetBeamline()
+{
+	return AcceleratorModel::Beamline(lattice.begin(), lattice.end() - 1, 0, lattice.size() - 1);
+}
+
+AcceleratorModel::RingIterator CondensedBeamline::GetRing(int n)
+{
+	AcceleratorModel::BeamlineIterator i = lattice.begin();
+	advance(i, n);
+	return AcceleratorModel::RingIterator(lattice, i);
+}
+
+} // end namespace ParticleTracking
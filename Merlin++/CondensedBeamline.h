@@ -0,0 +1,203 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef CondensedBeamline_h
+#define CondensedBeamline_h 1
+
+#include "merlin_config.h"
+#include <vector>
+#include <utility>
+
+#include "AcceleratorModel.h"
+#include "ParticleMap.h"
+#include "MatrixMaps.h"
+#include "PSvector.h"
+#include "ParticleTracker.h"
+
+class TransferMatrix;
+
+namespace ParticleTracking
+{
+
+class ParticleMapComponent;
+
+/**
+ * Map for a condensed section of the lattice. Particles close to the reference
+ * orbit are transported by a second order map, (R + T dp) acting on the deviation
+ * from the orbit, where T is the derivative of the transfer matrix with momentum.
+ * This map is not symplectic: its determinant differs from one at second order in
+ * dp, so the validity amplitude should be kept small for long-term tracking.
+ *
+ * The map is only used for a particle which lies within the validity amplitude at
+ * both ends, and whose deviation, propagated by the linear part of the map with a
+ * safety factor of two, stays clear of the apertures at the ends of each element.
+ * Nonlinear elements can move a particle beyond this estimate, so the validity
+ * amplitude must be small enough for their effect to be within the safety factor.
+ * All other particles are tracked element by element through the original
+ * section, so any losses go through the normal aperture and loss processes of the
+ * fall-back tracker. The order of the surviving particles in the bunch is kept,
+ * also when the fall-back tracking throws.
+ *
+ * The map advances the reference time of the bunch by the length of the section.
+ * It is a thin element, so the distance integrated by the tracker (and seen by
+ * its processes) does not advance over the section.
+ */
+class CondensedMap: public ParticleMap
+{
+public:
+
+	/**
+	 * The particle at deviation u from the orbit at the start of the section is
+	 * clear of the apertures if the sum of clearance[i] * |u[i]| is below one.
+	 * len is the length of the section.
+	 */
+	CondensedMap(AcceleratorModel* model, size_t n1, size_t n2, double len, const RdpMtrx& M,
+		const PSvector& orbitIn, const PSvector& orbitOut, const std::vector<double>& clearance);
+
+	/**
+	 * Transport the bunch through the section.
+	 */
+	virtual ParticleBunch& Apply(ParticleBunch& bunch) const;
+
+	/**
+	 * Not supported: throws a MerlinException
+	 */
+	virtual void Invert();
+
+	/**
+	 * Particles whose deviation from the orbit is larger than ax, ay at either end
+	 * of the section are tracked element by element.
+	 */
+	void SetValidityAmplitude(double ax, double ay);
+
+	/**
+	 * Tracker for the particles that do not take the map, see
+	 * CondensedBeamline::SetFallbackTracker()
+	 */
+	void SetFallbackTracker(ParticleTracker* tracker);
+
+private:
+
+	bool IsValid(const PSvector& u) const;
+	bool IsClear(const PSvector& u) const;
+
+	AcceleratorModel* theModel;
+	size_t first;
+	size_t last;
+	double length;
+
+	RdpMtrx map;
+	PSvector orbitIn;
+	PSvector orbitOut;
+
+	double maxX;
+	double maxY;
+
+	std::vector<double> clearance;
+	ParticleTracker* fallbackTracker;
+};
+
+/**
+ * A copy of the beamline of an AcceleratorModel in which selected ranges of
+ * elements are replaced by precomputed maps. This is intended for long-term
+ * tracking, e.g. of a collimation halo, where most of the ring (the arcs) needs no
+ * element-by-element resolution.
+ *
+ * The maps are found about the orbit given to SetOrbit() (zero by default) with
+ * the TransferMatrix machinery. Each condensed section becomes a single thin
+ * ParticleMapComponent. Particles that could reach an aperture in the section
+ * are tracked through it element by element (see CondensedMap), but processes
+ * that act over the length of an element, such as synchrotron radiation, are not
+ * applied to the particles that take the map. Sections may not contain elements
+ * with wake potentials. Elements outside the condensed ranges are shared with the
+ * model.
+ *
+ * 	CondensedBeamline arcs(model, P0);
+ * 	arcs.Condense(n1, n2);
+ * 	arcs.Build();
+ * 	ParticleTracker tracker(arcs.GetRing(), bunch);
+ */
+class CondensedBeamline
+{
+public:
+
+	CondensedBeamline(AcceleratorModel* model, double P0);
+	~CondensedBeamline();
+
+	/**
+	 * Replace the elements n1 to n2 (inclusive) of the model lattice by a map.
+	 */
+	void Condense(size_t n1, size_t n2);
+
+	/**
+	 * Orbit at the start of the lattice about which the maps are found
+	 */
+	void SetOrbit(const PSvector& orbit);
+
+	/**
+	 * Validity amplitude applied to all maps, see CondensedMap
+	 */
+	void SetValidityAmplitude(double ax, double ay);
+
+	/**
+	 * Tracker for the particles that do not take the maps. It should be set up
+	 * like the tracker used for the condensed lattice, with the same integrator
+	 * set and processes (e.g. collimation), but must be a different object. Its
+	 * beamline is replaced on each use, and its processes only see the particles
+	 * that do not take the map, so a collimation loss threshold applies to those
+	 * alone. The processes are initialised on the first use with a bunch, and
+	 * keep their state (e.g. loss counts) over all the sections and turns
+	 * tracked with that bunch. Without one, a tracker with the default
+	 * integrator set and no processes is used.
+	 */
+	void SetFallbackTracker(ParticleTracker* tracker);
+
+	/**
+	 * Calculate the maps and build the condensed lattice. Must be called again
+	 * after the model or the condensed ranges are changed.
+	 */
+	void Build();
+
+	AcceleratorModel::Beamline GetBeamline();
+	AcceleratorModel::RingIterator GetRing(int n = 0);
+
+	/**
+	 * Number of elements in the condensed lattice
+	 */
+	size_t size() const
+	{
+		return lattice.size();
+	}
+
+private:
+
+	void Clear();
+	PSvector TrackOrbit(const PSvector& orbit, size_t n1, size_t n2);
+	std::vector<double> FindClearance(TransferMatrix& tm, PSvector orbit, size_t n1, size_t n2);
+
+	AcceleratorModel* theModel;
+	double p0;
+	PSvector orbit0;
+	double maxX;
+	double maxY;
+	ParticleTracker* fallbackTracker;
+
+	std::vector<std::pair<size_t, size_t> > ranges;
+
+	AcceleratorModel::FlatLattice lattice;
+	std::vector<ComponentFrame*> frames;
+	std::vector<ParticleMapComponent*> components;
+	std::vector<CondensedMap*> maps;
+
+	//Copy protection
+	CondensedBeamline(const CondensedBeamline& rhs);
+	CondensedBeamline& operator=(const CondensedBeamline& rhs);
+};
+
+} // end namespace ParticleTracking
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "DataTable.h"
 #include <iostream>
+#include <iterator>
 
 void DataTable::AddColumn(std::string col_name, char type)
 {
@@ -41,6 +42,7 @@ void DataTable::AddColumn(std::string col_name, char type)
 	}
 
 	col_names.push_back(col_name);
+	col_locations.push_back(location{type, position});
 	lookup[col_name].type = type;
 	lookup[col_name].pos = position;
 }
@@ -63,6 +65,58 @@ size_t DataTable::AddRow()
 	return length - 1;
 }
 
+size_t DataTable::AddRowWithStr(const std::vector<std::string>& values)
+{
+	if(values.size() != col_locations.size())
+	{
+		throw BadFormatException("Expected " + std::to_string(col_locations.size()) + " values, got "
+				  + std::to_string(values.size()));
+	}
+
+	const size_t row_n = AddRow();
+	for(size_t c = 0; c < values.size(); c++)
+	{
+		const location& l = col_locations[c];
+		switch(l.type)
+		{
+		case 'd':
+			data_d[l.pos][row_n] = stod(values[c]);
+			break;
+		case 'i':
+			data_i[l.pos][row_n] = stoi(values[c]);
+			break;
+		case 's':
+			data_s[l.pos][row_n] = values[c];
+			break;
+		}
+	}
+	return row_n;
+}
+
+void DataTable::AppendRows(DataTable&& other)
+{
+	if(other.col_names != col_names)
+	{
+		throw std::invalid_argument("Cannot append rows with different columns");
+	}
+
+	for(size_t c = 0; c < data_d.size(); c++)
+	{
+		data_d[c].insert(data_d[c].end(), other.data_d[c].begin(), other.data_d[c].end());
+	}
+	for(size_t c = 0; c < data_i.size(); c++)
+	{
+		data_i[c].insert(data_i[c].end(), other.data_i[c].begin(), other.data_i[c].end());
+	}
+	for(size_t c = 0; c < data_s.size(); c++)
+	{
+		data_s[c].insert(data_s[c].end(), std::make_move_iterator(other.data_s[c].begin()),
+			std::make_move_iterator(other.data_s[c].end()));
+	}
+	length += other.length;
+	other = DataTable();
+}
+
 void DataTable::AddRowFromRow(DataTableRow dt)
 {
 	//TODO
@@ -133,6 +187,36 @@ std::string DataTable::Get_s(const std::string col_name, size_t i) const
 	return data_s.at(l.pos).at(i);
 }
 
+const std::vector<double>& DataTable::Column_d(const std::string col_name) const
+{
+	location l = get_location(col_name);
+	if(l.type != 'd')
+	{
+		throw WrongTypeException("Column '" + col_name + "' is not a double");
+	}
+	return data_d[l.pos];
+}
+
+const std::vector<int>& DataTable::Column_i(const std::string col_name) const
+{
+	location l = get_location(col_name);
+	if(l.type != 'i')
+	{
+		throw WrongTypeException("Column '" + col_name + "' is not a int");
+	}
+	return data_i[l.pos];
+}
+
+const std::vector<std::string>& DataTable::Column_s(const std::string col_name) const
+{
+	location l = get_location(col_name);
+	if(l.type != 's')
+	{
+		throw WrongTypeException("Column '" + col_name + "' is not a string");
+	}
+	return data_s[l.pos];
+}
+
 void DataTable::Set(const std::string col_name, size_t i, double x)
 {
 	location l = get_location(col_name);
@@ -72,6 +72,7 @@ protected:
 
 	//indexing
 	std::vector<std::string> col_names;
+	std::vector<location> col_locations;
 	std::unordered_map<std::string, location> lookup;
 	size_t length;
 
@@ -98,6 +99,12 @@ public:
 	void AddColumn(std::string col_name, char type);
 	/// New empty row.
 	size_t AddRow();
+	/// New row with values converted from strings, one per column in the
+	/// order the columns were added.
+	size_t AddRowWithStr(const std::vector<std::string>& values);
+	/// Move the rows of other, which must have the same columns in the same
+	/// order, to the end of this table.
+	void AppendRows(DataTable&& other);
 
 	void AddRowFromRow(DataTableRow dt);
 
@@ -114,6 +121,14 @@ public:
 	///Get value by name and row converted to string.
 	std::string GetAsStr(const std::string col_name, size_t i) const;
 
+	// whole columns, looked up once for bulk access
+	///Get all values of a double column.
+	const std::vector<double>& Column_d(const std::string col_name) const;
+	///Get all values of an integer column.
+	const std::vector<int>& Column_i(const std::string col_name) const;
+	///Get all values of a string column.
+	const std::vector<std::string>& Column_s(const std::string col_name) const;
+
 	// overloaded
 	/// Set double value by name and row.
 	void Set(const std::string col_name, size_t i, double x);
@@ -8,11 +8,14 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include <iomanip>
+#include <cstdio>
+#include <algorithm>
 
 #include "DataTableTFS.h"
+#include "ParallelFor.h"
 
-DataTableReaderTFS::DataTableReaderTFS(std::string filename)
+DataTableReaderTFS::DataTableReaderTFS(std::string filename) :
+	nthreads(1)
 {
 	inf = std::make_shared<std::ifstream>(filename);
 	if(!inf->good())
@@ -44,42 +47,56 @@ static char type_conv(std::string s)
 	throw BadFormatException("Unknown data type'" + s + "'");
 }
 
-static const std::string whitespace = " \t\f\v\n\r";
+static bool is_whitespace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\n' || c == '\r';
+}
 
-static std::vector<std::string> split_line(std::string line)
+// Split line into words, on whitespace unless quoted. The strings of words
+// are reused from line to line.
+static void split_line(const std::string& line, std::vector<std::string>& words)
 {
-	// Read line into vector of strings
-	// split on whitespace unless quoted
-	std::vector<std::string> sl;
-	std::string current;
-	current.reserve(64);
+	size_t n = 0;
 	bool double_quote_on = false;
+	size_t i = 0;
+	const size_t len = line.size();
 
-	for(auto c : line)
+	while(i < len)
 	{
-		if(c == '"')
+		// skip to the start of a word
+		while(i < len && is_whitespace(line[i]))
+		{
+			i++;
+		}
+		if(i == len)
+		{
+			break;
+		}
+
+		if(n == words.size())
 		{
-			double_quote_on = !double_quote_on;
+			words.emplace_back();
 		}
-		else if(!double_quote_on && whitespace.find(c) != std::string::npos)
+		std::string& current = words[n];
+		current.clear();
+		for(; i < len && (double_quote_on || !is_whitespace(line[i])); i++)
 		{
-			if(current.length())
+			if(line[i] == '"')
 			{
-				sl.push_back(current);
-				current = "";
+				double_quote_on = !double_quote_on;
+			}
+			else
+			{
+				current += line[i];
 			}
 		}
-		else
+		// a word of just quotes is empty, and is dropped
+		if(current.length())
 		{
-			current += c;
+			n++;
 		}
 	}
-	if(current.length())
-	{
-		sl.push_back(current);
-	}
-
-	return sl;
+	words.resize(n);
 }
 
 DataTable DataTableReaderTFS::Read()
@@ -96,7 +113,7 @@ DataTable DataTableReaderTFS::Read()
 	while(getline(*in, line))
 	{
 		line_number++;
-		words = split_line(line);
+		split_line(line, words);
 		if(words.size() == 0)
 		{
 			continue;
@@ -127,7 +144,7 @@ DataTable DataTableReaderTFS::Read()
 	//Read column types
 	getline(*in, line);
 	line_number++;
-	words = split_line(line);
+	split_line(line, words);
 	if(words[0] != "$")
 	{
 		throw BadFormatException("Expected line starting with '$' at line " + std::to_string(line_number));
@@ -153,32 +170,49 @@ DataTable DataTableReaderTFS::Read()
 		}
 	}
 
-	// Read body
+	// Read body. The lines are split and converted in blocks, one block per
+	// thread, and the blocks appended to the table in order.
+	std::vector<std::string> lines;
 	while(getline(*in, line))
 	{
-		line_number++;
-		words = split_line(line);
-		if(words.size() == 0)
-		{
-			continue;
-		}
+		lines.push_back(line);
+	}
+	const size_t first_line = line_number + 1;
+
+	const size_t min_block = 1024;
+	const size_t nt = std::max<size_t>(1, std::min(ParallelThreads(nthreads), lines.size() / min_block));
 
-		if(words.size() != col_types.size())
+	std::vector<DataTable> blocks(nt);
+	ParallelFor(nt, nt, [&](size_t b)
+	{
+		DataTable& block = blocks[b];
+		for(size_t c = 0; c < col_names.size(); c++)
 		{
-			throw BadFormatException("Row does not contain correct number of values at line "
-					  + std::to_string(line_number));
+			block.AddColumn(col_names[c], col_types[c]);
 		}
-		size_t rown = dt.AddRow();
+
+		std::vector<std::string> row_words;
+		const size_t l1 = (b + 1) * lines.size() / nt;
+		for(size_t l = b * lines.size() / nt; l < l1; l++)
 		{
-			auto name = col_names.begin();
-			auto word = words.begin();
-			while(name != col_names.end())
+			split_line(lines[l], row_words);
+			if(row_words.size() == 0)
 			{
-				dt.SetWithStr(*name, rown, *word);
-				++name;
-				++word;
+				continue;
 			}
+
+			if(row_words.size() != col_types.size())
+			{
+				throw BadFormatException("Row does not contain correct number of values at line "
+						  + std::to_string(first_line + l));
+			}
+			block.AddRowWithStr(row_words);
 		}
+	});
+
+	for(size_t b = 0; b < nt; b++)
+	{
+		dt.AppendRows(std::move(blocks[b]));
 	}
 
 	return dt;
@@ -196,82 +230,169 @@ DataTableWriterTFS::DataTableWriterTFS(std::string filename) :
 	out = outf.get();
 }
 
+// Append x formatted as by an ostream with precision prec, left aligned to width
+static void append_d(std::string& buf, double x, int width, int prec)
+{
+	const size_t n = buf.size();
+	buf.resize(n + 64);
+	int len = snprintf(&buf[n], 64, "%-*.*g", width, prec, x);
+	if(len >= 64)
+	{
+		buf.resize(n + len + 1);
+		snprintf(&buf[n], len + 1, "%-*.*g", width, prec, x);
+	}
+	buf.resize(n + len);
+}
+
+static void append_i(std::string& buf, int x, int width)
+{
+	const size_t n = buf.size();
+	buf.resize(n + 64);
+	int len = snprintf(&buf[n], 64, "%-*d", width, x);
+	if(len >= 64)
+	{
+		buf.resize(n + len + 1);
+		snprintf(&buf[n], len + 1, "%-*d", width, x);
+	}
+	buf.resize(n + len);
+}
+
+static void append_s(std::string& buf, const std::string& x, size_t width)
+{
+	buf += x;
+	if(x.size() < width)
+	{
+		buf.append(width - x.size(), ' ');
+	}
+}
+
+namespace
+{
+// A column of the table being written, resolved once
+struct TFSColumn
+{
+	char type;
+	const std::vector<double>* d;
+	const std::vector<int>* i;
+	const std::vector<std::string>* s;
+};
+}
+
 void DataTableWriterTFS::Write(DataTable & dt)
 {
-	std::ios init(NULL);
-	init.copyfmt(*out);
-	*out << std::setprecision(prec_float);
+	std::string buf;
 
 	for(auto &header_name : dt.HeaderNames())
 	{
-		*out << "@ " << std::setw(16) << std::left << header_name << " ";
+		buf += "@ ";
+		append_s(buf, header_name, 16);
+		buf += " ";
 		char head_type = dt.GetHeaderType(header_name);
 		switch(head_type)
 		{
 		case 'd':
-			*out << "%le ";
-			*out << std::setw(width_float) << dt.HeaderGet_d(header_name) << std::endl;
+			buf += "%le ";
+			append_d(buf, dt.HeaderGet_d(header_name), width_float, prec_float);
 			break;
 		case 'i':
-			*out << "%d ";
-			*out << std::setw(width_int) << dt.HeaderGet_i(header_name) << std::endl;
+			buf += "%d ";
+			append_i(buf, dt.HeaderGet_i(header_name), width_int);
 			break;
 		case 's':
-			*out << "%" << dt.HeaderGet_s(header_name).size() << "s ";
-			*out << '"' << dt.HeaderGet_s(header_name) << '"' << std::endl;
+			buf += "%" + std::to_string(dt.HeaderGet_s(header_name).size()) + "s ";
+			buf += '"' + dt.HeaderGet_s(header_name) + '"';
 			break;
 		}
+		buf += '\n';
 	}
 
-	*out << "* " << std::left;
+	std::vector<TFSColumn> cols;
+	buf += "* ";
 	for(auto &col_name : dt.ColumnNames())
 	{
-		*out << col_name << " ";
+		buf += col_name + " ";
+		TFSColumn c = {dt.GetColumnType(col_name), nullptr, nullptr, nullptr};
+		switch(c.type)
+		{
+		case 'd':
+			c.d = &dt.Column_d(col_name);
+			break;
+		case 'i':
+			c.i = &dt.Column_i(col_name);
+			break;
+		case 's':
+			c.s = &dt.Column_s(col_name);
+			break;
+		}
+		cols.push_back(c);
 	}
-	*out << std::endl;
+	buf += '\n';
 
-	*out << "$ ";
-	for(auto &col_name : dt.ColumnNames())
+	buf += "$ ";
+	for(auto &c : cols)
 	{
-		char col_type = dt.GetColumnType(col_name);
-		switch(col_type)
+		switch(c.type)
 		{
 		case 'd':
-			*out << "%le ";
+			buf += "%le ";
 			break;
 		case 'i':
-			*out << "%d ";
+			buf += "%d ";
 			break;
 		case 's':
-			*out << "%s ";
+			buf += "%s ";
 			break;
-
 		}
 	}
-	*out << std::endl;
+	buf += '\n';
+	out->write(buf.data(), buf.size());
 
-	auto col_names = dt.ColumnNames();
-	for(auto drow : dt)
+	auto format_rows = [this, &cols](size_t r0, size_t r1, std::string& b)
 	{
-		for(auto &col_name : col_names)
+		b.clear();
+		for(size_t r = r0; r < r1; r++)
 		{
-			char col_type = dt.GetColumnType(col_name);
-			*out << " ";
-			switch(col_type)
+			for(auto &c : cols)
 			{
-			case 'd':
-				*out << std::setw(width_float) << drow.Get_d(col_name);
-				break;
-			case 'i':
-				*out << std::setw(width_int) << drow.Get_i(col_name);
-				break;
-			case 's':
-				*out << '"' << drow.Get_s(col_name) << '"';
-				break;
+				b += ' ';
+				switch(c.type)
+				{
+				case 'd':
+					append_d(b, (*c.d)[r], width_float, prec_float);
+					break;
+				case 'i':
+					append_i(b, (*c.i)[r], width_int);
+					break;
+				case 's':
+					b += '"';
+					b += (*c.s)[r];
+					b += '"';
+					break;
+				}
 			}
+			b += '\n';
 		}
-		*out << std::endl;
-	}
+	};
 
-	out->copyfmt(init);
+	// Rows are formatted in chunks, one chunk per thread at a time, and
+	// the chunks written in order
+	const size_t chunk = 4096;
+	const size_t nt = ParallelThreads(nthreads);
+	std::vector<std::string> bufs(nt);
+	bufs[0].swap(buf);
+	const size_t nrows = dt.Length();
+	for(size_t r0 = 0; r0 < nrows; r0 += nt * chunk)
+	{
+		const size_t nchunks = std::min(nt, (nrows - r0 + chunk - 1) / chunk);
+		ParallelFor(nchunks, nt, [&](size_t t)
+		{
+			size_t r1 = r0 + t * chunk;
+			format_rows(r1, std::min(r1 + chunk, nrows), bufs[t]);
+		});
+		for(size_t t = 0; t < nchunks; t++)
+		{
+			out->write(bufs[t].data(), bufs[t].size());
+		}
+	}
+	out->flush();
 }
@@ -17,14 +17,15 @@
 
 /** @brief Read a DataTable from a TFS file
  *
- * For example to read file generated with MadX
+ * For example to read file generated with MadX. Large tables can be
+ * split and converted by several threads with SetThreads().
  */
 class DataTableReaderTFS: public DataTableReader
 {
 public:
 	/// Read from an istream, e.g. an already opened file
 	DataTableReaderTFS(std::istream *in) :
-		in(in)
+		in(in), nthreads(1)
 	{
 	}
 	/// Open a file to read
@@ -33,12 +34,25 @@ public:
 	/// Read the file, returning a new DataTable
 	virtual DataTable Read() override;
 
+	/// Number of threads converting the rows, 0 for one per hardware thread
+	void SetThreads(size_t n)
+	{
+		nthreads = n;
+	}
+
 private:
 	std::istream *in; // either a passed pointer, or pointer to the opened file
+	size_t nthreads;
 	std::shared_ptr<std::istream> inf; // if we opened the file, this ensures that it is closed
 };
 
 /** @brief Write a DataTable to a TFS file
+ *
+ * Rows are formatted with snprintf into a buffer, using column handles
+ * looked up once per table, and the buffer is written to the stream in
+ * one go. Numbers are left aligned with the widths and precision below,
+ * whatever the format flags of the stream. Large tables can be
+ * formatted by several threads with SetThreads().
  */
 class DataTableWriterTFS: public DataTableWriter
 {
@@ -54,14 +68,21 @@ public:
 
 	/// Write the DataTable to the file or stream
 	void Write(DataTable& dt);
+
+	/// Number of threads formatting the rows, 0 for one per hardware thread
+	void SetThreads(size_t n)
+	{
+		nthreads = n;
+	}
 private:
 	DataTableWriterTFS() :
-		width_int(8), width_float(18), prec_float(10)
+		width_int(8), width_float(18), prec_float(10), nthreads(1)
 	{
 	}
 	int width_int;
 	int width_float;
 	int prec_float;
+	size_t nthreads;
 
 	std::ostream *out;
 	std::shared_ptr<std::ostream> outf;
@@ -259,12 +259,6 @@ double ppDiffractiveScatter::SelectXi()
 std::pair<double, double> ppDiffractiveScatter::Select()
 {
 	double xx, tt;
-	static bool kilroy = false;
-	if(kilroy)
-	{
-		std::cout << "open file" << std::endl;
-		kilroy = false;
-	}
 
 	retry:
 
@@ -306,7 +300,6 @@ std::pair<double, double> ppDiffractiveScatter::Select()
 
 	double ds2 = SigDiffractive / (N * N * deltax * (xi_max - xi_min) * deltat * (t_max - t_min));
 
-	static double fudge = 1;
 	double rat = fudge * ds / ds2;
 
 	if(rat > 1)
@@ -31,7 +31,7 @@ public:
 	 * class constructor
 	 */
 	ppDiffractiveScatter() :
-		Configured(false), Debug(false)
+		Configured(false), Debug(false), fudge(1)
 	{
 	}
 	~ppDiffractiveScatter();
@@ -214,6 +214,11 @@ private:
 //s of the interaction
 	double ss;
 
+	/**
+	 * Scale of the rejection test in Select(), lowered whenever a sample exceeds it
+	 */
+	double fudge;
+
 }; //End class ppDiffractiveScatter
 
 } //End namespace ParticleTracking
@@ -0,0 +1,378 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "DispersionFreeSteering.h"
+#include "AcceleratorModel.h"
+#include "ParallelFor.h"
+#include "RandomNG.h"
+#include "TLASimp.h"
+#include "MerlinException.h"
+
+using namespace std;
+
+namespace
+{
+
+// The buffer and readings of the state tracked by this thread
+thread_local const BPM::Buffer* sinkOwner = nullptr;
+thread_local RealVector* sinkData = nullptr;
+
+} // end anonymous namespace
+
+void DispersionFreeSteering::ReadingBuffer::Record(const BPM& aBPM, const BPM::Data& data)
+{
+	if(sinkOwner != this)
+	{
+		return;
+	}
+	map<const BPM*, size_t>::const_iterator r = rows.find(&aBPM);
+	if(r != rows.end())
+	{
+		(*sinkData)[r->second] = plane == ps_X ? data.x.value : data.y.value;
+	}
+}
+
+DispersionFreeSteering::DispersionFreeSteering(AcceleratorModel* m, const std::vector<BPM*>& b, int plane,
+	RWChannelArray& c, size_t n) :
+	model(m), bpms(b), correctors(c), nthreads(n), buffer(plane), w_abs(1), w_diff(1), threshold(1.0e-06), svd(nullptr)
+{
+	for(size_t i = 0; i < bpms.size(); i++)
+	{
+		buffer.rows[bpms[i]] = i;
+		bpms[i]->AddBuffer(&buffer);
+	}
+}
+
+DispersionFreeSteering::~DispersionFreeSteering()
+{
+	for(size_t i = 0; i < bpms.size(); i++)
+	{
+		bpms[i]->RemoveBuffer(&buffer);
+	}
+	for(size_t n = 0; n < states.size(); n++)
+	{
+		delete states[n];
+	}
+	delete svd;
+}
+
+void DispersionFreeSteering::AddEnergyState(EnergyState* state)
+{
+	states.push_back(state);
+}
+
+void DispersionFreeSteering::SetWeights(double wa, double wd)
+{
+	w_abs = wa;
+	w_diff = wd;
+}
+
+const RealVector& DispersionFreeSteering::RecordTrajectories()
+{
+	const size_t ns = states.size();
+	const size_t nb = bpms.size();
+	if(ns == 0)
+	{
+		throw MerlinException("DispersionFreeSteering::RecordTrajectories: no energy states");
+	}
+
+	vector<RealVector> data(ns, RealVector(0.0, nb));
+
+	// The support transformations are updated without synchronisation on first use, so the frame caches
+	// are filled here before the states share the model
+	model->UpdateFrameCaches();
+
+	// Each state draws from its own stream, so that the BPM noise does not depend on the threads. The draw from
+	// the caller's generator makes each recording differ.
+	const uint32_t draw = static_cast<uint32_t>(RandomNG::uniform(0, 4294967295.0));
+	const vector<uint32_t> seed = RandomNG::streamSeed(RandomNG::getSeed(), draw);
+
+	// By default each state has its own thread, unless this is already running in a parallel loop
+	size_t nt = nthreads != 0 ? nthreads : (InParallelLoop() ? 1 : ns);
+	ParallelFor(ns, nt, [&](size_t s)
+		{
+			RandomNG::ScopedSeed stream(RandomNG::streamSeed(seed, s));
+
+			// Only the nominal state reaches the other buffers, so they are never called from several threads
+			BPM::BufferManager::Exclusive only(s == 0 ? nullptr : &buffer);
+
+			sinkOwner = &buffer;
+			sinkData = &data[s];
+			try
+			{
+				states[s]->Track();
+			}
+			catch(...)
+			{
+				sinkOwner = nullptr;
+				sinkData = nullptr;
+				throw;
+			}
+			sinkOwner = nullptr;
+			sinkData = nullptr;
+		});
+
+	readings.redim(ns * nb);
+	for(size_t s = 0; s < ns; s++)
+	{
+		for(size_t b = 0; b < nb; b++)
+		{
+			readings[s * nb + b] = data[s][b];
+		}
+	}
+	return readings;
+}
+
+void DispersionFreeSteering::Deviation(RealVector& d) const
+{
+	const size_t nb = bpms.size();
+	d.redim(readings.size());
+	for(size_t b = 0; b < nb; b++)
+	{
+		d[b] = readings[b] - reference[b];
+	}
+	for(size_t r = nb; r < readings.size(); r++)
+	{
+		d[r] = (readings[r] - readings[r % nb]) - reference[r];
+	}
+}
+
+void DispersionFreeSteering::CalculateResponse(double eps)
+{
+	const size_t nb = bpms.size();
+	RecordTrajectories();
+
+	// off-energy states are referred to the nominal orbit
+	reference.redim(readings.size());
+	reference = readings;
+	for(size_t r = nb; r < reference.size(); r++)
+	{
+		reference[r] -= readings[r % nb];
+	}
+
+	response.redim(readings.size(), correctors.Size());
+	RealVector d;
+	for(size_t c = 0; c < correctors.Size(); c++)
+	{
+		double v = correctors.Read(c);
+		correctors.Write(c, v + eps);
+		RecordTrajectories();
+		correctors.Write(c, v);
+		Deviation(d);
+		for(size_t r = 0; r < d.size(); r++)
+		{
+			response(r, c) = d[r] / eps;
+		}
+	}
+	Factorise();
+}
+
+void DispersionFreeSteering::SetResponse(const DispersionFreeSteering& design)
+{
+	if(design.states.size() != states.size() || design.bpms.size() != bpms.size()
+		|| design.correctors.Size() != correctors.Size())
+	{
+		throw MerlinException("DispersionFreeSteering::SetResponse: design has different states, BPMs or correctors");
+	}
+	if(design.svd == nullptr)
+	{
+		throw MerlinException("DispersionFreeSteering::SetResponse: design has no response");
+	}
+
+	reference.copy(design.reference);
+	response.copy(design.response);
+	qr.copy(design.qr);
+	rdiag.copy(design.rdiag);
+	beta.copy(design.beta);
+	colOrder = design.colOrder;
+	rowEnd = design.rowEnd;
+	delete svd;
+	svd = new TLAS::SVDMatrix<double>(*design.svd);
+}
+
+void DispersionFreeSteering::Factorise()
+{
+	const size_t nb = bpms.size();
+	const size_t m = response.nrows();
+	const size_t n = response.ncols();
+	const size_t mq = max(m, n);
+
+	// Row r of the response is placed at row mq - 1 - (bpm * nstates + state),
+	// so that each column is non-zero only from the top down to the row of the
+	// first BPM after its corrector. The columns are taken in order of that
+	// extent, which the reflections then never exceed.
+	const size_t ns = m / nb;
+	vector<size_t> rowOf(m);
+	for(size_t r = 0; r < m; r++)
+	{
+		rowOf[r] = mq - 1 - ((r % nb) * ns + r / nb);
+	}
+
+	vector<size_t> extent(n, 0);
+	for(size_t c = 0; c < n; c++)
+	{
+		for(size_t r = 0; r < m; r++)
+		{
+			if(response(r, c) != 0)
+			{
+				extent[c] = max(extent[c], rowOf[r] + 1);
+			}
+		}
+	}
+	colOrder.resize(n);
+	iota(colOrder.begin(), colOrder.end(), 0);
+	stable_sort(colOrder.begin(), colOrder.end(), [&extent](size_t a, size_t b)
+	{
+		return extent[a] < extent[b];
+	});
+
+	qr.redim(mq, n);
+	for(size_t r = 0; r < m; r++)
+	{
+		const double w = r < nb ? w_abs : w_diff;
+		for(size_t k = 0; k < n; k++)
+		{
+			qr(rowOf[r], k) = w * response(r, colOrder[k]);
+		}
+	}
+
+	rdiag.redim(n);
+	beta.redim(n);
+	rowEnd.resize(n);
+	for(size_t k = 0; k < n; k++)
+	{
+		const size_t hi = min(mq, max(max(extent[colOrder[k]], k + 1), k ? rowEnd[k - 1] : 0));
+		rowEnd[k] = hi;
+
+		double alpha = 0;
+		for(size_t i = k; i < hi; i++)
+		{
+			alpha += qr(i, k) * qr(i, k);
+		}
+		alpha = sqrt(alpha);
+		if(alpha == 0)
+		{
+			rdiag[k] = 0;
+			beta[k] = 0;
+			continue;
+		}
+		if(qr(k, k) > 0)
+		{
+			alpha = -alpha;
+		}
+		// v = x - alpha e_k, stored in place of x
+		qr(k, k) -= alpha;
+		rdiag[k] = alpha;
+		beta[k] = -1.0 / (alpha * qr(k, k));
+
+		for(size_t j = k + 1; j < n; j++)
+		{
+			double s = 0;
+			for(size_t i = k; i < hi; i++)
+			{
+				s += qr(i, k) * qr(i, j);
+			}
+			s *= beta[k];
+			for(size_t i = k; i < hi; i++)
+			{
+				qr(i, j) -= s * qr(i, k);
+			}
+		}
+	}
+
+	RealMatrix R(n, n, 0.0);
+	for(size_t k = 0; k < n; k++)
+	{
+		R(k, k) = rdiag[k];
+		for(size_t j = k + 1; j < n; j++)
+		{
+			R(k, j) = qr(k, j);
+		}
+	}
+	delete svd;
+	svd = new TLAS::SVDMatrix<double>(R, threshold);
+}
+
+void DispersionFreeSteering::Solve(const RealVector& d, RealVector& x) const
+{
+	const size_t nb = bpms.size();
+	const size_t m = d.size();
+	const size_t n = qr.ncols();
+	const size_t mq = qr.nrows();
+	const size_t ns = m / nb;
+
+	RealVector y(0.0, mq);
+	for(size_t r = 0; r < m; r++)
+	{
+		y[mq - 1 - ((r % nb) * ns + r / nb)] = (r < nb ? w_abs : w_diff) * d[r];
+	}
+
+	for(size_t k = 0; k < n; k++)
+	{
+		if(beta[k] == 0)
+		{
+			continue;
+		}
+		double s = 0;
+		for(size_t i = k; i < rowEnd[k]; i++)
+		{
+			s += qr(i, k) * y[i];
+		}
+		s *= beta[k];
+		for(size_t i = k; i < rowEnd[k]; i++)
+		{
+			y[i] -= s * qr(i, k);
+		}
+	}
+
+	RealVector c(n);
+	for(size_t k = 0; k < n; k++)
+	{
+		c[k] = y[k];
+	}
+	RealVector z = (*svd)(c);
+	x.redim(n);
+	for(size_t k = 0; k < n; k++)
+	{
+		x[colOrder[k]] = z[k];
+	}
+}
+
+const RealVector& DispersionFreeSteering::CalculateCorrection()
+{
+	if(svd == nullptr)
+	{
+		throw MerlinException("DispersionFreeSteering::CalculateCorrection: no response");
+	}
+	RecordTrajectories();
+	Deviation(deviation);
+	Solve(deviation, correction);
+	return correction;
+}
+
+void DispersionFreeSteering::ApplyCorrection(double g)
+{
+	RealVector x(correction);
+	x *= -g;
+	correctors.IncrementAll(x);
+}
+
+double DispersionFreeSteering::GetRMSDeviation() const
+{
+	const size_t nb = bpms.size();
+	double sum = 0;
+	for(size_t r = 0; r < deviation.size(); r++)
+	{
+		const double w = r < nb ? w_abs : w_diff;
+		sum += w * w * deviation[r] * deviation[r];
+	}
+	return deviation.size() ? sqrt(sum / deviation.size()) : 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef DispersionFreeSteering_h
+#define DispersionFreeSteering_h 1
+
+#include "merlin_config.h"
+#include <map>
+#include <vector>
+
+#include "BPM.h"
+#include "PSvector.h"
+#include "Channels.h"
+#include "LinearAlgebra.h"
+#include "TLAS.h"
+
+class AcceleratorModel;
+
+/**
+ *	Dispersion free steering (DFS) of a beamline segment, in one plane.
+ *
+ *	The beam is measured in several energy states. State 0 is the
+ *	nominal beam, whose orbit is corrected towards the reference
+ *	orbit with weight w_abs. For the other states the difference of
+ *	their orbit from the nominal one (the dispersion) is corrected
+ *	towards the reference difference with weight w_diff.
+ *
+ *	The energy states are tracked concurrently, one thread each. The
+ *	alignment caches of the model (AcceleratorModel::UpdateFrameCaches())
+ *	are brought up to date first, as they are not filled safely by
+ *	several threads. The BPM readings of each state are collected by a
+ *	buffer attached to the BPMs, which records into the readings of the
+ *	state tracked by the calling thread. Any other buffers attached to
+ *	the BPMs receive the readings of the nominal state only. Since the
+ *	states share the model, an EnergyState must set its energy through
+ *	its own beam (for example the momentum of the initial bunch) and not
+ *	by changing the model.
+ *
+ *	Each state is tracked with RandomNG seeded from the caller's seed,
+ *	a number drawn from the caller's generator and the state index, so
+ *	the readings (with BPM noise) are reproducible and do not depend on
+ *	the number of threads.
+ *
+ *	The response matrix is found by tracking all the states for each
+ *	corrector step. It is factorised once: a Householder QR that skips
+ *	the zero responses of BPMs upstream of a corrector, so that the
+ *	work follows the (triangular) band of a linac response matrix,
+ *	followed by an SVD of the square triangular factor. Each
+ *	correction is then only a triangular back substitution.
+ *
+ *	The response and reference orbits of a design machine can be
+ *	shared with the models of many seeds through SetResponse().
+ *
+ * 	DispersionFreeSteering dfs(model, bpms, ps_Y, ycors);
+ * 	dfs.AddEnergyState(new MyState(model, p0));
+ * 	dfs.AddEnergyState(new MyState(model, 0.8 * p0));
+ * 	dfs.CalculateResponse();
+ * 	for each iteration: dfs.CalculateCorrection(); dfs.ApplyCorrection(0.8);
+ */
+class DispersionFreeSteering
+{
+public:
+
+	/**
+	 *	A beam energy state.
+	 */
+	class EnergyState
+	{
+	public:
+		virtual ~EnergyState()
+		{
+		}
+
+		/**
+		 *	Track the beam of this state through the segment. Called
+		 *	from a worker thread, with RandomNG seeded for this state.
+		 */
+		virtual void Track() = 0;
+	};
+
+	/**
+	 *	DFS of model with the readings of bpms in plane (ps_X or
+	 *	ps_Y), and the correctors. The model, the BPMs and the corrector
+	 *	channels must stay valid for the lifetime of this object. With nthreads = 0 each
+	 *	off-energy state has its own thread, except within another
+	 *	parallel loop (see ParallelThreads()), where they are tracked
+	 *	on the calling thread.
+	 */
+	DispersionFreeSteering(AcceleratorModel* model, const std::vector<BPM*>& bpms, int plane,
+		RWChannelArray& correctors, size_t nthreads = 0);
+	~DispersionFreeSteering();
+
+	/**
+	 *	Add an energy state, the first being the nominal beam. Takes
+	 *	ownership of state.
+	 */
+	void AddEnergyState(EnergyState* state);
+
+	/**
+	 *	Weights of the absolute orbit and of the difference orbits
+	 */
+	void SetWeights(double w_abs, double w_diff);
+
+	/**
+	 *	Relative threshold below which singular values are ignored
+	 */
+	void SetThreshold(double t)
+	{
+		threshold = t;
+	}
+
+	/**
+	 *	Track all the states, and return their BPM readings (state
+	 *	by state, nbpms each). Draws one number from the caller's
+	 *	generator.
+	 */
+	const RealVector& RecordTrajectories();
+
+	/**
+	 *	Take the current orbits as the reference and find the response
+	 *	to corrector steps of eps.
+	 */
+	void CalculateResponse(double eps = 1.0e-06);
+
+	/**
+	 *	Use the response and reference orbits of design, which must
+	 *	have the same numbers of states, BPMs and correctors.
+	 */
+	void SetResponse(const DispersionFreeSteering& design);
+
+	/**
+	 *	DFS response matrix, one row per state and BPM (the state 0
+	 *	rows are the orbit response, the others the difference
+	 *	response), without weights.
+	 */
+	const RealMatrix& GetResponseMatrix() const
+	{
+		return response;
+	}
+
+	/**
+	 *	Track all the states and find the corrector changes which
+	 *	would remove the measured deviation.
+	 */
+	const RealVector& CalculateCorrection();
+
+	/**
+	 *	Subtract g times the last correction from the correctors.
+	 */
+	void ApplyCorrection(double g = 1.0);
+
+	/**
+	 *	Deviation from the reference orbits found by the last
+	 *	CalculateCorrection(), in the order of the response rows
+	 */
+	const RealVector& GetDeviation() const
+	{
+		return deviation;
+	}
+
+	/**
+	 *	Weighted rms of the last deviation
+	 */
+	double GetRMSDeviation() const;
+
+	size_t GetNumberOfStates() const
+	{
+		return states.size();
+	}
+
+	size_t GetNumberOfBPMs() const
+	{
+		return bpms.size();
+	}
+
+private:
+
+	/**
+	 *	Records a plane of the BPM data into the readings of the
+	 *	state tracked by the calling thread.
+	 */
+	class ReadingBuffer: public BPM::Buffer
+	{
+	public:
+		ReadingBuffer(int plane) :
+			plane(plane)
+		{
+		}
+		virtual void Record(const BPM& aBPM, const BPM::Data& data);
+
+		int plane;
+		std::map<const BPM*, size_t> rows;
+	};
+
+	void Deviation(RealVector& d) const;
+	void Factorise();
+	void Solve(const RealVector& d, RealVector& x) const;
+
+	AcceleratorModel* model;
+	std::vector<BPM*> bpms;
+	RWChannelArray& correctors;
+	size_t nthreads;
+	ReadingBuffer buffer;
+
+	std::vector<EnergyState*> states;
+	double w_abs;
+	double w_diff;
+	double threshold;
+
+	RealVector readings;
+	RealVector reference;
+	RealVector deviation;
+	RealVector correction;
+	RealMatrix response;
+
+	/**
+	 *	Factorisation of the weighted response, with the columns in the
+	 *	order colOrder and the rows reversed: R above the diagonal of qr
+	 *	and in rdiag, the Householder vectors on and below the diagonal,
+	 *	and rows [k, rowEnd[k]) touched by the k-th reflection.
+	 */
+	RealMatrix qr;
+	RealVector rdiag;
+	RealVector beta;
+	std::vector<size_t> colOrder;
+	std::vector<size_t> rowEnd;
+	TLAS::SVDMatrix<double>* svd;
+
+	//Copy protection
+	DispersionFreeSteering(const DispersionFreeSteering& rhs);
+	DispersionFreeSteering& operator=(const DispersionFreeSteering& rhs);
+};
+
+#endif
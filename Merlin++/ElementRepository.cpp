@@ -13,30 +13,6 @@
 
 using namespace std;
 
-namespace
-{
-
-struct MatchID
-{
-public:
-
-	MatchID(const string& idpat, bool negate = false) :
-		pattern(idpat)
-	{
-	}
-	bool operator()(const ModelElement* elmnt) const
-	{
-		bool rv = pattern(elmnt->GetQualifiedName());
-		return neg ? !rv : rv;
-	}
-private:
-	bool neg;
-	StringPattern pattern;
-
-};
-
-} // end anonymous namespace
-
 template class std::set<ModelElement*>;
 
 ElementRepository::~ElementRepository()
@@ -47,17 +23,60 @@ ElementRepository::~ElementRepository()
 bool ElementRepository::Add(ModelElement* anElement)
 {
 	pair<iterator, bool> rv = theElements.insert(anElement);
+	if(rv.second)
+	{
+		theIndex.insert(NameIndex::value_type(anElement->GetQualifiedName(), anElement));
+	}
 	return rv.second;
 }
 
 size_t ElementRepository::Count(const std::string& id) const
 {
-	return count_if(theElements.begin(), theElements.end(), MatchID(id));
+	StringPattern pattern(id);
+	pair<NameIndex::const_iterator, NameIndex::const_iterator> range = IndexRange(id);
+	size_t n = 0;
+	for(NameIndex::const_iterator i = range.first; i != range.second; i++)
+	{
+		if(pattern(i->first))
+		{
+			n++;
+		}
+	}
+	return n;
 }
 
 size_t ElementRepository::Find(const std::string& id, std::vector<ModelElement*>& elements)
 {
-	remove_copy_if(theElements.begin(), theElements.end(),
-		back_inserter(elements), MatchID(id, true));
+	StringPattern pattern(id);
+	pair<NameIndex::const_iterator, NameIndex::const_iterator> range = IndexRange(id);
+	for(NameIndex::const_iterator i = range.first; i != range.second; i++)
+	{
+		if(pattern(i->first))
+		{
+			elements.push_back(i->second);
+		}
+	}
 	return elements.size();
 }
+
+pair<ElementRepository::NameIndex::const_iterator, ElementRepository::NameIndex::const_iterator>
+ElementRepository::IndexRange(const std::string& id) const
+{
+	// An OR'd pattern, or a wild card in the type, can match any element
+	size_t n = id.find_first_of(string("|.") + StringPattern::wcchar);
+	if(id.find('|') != string::npos || (n != string::npos && id[n] != '.'))
+	{
+		return make_pair(theIndex.begin(), theIndex.end());
+	}
+
+	if(id.find(StringPattern::wcchar) == string::npos)
+	{
+		return theIndex.equal_range(id);
+	}
+
+	// Types contain no '.', so all names of a type lie between "type." and "type/"
+	string prefix = id.substr(0, n + 1);
+	NameIndex::const_iterator first = theIndex.lower_bound(prefix);
+	prefix[n]++;
+	return make_pair(first, theIndex.lower_bound(prefix));
+}
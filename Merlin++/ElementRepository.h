@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
 #include "ModelElement.h"
 
 /**
@@ -33,6 +34,12 @@ public:
 	typedef ElementSet::iterator iterator;
 	typedef ElementSet::const_iterator const_iterator;
 
+	/**
+	 *	Elements keyed by their qualified name ("type.name").
+	 *	Element names must not change after the element is added.
+	 */
+	typedef std::multimap<std::string, ModelElement*> NameIndex;
+
 	~ElementRepository();
 
 	/**
@@ -48,6 +55,9 @@ public:
 	 *	Counts the number of elements in the repository with
 	 *	identifiers which match id. id takes the form
 	 *	"type.name", where type, name or both can be patterns.
+	 *	When type is a literal, only the elements of that type
+	 *	are searched; when the whole of id is a literal, the
+	 *	element is found directly.
 	 */
 	size_t Count(const std::string& id) const;
 
@@ -71,6 +81,16 @@ public:
 	ElementRepository::const_iterator end() const;
 
 	ElementSet theElements;
+
+private:
+
+	/**
+	 *	Returns the range of theIndex which can contain matches
+	 *	for the pattern id.
+	 */
+	std::pair<NameIndex::const_iterator, NameIndex::const_iterator> IndexRange(const std::string& id) const;
+
+	NameIndex theIndex;
 };
 
 inline size_t ElementRepository::Size() const
@@ -11,6 +11,7 @@
 #include "SynchRadParticleProcess.h"
 #include "TransferMatrix.h"
 #include "EquilibriumDistribution.h"
+#include "RadiationIntegrals.h"
 #include "PhysicalConstants.h"
 #include "PhysicalUnits.h"
 #include "MatrixPrinter.h"
@@ -67,13 +68,12 @@ void IntegrateEigenvector::polint(double xa[], double ya[], int n, double x, dou
 double IntegrateEigenvector::trapzd(double a, double b, int n)
 {
 	double x, tnm, sum, del;
-	static double s;
 	int it, j;
 
 	if(n == 1)
 	{
-		s = 0.5 * (b - a) * (func(a) + func(b));
-		return s;
+		trapzdSum = 0.5 * (b - a) * (func(a) + func(b));
+		return trapzdSum;
 	}
 	else
 	{
@@ -88,8 +88,8 @@ double IntegrateEigenvector::trapzd(double a, double b, int n)
 		{
 			sum += func(x);
 		}
-		s = 0.5 * (s + (b - a) * sum / tnm);
-		return s;
+		trapzdSum = 0.5 * (trapzdSum + (b - a) * sum / tnm);
+		return trapzdSum;
 	}
 }
 
@@ -245,17 +245,7 @@ void EquilibriumDistribution::CalculateEmittance()
 
 	// Need to fix the R53 and R54 terms, which are not calculated correctly
 	// for a distorted closed orbit (tracking problem!)
-	M(4, 2) = -(-M(2, 2) * M(3, 1) * M(4, 0) + M(2, 1) * M(3, 2) * M(4, 0)
-		+ M(2, 2) * M(3, 0) * M(4, 1) - M(2, 0) * M(3, 2) * M(4, 1)
-		+ M(2, 5) * M(3, 2) * M(4, 4) - M(2, 2) * M(3, 5) * M(4, 4)
-		- M(2, 4) * M(3, 2) * M(4, 5) + M(2, 2) * M(3, 4) * M(4, 5))
-		/ (M(2, 3) * M(3, 2) - M(2, 2) * M(3, 3));
-
-	M(4, 3) = (-M(3, 3) * M(2, 1) * M(4, 0) + M(3, 3) * M(2, 0) * M(4, 1)
-		- M(3, 3) * M(2, 5) * M(4, 4) + M(3, 3) * M(2, 4) * M(4, 5)
-		+ M(2, 3) * M(3, 1) * M(4, 0) - M(2, 3) * M(3, 0) * M(4, 1)
-		+ M(2, 3) * M(3, 5) * M(4, 4) - M(2, 3) * M(3, 4) * M(4, 5))
-		/ (M(2, 3) * M(3, 2) - M(2, 2) * M(3, 3));
+	RadiationIntegrals::CorrectR53R54(M);
 
 	//Just make sure the matrix is symplectic
 	Symplectify(M);
@@ -335,9 +325,35 @@ void EquilibriumDistribution::CalculateEmittance()
 	const double C_L = 55 * ElectronRadius * PlanckConstant / (48 * twoPi * sqrt(3.0) * ElectronMass);
 	double gamma5 = pow(p0 * ElectronCharge / eV / ElectronMass / SpeedOfLight / SpeedOfLight, 5);
 
+	// Modes whose damping has not been found by tracking take that of their plane from the radiation integrals
+	RadiationIntegrals ri(theModel, p0);
+	if(dampingConstant[0] == 0 || dampingConstant[1] == 0 || dampingConstant[2] == 0)
+	{
+		ri.Calculate();
+	}
+
 	for(k = 0; k < 3; k++)
 	{
-		emittance[k] = SumE5[k] * C_L * gamma5 / SpeedOfLight / dampingConstant[k];
+		double damping = dampingConstant[k];
+		if(damping == 0)
+		{
+			damping = ri.DampingConstant(RadiationIntegrals::EigenmodePlane(eigenvectors, k));
+		}
+		emittance[k] = SumE5[k] * C_L * gamma5 / SpeedOfLight / damping;
+	}
+}
+
+void EquilibriumDistribution::CalculateEmittanceFromIntegrals(size_t nthreads)
+{
+	RadiationIntegrals ri(theModel, p0);
+	ri.Calculate(nthreads);
+
+	const double C_L = 55 * ElectronRadius * PlanckConstant / (48 * twoPi * sqrt(3.0) * ElectronMass);
+	double gamma5 = pow(p0 * ElectronCharge / eV / ElectronMass / SpeedOfLight / SpeedOfLight, 5);
+
+	for(int k = 0; k < 3; k++)
+	{
+		emittance[k] = ri.ModeIntegral(k) * C_L * gamma5 / SpeedOfLight / ri.ModeDampingConstant(k);
 	}
 }
 
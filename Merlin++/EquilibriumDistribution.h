@@ -26,6 +26,10 @@
 class IntegrateEigenvector
 {
 public:
+	IntegrateEigenvector() :
+		ek(6)
+	{
+	}
 	virtual ~IntegrateEigenvector()
 	{
 	}
@@ -36,6 +40,9 @@ protected:
 	Complex k;
 	double h, tanE1;
 
+	// running trapezium sum of trapzd(), refined on each call
+	double trapzdSum;
+
 	void polint(double xa[], double ya[], int n, double x, double& y, double& dy);
 	double trapzd(double a, double b, int n);
 	double qromb(double a, double b);
@@ -76,8 +83,25 @@ public:
 	double BeamMoment(int i, int j, int ncpt = 0);
 
 	void CalculateDampingConstants();
+
+	/**
+	 * Equilibrium emittance of each eigenmode from the integrals of its
+	 * eigenvector through the bends. Modes without a damping constant
+	 * from CalculateDampingConstants() use that of their plane from the
+	 * radiation integrals.
+	 */
 	void CalculateEmittance();
 
+	/**
+	 * As CalculateEmittance(), but with the eigenvector integrals found
+	 * in a single sweep of the element matrices by RadiationIntegrals,
+	 * using nthreads threads (0 for one per hardware thread). The
+	 * damping of each mode is that of its plane from the radiation
+	 * integrals, so CalculateDampingConstants() is not needed, and the
+	 * damping constants of this object are left unchanged.
+	 */
+	void CalculateEmittanceFromIntegrals(size_t nthreads = 0);
+
 private:
 	AcceleratorModel* theModel;
 	double p0;
@@ -98,6 +98,15 @@ public:
 	 */
 	virtual double Increment(double delta);
 
+	/**
+	 *	Channels made by the same constructor form a block,
+	 *	which is read and written through the element access
+	 *	functions directly.
+	 */
+	virtual const void* GetBlockKey() const;
+	virtual void ReadBlock(ROChannel* const* chnls, size_t n, RealVector& values, size_t i0) const;
+	virtual void WriteBlock(ROChannel* const* chnls, size_t n, const RealVector& values, size_t i0);
+
 private:
 
 	E* theElement;
@@ -176,4 +185,28 @@ double TIRWChannel<E>::Increment(double delta)
 	return v;
 }
 
+template<class E>
+const void* TIRWChannel<E>::GetBlockKey() const
+{
+	return fp;
+}
+
+template<class E>
+void TIRWChannel<E>::ReadBlock(ROChannel* const* chnls, size_t n, RealVector& values, size_t i0) const
+{
+	for(size_t i = 0; i < n; i++)
+	{
+		values[i0 + i] = fp->ReadFrom(static_cast<const TIRWChannel<E>*>(chnls[i])->theElement);
+	}
+}
+
+template<class E>
+void TIRWChannel<E>::WriteBlock(ROChannel* const* chnls, size_t n, const RealVector& values, size_t i0)
+{
+	for(size_t i = 0; i < n; i++)
+	{
+		fp->WriteTo(static_cast<TIRWChannel<E>*>(chnls[i])->theElement, values[i0 + i]);
+	}
+}
+
 #endif
@@ -21,7 +21,8 @@ string InterpolatedAperture::GetType()
 	return "RECTELLIPSE-interpolated";
 }
 
-InterpolatedAperture::InterpolatedAperture(DataTable dt)
+InterpolatedAperture::InterpolatedAperture(DataTable dt) :
+	inscribedRadius(0)
 {
 	AperturesToInterpolate = dt;
 	ConvertToStruct(AperturesToInterpolate);
@@ -61,7 +62,14 @@ void InterpolatedAperture::ConvertToStruct(DataTable dt)
 InterpolatedRectEllipseAperture::InterpolatedRectEllipseAperture(DataTable dt) :
 	InterpolatedAperture(dt)
 {
-
+	if(!ApList.empty())
+	{
+		inscribedRadius = ApList[0].ap1;
+		for(auto &ap : ApList)
+		{
+			inscribedRadius = min({inscribedRadius, ap.ap1, ap.ap2, ap.ap3, ap.ap4});
+		}
+	}
 }
 
 InterpolatedRectEllipseAperture::~InterpolatedRectEllipseAperture()
@@ -165,7 +173,14 @@ void InterpolatedRectEllipseAperture::printout(std::ostream& out) const
 InterpolatedCircularAperture::InterpolatedCircularAperture(DataTable dt) :
 	InterpolatedAperture(dt)
 {
-
+	if(!ApList.empty())
+	{
+		inscribedRadius = ApList[0].ap1;
+		for(auto &ap : ApList)
+		{
+			inscribedRadius = min(inscribedRadius, ap.ap1);
+		}
+	}
 }
 
 InterpolatedCircularAperture::~InterpolatedCircularAperture()
@@ -392,7 +407,14 @@ bool InterpolatedEllipticalAperture::CheckWithinApertureBoundaries(double x, dou
 InterpolatedOctagonalAperture::InterpolatedOctagonalAperture(DataTable dt) :
 	InterpolatedAperture(dt)
 {
-
+	if(!ApList.empty())
+	{
+		inscribedRadius = ApList[0].ap1;
+		for(auto &ap : ApList)
+		{
+			inscribedRadius = min({inscribedRadius, ap.ap1, ap.ap2});
+		}
+	}
 }
 
 InterpolatedOctagonalAperture::~InterpolatedOctagonalAperture()
@@ -52,6 +52,15 @@ public:
 	 */
 	static Aperture* GetInstance(DataTable);
 
+	/**
+	 *  InterpolatedAperture override of Aperture member function GetInscribedRadius()
+	 *  @return smallest inscribed half-diagonal over all interpolation points
+	 */
+	double GetInscribedRadius() const
+	{
+		return inscribedRadius;
+	}
+
 	DataTable AperturesToInterpolate;
 
 	struct apStruct
@@ -70,6 +79,13 @@ public:
 	std::vector<apStruct> ApList;
 
 	void ConvertToStruct(DataTable);
+
+protected:
+
+	/**
+	 *  inscribed half-diagonal, set by the derived class constructors
+	 */
+	double inscribedRadius;
 };
 
 class InterpolatedRectEllipseAperture: public InterpolatedAperture
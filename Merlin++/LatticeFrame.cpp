@@ -12,6 +12,41 @@
 #define VALID_SFRAME(sframe) \
 	assert(sframe == this || sframe == GLOBAL_FRAME || superFrame != GLOBAL_FRAME)
 
+namespace
+{
+
+// Source of the versions of all frame hierarchies
+std::atomic<unsigned long> lastVersion(0);
+
+} // end anonymous namespace
+
+unsigned long LatticeFrame::NewVersion()
+{
+	return ++lastVersion;
+}
+
+void LatticeFrame::Invalidate() const
+{
+	GetGlobalFrame()->frameVersion.store(NewVersion(), std::memory_order_release);
+}
+
+void LatticeFrame::InvalidateGeometryCache() const
+{
+	const LatticeFrame* root = GetGlobalFrame();
+	root->geometryVersion.store(NewVersion(), std::memory_order_release);
+	root->frameVersion.store(NewVersion(), std::memory_order_release);
+}
+
+unsigned long LatticeFrame::FrameVersion() const
+{
+	return GetGlobalFrame()->frameVersion.load(std::memory_order_acquire);
+}
+
+unsigned long LatticeFrame::GeometryVersion() const
+{
+	return GetGlobalFrame()->geometryVersion.load(std::memory_order_acquire);
+}
+
 Transform3D LatticeFrame::GetFrameTransform(const LatticeFrame* sframe) const
 {
 
@@ -31,6 +66,16 @@ Transform3D LatticeFrame::GetFrameTransform(const LatticeFrame* sframe) const
 		return GetLocalFrameTransform();
 	}
 
+	if(sframe->IsGlobalFrame())
+	{
+		const unsigned long v = FrameVersion();
+		if(FrameCache<Transform3D>::Pointer t = frameT.Find(v))
+		{
+			return *t;
+		}
+		return *frameT.Store(v, GlobalPhysicalTransform() * GlobalGeometryTransform().inv());
+	}
+
 	Transform3D t1 = GetPhysicalTransform(sframe);
 	double s = GetPosition(sframe);
 
@@ -49,11 +94,22 @@ Transform3D LatticeFrame::GetPhysicalTransform(const LatticeFrame* sframe) const
 		return Transform3D();
 	}
 
+	// The global transformation includes that of the top-level frame
+	if(sframe == GLOBAL_FRAME)
+	{
+		return GlobalPhysicalTransform() * GetGlobalFrame()->GetLocalFrameTransform();
+	}
+
+	if(sframe->IsGlobalFrame())
+	{
+		return GlobalPhysicalTransform();
+	}
+
 	Transform3D t0 = GetLocalFrameTransform();
 
 	if(superFrame != GLOBAL_FRAME)
 	{
-		Transform3D t1 = superFrame->GetGeometryTransform(0, s_0);
+		Transform3D t1 = superFrame->GetSubFrameOriginTransform(this);
 		Transform3D t2 = superFrame->GetPhysicalTransform(sframe);
 		t0 = t0 * t1 * t2;
 	}
@@ -61,6 +117,42 @@ Transform3D LatticeFrame::GetPhysicalTransform(const LatticeFrame* sframe) const
 	return t0;
 }
 
+Transform3D LatticeFrame::GlobalPhysicalTransform() const
+{
+	if(superFrame == GLOBAL_FRAME)
+	{
+		return Transform3D();
+	}
+
+	const unsigned long v = FrameVersion();
+	if(FrameCache<Transform3D>::Pointer t = physicalT.Find(v))
+	{
+		return *t;
+	}
+	return *physicalT.Store(v, GetLocalFrameTransform() * superFrame->GetSubFrameOriginTransform(this)
+		* superFrame->GlobalPhysicalTransform());
+}
+
+Transform3D LatticeFrame::GlobalGeometryTransform() const
+{
+	if(superFrame == GLOBAL_FRAME)
+	{
+		return Transform3D();
+	}
+
+	const unsigned long v = GeometryVersion();
+	if(FrameCache<Transform3D>::Pointer t = geometryT.Find(v))
+	{
+		return *t;
+	}
+	return *geometryT.Store(v, superFrame->GetSubFrameOriginTransform(this) * superFrame->GlobalGeometryTransform());
+}
+
+Transform3D LatticeFrame::GetSubFrameOriginTransform(const LatticeFrame* aSubFrame) const
+{
+	return GetGeometryTransform(0, aSubFrame->GetLocalPosition());
+}
+
 double LatticeFrame::GetPosition(const LatticeFrame* sframe) const
 {
 	VALID_SFRAME(sframe);
@@ -84,12 +176,19 @@ Transform3D LatticeFrame::GetBoundaryPlaneTransform(BoundaryPlane p) const
 		return Transform3D();
 	}
 
+	FrameCache<Transform3D>& cache = p == AcceleratorGeometry::entrance ? entranceT : exitT;
+	const unsigned long v = FrameVersion();
+	if(FrameCache<Transform3D>::Pointer t = cache.Find(v))
+	{
+		return *t;
+	}
+
 	Transform3D t0 = LocalBoundaryPlaneTransform(p);
 	if(superFrame != nullptr && superFrame->IsBoundaryPlane(p, this))
 	{
 		t0 = t0 * (superFrame->GetBoundaryPlaneTransform(p));
 	}
-	return t0;
+	return *cache.Store(v, t0);
 }
 /****
    void LatticeFrame::Translate (double dx, double dy, double dz)
@@ -8,6 +8,9 @@
 #ifndef LatticeFrame_h
 #define LatticeFrame_h 1
 
+#include <atomic>
+#include <memory>
+
 #include "merlin_config.h"
 #include "ModelElement.h"
 #include "AcceleratorGeometry.h"
@@ -31,6 +34,70 @@ public:
 	virtual void ActOn(LatticeFrame* frame) = 0;
 };
 
+/**
+ *	A value cached by a LatticeFrame for one version of the frame
+ *	hierarchy. Each value is stored with its version as an immutable
+ *	snapshot, published atomically, so that threads sharing a model
+ *	can fill the caches concurrently. A reader keeps the snapshot it
+ *	found for as long as it holds the returned pointer.
+ */
+template<class T>
+class FrameCache
+{
+public:
+
+	typedef std::shared_ptr<const T> Pointer;
+
+	FrameCache() :
+		entry()
+	{
+	}
+
+	/**
+	 *	Copies start empty.
+	 */
+	FrameCache(const FrameCache&) :
+		entry()
+	{
+	}
+
+	/**
+	 *	Returns the cached value if it is for version v, otherwise a
+	 *	null pointer.
+	 */
+	Pointer Find(unsigned long v) const
+	{
+		std::shared_ptr<const Entry> e = std::atomic_load(&entry);
+		return e && e->version == v ? Pointer(e, &e->value) : Pointer();
+	}
+
+	/**
+	 *	Stores t as the value for version v, and returns it.
+	 */
+	Pointer Store(unsigned long v, const T& t)
+	{
+		std::shared_ptr<const Entry> e = std::make_shared<const Entry>(v, t);
+		std::atomic_store(&entry, e);
+		return Pointer(e, &e->value);
+	}
+
+private:
+
+	struct Entry
+	{
+		Entry(unsigned long v, const T& t) :
+			version(v), value(t)
+		{
+		}
+		const unsigned long version;
+		const T value;
+	};
+
+	std::shared_ptr<const Entry> entry;
+
+	FrameCache& operator=(const FrameCache&);
+};
+
 /**
  *	A LatticeFrame is a ModelElement that provides a
  *	coordinate system for a subsection of the accelerator
@@ -81,6 +148,13 @@ public:
  *	Frame Transformations are most important during typical
  *	beam dynamics tracking operations, while Physical
  *	Transformations can be used for surveying.
+ *
+ *	The transformations to the global frame and the boundary plane
+ *	transformations are cached, and are recalculated only after a
+ *	frame in the same hierarchy has been transformed (see
+ *	Invalidate()), re-positioned or re-parented. The versions of the
+ *	caches are kept by the top-level frame, so a change to one model
+ *	leaves the caches of other models valid.
  */
 
 class LatticeFrame: public ModelElement, public Transformable
@@ -272,6 +346,15 @@ public:
 	 */
 	virtual void ConsolidateConstruction();
 
+	/**
+	 *	Causes the cached transformations of all frames in this
+	 *	hierarchy to be recalculated when next required. Must be
+	 *	called by anything which changes the result of
+	 *	GetLocalFrameTransform() (e.g. support offsets). Derived
+	 *	classes which override this function must call it.
+	 */
+	virtual void Invalidate() const;
+
 	/**
 	 *	Sets the position of the LatticeFrame on the immediate
 	 *	super-frame's geometry.
@@ -327,6 +410,29 @@ protected:
 	 */
 	void SetGeometry(const AcceleratorGeometry* geom);
 
+	/**
+	 *	Returns the geometry transformation from the origin of this
+	 *	frame to the origin of the sub-frame aSubFrame.
+	 *
+	 *	@return Geometry transformation to the origin of aSubFrame
+	 */
+	virtual Transform3D GetSubFrameOriginTransform(const LatticeFrame* aSubFrame) const;
+
+	/**
+	 *	Discards the cached transformations and geometry of all
+	 *	frames in this hierarchy, after a frame has been
+	 *	re-positioned or re-parented.
+	 */
+	void InvalidateGeometryCache() const;
+
+	/**
+	 *	The current versions of this hierarchy for the cached
+	 *	transformations, and for the cached geometry only. Versions
+	 *	are unique across all hierarchies.
+	 */
+	unsigned long FrameVersion() const;
+	unsigned long GeometryVersion() const;
+
 	LatticeFrame* superFrame;
 
 private:
@@ -345,6 +451,38 @@ private:
 	virtual bool IsBoundaryPlane(BoundaryPlane p, const LatticeFrame* aSubFrame) const = 0;
 	Transform3D LocalBoundaryPlaneTransform(BoundaryPlane p) const;
 
+	/**
+	 *	The physical transformation from the global frame
+	 *	(excluding its own local transformation), and the geometry
+	 *	transformation from the global frame origin to the origin
+	 *	of this frame.
+	 */
+	Transform3D GlobalPhysicalTransform() const;
+	Transform3D GlobalGeometryTransform() const;
+
+	/**
+	 *	Returns a new version, distinct from all earlier ones.
+	 */
+	static unsigned long NewVersion();
+
+	/**
+	 *	Cached transformations.
+	 */
+	mutable FrameCache<Transform3D> physicalT;
+	mutable FrameCache<Transform3D> geometryT;
+	mutable FrameCache<Transform3D> frameT;
+	mutable FrameCache<Transform3D> entranceT;
+	mutable FrameCache<Transform3D> exitT;
+
+	/**
+	 *	Versions of the hierarchy, used when this is the top-level
+	 *	frame. The frame version changes with any change, the
+	 *	geometry version only when a frame is re-positioned or
+	 *	re-parented.
+	 */
+	mutable std::atomic<unsigned long> frameVersion;
+	mutable std::atomic<unsigned long> geometryVersion;
+
 	LatticeFrame& operator=(const LatticeFrame& rhs);
 
 };
@@ -354,12 +492,14 @@ private:
  */
 
 inline LatticeFrame::LatticeFrame(const std::string& id) :
-	ModelElement(id), Transformable(), s_0(0), superFrame(nullptr), itsGeometry(nullptr)
+	ModelElement(id), Transformable(), s_0(0), superFrame(nullptr), itsGeometry(nullptr), frameVersion(NewVersion()),
+	geometryVersion(NewVersion())
 {
 }
 
 inline LatticeFrame::LatticeFrame(const LatticeFrame& rhs) :
-	ModelElement(rhs), Transformable(rhs), s_0(0), superFrame(nullptr), itsGeometry(nullptr)
+	ModelElement(rhs), Transformable(rhs), s_0(0), superFrame(nullptr), itsGeometry(nullptr), frameVersion(NewVersion()),
+	geometryVersion(NewVersion())
 {
 }
 
@@ -456,12 +596,15 @@ inline void LatticeFrame::ConsolidateConstruction()
 inline void LatticeFrame::SetLocalPosition(double s)
 {
 	s_0 = s;
+	InvalidateGeometryCache();
 }
 
 inline LatticeFrame* LatticeFrame::SetSuperFrame(LatticeFrame* aFrame)
 {
 	LatticeFrame* tmp = superFrame;
+	InvalidateGeometryCache();
 	superFrame = aFrame;
+	InvalidateGeometryCache();
 	return tmp;
 }
 
@@ -478,6 +621,7 @@ inline bool LatticeFrame::IsGlobalFrame() const
 inline void LatticeFrame::SetGeometry(const AcceleratorGeometry* geom)
 {
 	itsGeometry = geom;
+	InvalidateGeometryCache();
 }
 
 #endif
@@ -7,6 +7,7 @@
 
 #include <fstream>
 #include <vector>
+#include <algorithm>
 #include "ParticleBunch.h"
 #include "ParticleTracker.h"
 #include "RingDeltaTProcess.h"
@@ -22,6 +23,17 @@ using namespace std;
 using namespace ParticleTracking;
 using namespace TLAS;
 
+namespace
+{
+
+// Packs the indices of a lattice function into a single key for the column index
+inline int ColumnKey(int i, int j, int k)
+{
+	return (i * 16 + j) * 16 + k;
+}
+
+}
+
 LatticeFunction::LatticeFunction(int _i, int _j, int _k) :
 	i(_i), j(_j), k(_k)
 {
@@ -144,6 +156,7 @@ void LatticeFunctionTable::SetForceLongitudinalStability(bool enable)
 void LatticeFunctionTable::AddFunction(int i, int j, int k)
 {
 	LatticeFunction* lfn = new LatticeFunction(i, j, k);
+	columnIndex.insert(make_pair(ColumnKey(i, j, k), lfnlist.size()));
 	lfnlist.push_back(lfn);
 	if(k != 0)
 	{
@@ -190,6 +203,7 @@ void LatticeFunctionTable::RemoveAllFunctions()
 {
 	for_each(lfnlist.begin(), lfnlist.end(), DeleteLatticeFunction());
 	lfnlist.clear();
+	columnIndex.clear();
 	AddFunction(0, 0, 0);
 	orbitonly = true;
 }
@@ -321,6 +335,7 @@ double LatticeFunctionTable::DoCalculate(double cscale, PSvector* pInit, RealMat
 {
 	int Ndim, Nsize;
 	for_each(lfnlist.begin(), lfnlist.end(), ClearLatticeFunction());
+	rowIndex.clear();
 
 	PSvector p(0);
 	if(pInit)
@@ -484,6 +499,10 @@ double LatticeFunctionTable::DoCalculate(double cscale, PSvector* pInit, RealMat
 
 		N  = M21 * N;
 
+		if(isMore)
+		{
+			rowIndex.insert(make_pair(tracker.GetCurrentComponent().GetName(), NumberOfRows()));
+		}
 		for_each(lfnlist.begin(), lfnlist.end(), CalculateLatticeFunction(s, pref1, N, eigenOK));
 		if(isMore)
 		{
@@ -507,6 +526,7 @@ double LatticeFunctionTable::DoCalculate(double cscale, PSvector* pInit, RealMat
 double LatticeFunctionTable::DoCalculateOrbitOnly(double cscale, PSvector* pInit)
 {
 	for_each(lfnlist.begin(), lfnlist.end(), ClearLatticeFunction());
+	rowIndex.clear();
 
 	PSvector p(0);
 	if(pInit)
@@ -545,6 +565,7 @@ double LatticeFunctionTable::DoCalculateOrbitOnly(double cscale, PSvector* pInit
 		ParticleBunch::const_iterator ip = tracker.GetTrackedBunch().begin();
 		const Particle& pref = *ip++;
 
+		rowIndex.insert(make_pair(tracker.GetCurrentComponent().GetName(), NumberOfRows()));
 		for_each(lfnlist.begin(), lfnlist.end(), CalculateLatticeFunction(s, pref, N1));
 		s += tracker.GetCurrentComponent().GetLength();
 		loop = tracker.StepComponent();
@@ -600,38 +621,70 @@ void LatticeFunctionTable::PrintTable(ostream& os, int n1, int n2)
 
 int LatticeFunctionTable::GetSPosIndex(double s)
 {
-	int n;
+	// the s column never decreases, so the first row at or beyond s can be found by bisection
+	const vector<double>& spos = lfnlist[0]->GetValues();
+	vector<double>::const_iterator it = lower_bound(spos.begin(), spos.end(), s);
+	return it == spos.end() ? -1 : it - spos.begin();
+}
 
-	for(n = 0; n < NumberOfRows(); n++)
-		if(lfnlist[0]->GetValue(n) >= s)
-		{
-			return n;
-		}
+void LatticeFunctionTable::GetSPosRange(double s, int& n1, int& n2) const
+{
+	const vector<double>& spos = lfnlist[0]->GetValues();
+	pair<vector<double>::const_iterator, vector<double>::const_iterator> rows = equal_range(spos.begin(), spos.end(),
+		s);
+	n1 = rows.first - spos.begin();
+	n2 = rows.second - spos.begin();
+}
 
-	return -1;
+int LatticeFunctionTable::GetRowIndex(const string& name) const
+{
+	map<string, int>::const_iterator it = rowIndex.find(name);
+	return it == rowIndex.end() ? -1 : it->second;
 }
 
 double LatticeFunctionTable::Value(int i, int j, int k, int ncpt)
 {
-	vectorlfn::iterator lfnit = GetColumn(i, j, k);
-	return (*lfnit)->GetValue(ncpt);
+	return lfnlist[FindColumn(i, j, k)]->GetValue(ncpt);
 }
 
-vectorlfn::iterator LatticeFunctionTable::GetColumn(int i, int j, int k)
+const vector<double>& LatticeFunctionTable::Column(int i, int j, int k) const
 {
-	vectorlfn::iterator lfnit = lfnlist.begin();
-	int _i, _j, _k;
+	return lfnlist[FindColumn(i, j, k)]->GetValues();
+}
 
-	for(; lfnit != lfnlist.end(); lfnit++)
+double LatticeFunctionTable::Interpolate(int i, int j, int k, double s) const
+{
+	const vector<double>& spos = lfnlist[0]->GetValues();
+	const vector<double>& v = Column(i, j, k);
+
+	// rows n-1 and n bracket s, with s[n-1] <= s < s[n]
+	size_t n = upper_bound(spos.begin(), spos.end(), s) - spos.begin();
+	if(n == 0)
 	{
-		(*lfnit)->GetIndices(_i, _j, _k);
-		if(i == _i && j == _j && k == _k)
-		{
-			return lfnit;
-		}
+		return v.front();
+	}
+	if(n == spos.size())
+	{
+		return v.back();
 	}
 
-	return lfnit;
+	double f = (s - spos[n - 1]) / (spos[n] - spos[n - 1]);
+	return v[n - 1] + f * (v[n] - v[n - 1]);
+}
+
+size_t LatticeFunctionTable::FindColumn(int i, int j, int k) const
+{
+	map<int, size_t>::const_iterator it = columnIndex.find(ColumnKey(i, j, k));
+	if(it == columnIndex.end())
+	{
+		throw MerlinException("LatticeFunctionTable: requested lattice function is not in the table");
+	}
+	return it->second;
+}
+
+vectorlfn::iterator LatticeFunctionTable::GetColumn(int i, int j, int k)
+{
+	return lfnlist.begin() + FindColumn(i, j, k);
 }
 
 double LatticeFunctionTable::Mean(int i, int j, int k, int n1, int n2)
@@ -9,6 +9,8 @@
 #define LatticeFunctions_h 1
 
 #include <vector>
+#include <map>
+#include <string>
 #include <iostream>
 
 #include "PSvector.h"
@@ -22,6 +24,10 @@ public:
 	void AppendValue(double v);
 	void ClearValues();
 	double GetValue(int n);
+	const std::vector<double>& GetValues() const
+	{
+		return value;
+	}
 	void Derivative(LatticeFunction* lfnM, LatticeFunction* lfnP, double dp);
 	std::vector<double>::iterator begin();
 	std::vector<double>::iterator end();
@@ -47,9 +53,31 @@ public:
 	void Calculate(PSvector* p = nullptr, RealMatrix* M = nullptr);
 	void CalculateEnergyDerivative();
 	double Value(int i, int j, int k, int ncpt);
+
+	/**
+	 * All rows of function (i,j,k), in order of s. The reference stays valid
+	 * until the table is recalculated or its functions are changed.
+	 */
+	const std::vector<double>& Column(int i, int j, int k) const;
+
+	/**
+	 * Linear interpolation of function (i,j,k) at position s. Outside the
+	 * table the first or last row is returned.
+	 */
+	double Interpolate(int i, int j, int k, double s) const;
 	void PrintTable(std::ostream& os, int n1 = 0, int n2 = -1);
 	void Size(int& rows, int& cols);
 	int GetSPosIndex(double s);
+
+	/**
+	 * The rows [n1, n2) whose position is exactly s; n1 == n2 if there are none.
+	 */
+	void GetSPosRange(double s, int& n1, int& n2) const;
+
+	/**
+	 * Row at the entrance of the first element with the given name, or -1.
+	 */
+	int GetRowIndex(const std::string& name) const;
 	void SetDelta(double new_delta);
 	void MakeTMSymplectic(bool flag);
 	int NumberOfRows();
@@ -79,9 +107,16 @@ private:
 
 	vectorlfn lfnlist;
 
+	// column of each (i,j,k) in lfnlist
+	std::map<int, size_t> columnIndex;
+
+	// first row of each element name
+	std::map<std::string, int> rowIndex;
+
 	double DoCalculate(double cscale = 0, PSvector* pInit = nullptr, RealMatrix* MInit = nullptr);
 	double DoCalculateOrbitOnly(double cscale = 0, PSvector* pInit = nullptr);
 	vectorlfn::iterator GetColumn(int i, int j, int k);
+	size_t FindColumn(int i, int j, int k) const;
 };
 
 #endif
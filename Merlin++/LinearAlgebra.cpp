@@ -7,6 +7,7 @@
 
 #include <fstream>
 #include "LinearAlgebra.h"
+#include "BlockedLinearAlgebra.h"
 #include <algorithm> // for std::swap
 #include <cmath>
 
@@ -512,6 +513,11 @@ void tqli(RealVector& d, RealVector& e, RealMatrix& z)
 void EigenSystemSymmetricMatrix(RealMatrix& m, RealVector& eigenvalues)
 {
 	int n = m.nrows();
+	if(static_cast<size_t>(n) >= GetBlockedThreshold())
+	{
+		BlockedEigenSystemSymmetric(m, eigenvalues);
+		return;
+	}
 	eigenvalues.redim(n);
 
 	RealVector e(n);
@@ -6,6 +6,7 @@
  */
 
 #include <cstdlib>
+#include <sstream>
 #include "Components.h"
 #include "MerlinIO.h"
 #include "AcceleratorModelConstructor.h"
@@ -15,6 +16,7 @@
 #include "ResistiveWakePotentials.h"
 #include "PhysicalConstants.h"
 #include "DataTableTFS.h"
+#include "ParallelFor.h"
 #include "ConstructSrot.h"
 #include "MADInterface.h"
 
@@ -97,7 +99,9 @@ AcceleratorModel* MADInterface::ConstructModel()
 	unique_ptr<DataTable> MADinput;
 	try
 	{
-		MADinput = make_unique<DataTable>(DataTableReaderTFS(ifs).Read());
+		DataTableReaderTFS reader(ifs);
+		reader.SetThreads(nthreads);
+		MADinput = make_unique<DataTable>(reader.Read());
 	}
 	catch(const BadFormatException &e)
 	{
@@ -117,19 +121,81 @@ AcceleratorModel* MADInterface::ConstructModel()
 	TypeFactory* factory = new TypeFactory();
 	double brho = momentum / eV / SpeedOfLight;
 
-	//Loop over all components
-	for(auto &MADinputrow : *MADinput)
+	// First pass, in order: apply the type overrides, and find the rows to
+	// construct and the brho of each (which changes along the lattice when
+	// scaling for synchrotron radiation)
+	const size_t nrows = MADinput->Length();
+	vector<bool> ignored(nrows, false);
+	vector<size_t> component_rows;
+	vector<double> component_brho;
+	for(size_t i = 0; i < nrows; i++)
 	{
+		DataTableRow MADinputrow(MADinput.get(), i);
 		string type = MADinputrow.Get_s("KEYWORD");
 		double length = MADinputrow.Get_d("L");
 
 		if(length == 0 && zeroLengths.find(type) != zeroLengths.end())
 		{
 			MerlinIO::warning() << "Ignoring zero length " << type << ": " << MADinputrow.Get_s("NAME") << endl;
+			ignored[i] = true;
 			continue;
 		}
 		TypeOverrides(MADinputrow);
 
+		if(type == "LINE" || type == "SROT")
+		{
+			continue;
+		}
+
+		component_rows.push_back(i);
+		component_brho.push_back(brho);
+
+		if(inc_sr && (type == "SBEND" || type == "RBEND"))
+		{
+			momentum -= SRdE(MADinputrow.Get_d("ANGLE") / length, length, momentum);
+			brho = momentum / eV / SpeedOfLight;
+		}
+	}
+
+	// Construct the components, in blocks of rows shared between threads
+	vector<vector<AcceleratorComponent*> > components(nrows);
+	const size_t min_block = 256;
+	try
+	{
+		ParallelRanges(component_rows.size(), nthreads, component_rows.size() / min_block, [&](size_t r0, size_t r1)
+		{
+			for(size_t r = r0; r < r1; r++)
+			{
+				DataTableRow MADinputrow(MADinput.get(), component_rows[r]);
+				components[component_rows[r]] = factory->GetInstance(MADinputrow, component_brho[r]);
+			}
+		});
+	}
+	catch(...)
+	{
+		delete factory;
+		for(auto &row_components : components)
+		{
+			for(auto component : row_components)
+			{
+				delete component;
+			}
+		}
+		throw;
+	}
+	delete factory;
+
+	// Assemble the frames and components in order
+	for(size_t i = 0; i < nrows; i++)
+	{
+		if(ignored[i])
+		{
+			continue;
+		}
+
+		DataTableRow MADinputrow(MADinput.get(), i);
+		const string type = MADinputrow.Get_s("KEYWORD");
+
 		if(type == "LINE")
 		{
 			if(!flatLattice)
@@ -151,20 +217,11 @@ AcceleratorModel* MADInterface::ConstructModel()
 		}
 		else if(type == "SROT")
 		{
-			modelconstr->AppendComponentFrame(ConstructSrot(length, MADinputrow.Get_s("NAME")));
+			modelconstr->AppendComponentFrame(ConstructSrot(MADinputrow.Get_d("L"), MADinputrow.Get_s("NAME")));
 			continue;
 		}
 
-		//Determine multipole type by parameters
-		vector<AcceleratorComponent*> components = factory->GetInstance(MADinputrow, brho);
-
-		if(inc_sr && (type == "SBEND" || type == "RBEND"))
-		{
-			momentum -= SRdE(MADinputrow.Get_d("ANGLE") / length, length, momentum);
-			brho = momentum / eV / SpeedOfLight;
-		}
-
-		for(auto component : components)
+		for(auto component : components[i])
 		{
 			modelconstr->AppendComponent(*component);
 			component->SetComponentLatticePosition(z);
@@ -186,7 +243,6 @@ AcceleratorModel* MADInterface::ConstructModel()
 
 	AcceleratorModel* theModel = modelconstr->GetModel();
 	delete modelconstr;
-	delete factory;
 	modelconstr = nullptr;
 	return theModel;
 }
@@ -538,8 +594,10 @@ vector<AcceleratorComponent*> RFCavityComponentSingleCell::GetInstance(DataTable
 
 	if((rfcav_len / length - 1) > 0.001)
 	{
-		MerlinIO::error() << "SW cavity length not valid ";
-		MerlinIO::error() << '(' << length << ", " << len1 << ')' << endl;
+		// one write, as the components may be constructed in several threads
+		ostringstream msg;
+		msg << "SW cavity length not valid (" << length << ", " << len1 << ')' << endl;
+		MerlinIO::error() << msg.str();
 	}
 
 	SWRFStructure* rfstruct = new SWRFStructure(name, ncells, freq, volts * MV / rfcav_len, phase);
@@ -570,8 +628,10 @@ vector<AcceleratorComponent*> RFCavityComponent::GetInstance(DataTableRow& MADin
 
 	if(((len1 / length) - 1) > 0.001)
 	{
-		MerlinIO::error() << "SW cavity length not valid ";
-		MerlinIO::error() << '(' << length << ", " << len1 << ')' << endl;
+		// one write, as the components may be constructed in several threads
+		ostringstream msg;
+		msg << "SW cavity length not valid (" << length << ", " << len1 << ')' << endl;
+		MerlinIO::error() << msg.str();
 	}
 
 	return {new SWRFStructure(name, ncells, freq, volts * MV / length, phase)};
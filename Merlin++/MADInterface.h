@@ -122,6 +122,17 @@ public:
 	 */
 	void ScaleForSynchRad(bool scaleSR);
 
+	/**
+	 *   Number of threads reading the file and constructing the
+	 *   components (default 1, 0 for one per hardware thread). The
+	 *   frames and components are assembled in file order, so the
+	 *   model does not depend on the number of threads.
+	 */
+	void SetThreads(size_t n)
+	{
+		nthreads = n;
+	}
+
 	/**
 	 *   Treats the mad type typestr as a drift.
 	 */
@@ -175,6 +186,7 @@ protected:
 	bool logFlag = false;
 	bool honMadStructs = false;
 	bool appendFlag = false;
+	size_t nthreads = 1;
 
 	std::set<std::string> zeroLengths;
 	std::set<std::string> driftTypes;
@@ -124,21 +124,25 @@ inline double MagnetMover::GetRoll() const
 inline void MagnetMover::SetX(double x)
 {
 	t.setTranslationX(x);
+	Invalidate();
 }
 
 inline void MagnetMover::SetY(double y)
 {
 	t.setTranslationY(y);
+	Invalidate();
 }
 
 inline void MagnetMover::SetRoll(double roll)
 {
 	t.setRotation(roll);
+	Invalidate();
 }
 
 inline void MagnetMover::Reset()
 {
 	t = Transform2D();
+	Invalidate();
 }
 
 #endif
@@ -166,7 +166,7 @@ Complex MultipoleField::GetCoefficient(size_t np, double r0) const
 {
 	if(np + 1 > expansion.size())
 	{
-		const_cast<MultipoleField&>(*this).expansion.resize(np + 1, Complex(0, 0));
+		return Complex(0, 0);
 	}
 
 	return expansion[np] * pow(r0, np);
@@ -166,7 +166,8 @@ public:
 	/**
 	 *	Returns the unitless complex coefficient for the np-th
 	 *	term (bn+i*an).The coefficient is relative to the
-	 *	specified pole radius r0 (default = 1meter).
+	 *	specified pole radius r0 (default = 1meter). Terms above
+	 *	HighestMultipole() are zero, and do not extend the field.
 	 *	@return Complex coefficient for np-th term
 	 */
 	Complex GetCoefficient(size_t np, double r0 = 1.0) const;
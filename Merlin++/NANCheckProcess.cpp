@@ -10,11 +10,13 @@
 #include "ParticleBunchProcess.h"
 #include "ParticleBunch.h"
 #include <string>
+#include <limits>
 
 using namespace ParticleTracking;
 
 NANCheckProcess::NANCheckProcess(const string& aID, int prio) :
-	ParticleBunchProcess(aID, prio), detailed(0), cull(0), halt(0)
+	ParticleBunchProcess(aID, prio), detailed(0), cull(0), halt(0), scan_every_step(0),
+	amplitude_limit(std::numeric_limits<double>::infinity())
 {
 	active = true;
 }
@@ -22,17 +24,30 @@ NANCheckProcess::NANCheckProcess(const string& aID, int prio) :
 void NANCheckProcess::InitialiseProcess(Bunch& bunch)
 {
 	ParticleBunchProcess::InitialiseProcess(bunch);
+	if(currentBunch)
+	{
+		currentBunch->SetAmplitudeLimit(amplitude_limit);
+		currentBunch->ClearTrackingFlags();
+	}
 }
 
-static bool is_good(const PSvector &p)
+bool NANCheckProcess::IsGood(const PSvector &p) const
 {
 	return std::isfinite(p.x()) && std::isfinite(p.y()) && std::isfinite(p.ct()) && std::isfinite(p.xp()) &&
-		   std::isfinite(p.yp()) && std::isfinite(p.dp());
+		   std::isfinite(p.yp()) && std::isfinite(p.dp()) && std::fabs(p.x()) <= amplitude_limit &&
+		   std::fabs(p.y()) <= amplitude_limit;
 }
 
 void NANCheckProcess::DoProcess(const double ds)
 {
-	ParticleBunch::iterator p;
+	const int flags = currentBunch->GetTrackingFlags();
+	currentBunch->ClearTrackingFlags();
+	if(!scan_every_step && (flags & ParticleBunch::checked)
+		&& !(flags & (ParticleBunch::nonFinite | ParticleBunch::overAmplitude)))
+	{
+		return;
+	}
+
 	size_t count = 0;
 	bool do_cull = 0;
 	for(auto &p : *currentBunch)
@@ -41,9 +56,10 @@ void NANCheckProcess::DoProcess(const double ds)
 		{
 			continue;
 		}
-		if(!is_good(p))
+		if(!IsGood(p))
 		{
-			std::cout << "NAN entry found in currentBunch[" << count << "], p.id = " << p.id() << ", at "
+			std::cout << (currentBunch->CheckParticle(p) & ParticleBunch::nonFinite ? "NAN" : "Over-amplitude")
+					  << " entry found in currentBunch[" << count << "], p.id = " << p.id() << ", at "
 					  << currentComponent->GetQualifiedName() << std::endl;
 			Report(p.id());
 			reported.insert(p.id());
@@ -98,7 +114,7 @@ void NANCheckProcess::DoCull()
 	NewBunch->reserve(currentBunch->size());
 	for(auto &p : *currentBunch)
 	{
-		if(is_good(p))
+		if(IsGood(p))
 		{
 			NewBunch->AddParticle(p);
 		}
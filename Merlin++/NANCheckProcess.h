@@ -32,6 +32,17 @@ namespace ParticleTracking
  *
  * halt: stops the simulation when an invalid particle is found.
  *
+ * The bunch is not scanned after every step. The TRANSPORT and SYMPLECTIC
+ * tracking maps test each particle as they apply the map and set the
+ * tracking flags of the bunch (see ParticleBunch::GetTrackingFlags()), and
+ * the bunch is only scanned in a step where a flag is set, or where no
+ * flagging map was applied. A NAN created outside the maps (by another
+ * process) is therefore caught at the next map, and may be reported one
+ * element late. SetScanEveryStep() restores the full scan after every step.
+ *
+ * With an amplitude limit set, particles beyond it in x or y are treated
+ * in the same way as particles with invalid coordinates.
+ *
  */
 class NANCheckProcess: public ParticleBunchProcess
 {
@@ -58,10 +69,24 @@ public:
 	{
 		halt = enable;
 	}
+	/// Scan the bunch after every step, not only when flagged by the tracking maps
+	void SetScanEveryStep(bool enable = true)
+	{
+		scan_every_step = enable;
+	}
+	/// Treat particles with |x| or |y| above a as invalid
+	void SetAmplitudeLimit(double a)
+	{
+		amplitude_limit = a;
+	}
 private:
 	bool detailed;
 	bool cull;
 	bool halt;
+	bool scan_every_step;
+	double amplitude_limit;
+
+	bool IsGood(const PSvector& p) const;
 
 	void Report(int id) const;
 	void DoCull();
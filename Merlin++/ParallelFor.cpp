@@ -0,0 +1,42 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include <algorithm>
+
+#include "ParallelFor.h"
+
+namespace
+{
+
+thread_local bool inParallelLoop = false;
+
+} // end anonymous namespace
+
+size_t ParallelThreads(size_t nthreads)
+{
+	if(nthreads != 0)
+	{
+		return nthreads;
+	}
+	return inParallelLoop ? 1 : std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool InParallelLoop()
+{
+	return inParallelLoop;
+}
+
+ParallelLoopScope::ParallelLoopScope(bool active) :
+	outer(inParallelLoop)
+{
+	inParallelLoop = outer || active;
+}
+
+ParallelLoopScope::~ParallelLoopScope()
+{
+	inParallelLoop = outer;
+}
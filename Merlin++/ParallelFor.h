@@ -0,0 +1,119 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef _h_ParallelFor
+#define _h_ParallelFor
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *	Number of threads to use when nthreads are asked for. A non-zero
+ *	nthreads is used as given. 0 gives one thread per hardware thread,
+ *	except on a thread already running the body of a parallel loop, where
+ *	it gives 1, so that nested parallel code (e.g. a blocked SVD in a
+ *	steering job in a seed ensemble) does not oversubscribe the machine.
+ */
+size_t ParallelThreads(size_t nthreads);
+
+/**
+ *	True on a thread running the body of a ParallelFor() or
+ *	ParallelRanges() loop.
+ */
+bool InParallelLoop();
+
+/**
+ *	Marks the calling thread as running a parallel loop body for its
+ *	lifetime, if active.
+ */
+class ParallelLoopScope
+{
+public:
+	explicit ParallelLoopScope(bool active = true);
+	~ParallelLoopScope();
+
+private:
+	bool outer;
+};
+
+/**
+ *	Calls f(i) for each i in [0, count) on up to ParallelThreads(nthreads)
+ *	threads, the calling thread being one of them. Each thread takes the
+ *	next index as it finishes one. If calls throw, the remaining indices
+ *	are still done, and the exception of the lowest index is rethrown.
+ *	A loop that runs on one thread only does not count as parallel for
+ *	ParallelThreads().
+ */
+template<class F>
+void ParallelFor(size_t count, size_t nthreads, F f)
+{
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	size_t errorIndex = count;
+	std::mutex errorLock;
+	const size_t nt = std::min(ParallelThreads(nthreads), count);
+
+	auto worker = [&]()
+		{
+			ParallelLoopScope scope(nt > 1);
+			for(size_t i = next++; i < count; i = next++)
+			{
+				try
+				{
+					f(i);
+				}
+				catch(...)
+				{
+					std::lock_guard<std::mutex> lock(errorLock);
+					if(i < errorIndex)
+					{
+						error = std::current_exception();
+						errorIndex = i;
+					}
+				}
+			}
+		};
+
+	std::vector<std::thread> pool;
+	for(size_t t = 1; t < nt; t++)
+	{
+		pool.push_back(std::thread(worker));
+	}
+	worker();
+	for(size_t t = 0; t < pool.size(); t++)
+	{
+		pool[t].join();
+	}
+
+	if(error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+/**
+ *	Calls f(i0, i1) on contiguous ranges covering [0, n), one range for
+ *	each of min(ParallelThreads(nthreads), parts) threads, the first range
+ *	on the calling thread. parts bounds the number of ranges for work too
+ *	small to be worth many threads.
+ */
+template<class F>
+void ParallelRanges(size_t n, size_t nthreads, size_t parts, F f)
+{
+	size_t nt = std::max<size_t>(1, std::min(ParallelThreads(nthreads), parts));
+	ParallelFor(nt, nt, [&](size_t t)
+		{
+			f(n * t / nt, n * (t + 1) / nt);
+		});
+}
+
+#endif
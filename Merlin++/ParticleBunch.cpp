@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include "Transform3D.h"
 #include "PSvectorTransform3D.h"
 #include "ParticleBunch.h"
@@ -139,13 +140,14 @@ namespace ParticleTracking
 
 ParticleBunch::ParticleBunch(double P0, double Q, PSvectorArray& particles) :
 	Bunch(P0, Q), init(false), coords((int) sizeof(PSvector) / sizeof(double)), qPerMP(Q
-		/ particles.size()), pArray()
+		/ particles.size()), trackingFlags(0), amplitudeLimit(std::numeric_limits<double>::infinity()), pArray()
 {
 	pArray.swap(particles);
 }
 
 ParticleBunch::ParticleBunch(double P0, double Q, std::istream& is) :
-	Bunch(P0, Q), init(false), coords((int) sizeof(PSvector) / sizeof(double))
+	Bunch(P0, Q), init(false), coords((int) sizeof(PSvector) / sizeof(double)), trackingFlags(0),
+	amplitudeLimit(std::numeric_limits<double>::infinity())
 {
 	PSvector p;
 	while(is >> p)
@@ -157,7 +159,8 @@ ParticleBunch::ParticleBunch(double P0, double Q, std::istream& is) :
 }
 
 ParticleBunch::ParticleBunch(double P0, double Qm) :
-	Bunch(P0, Qm), init(false), coords((int) sizeof(PSvector) / sizeof(double)), qPerMP(Qm)
+	Bunch(P0, Qm), init(false), coords((int) sizeof(PSvector) / sizeof(double)), qPerMP(Qm), trackingFlags(0),
+	amplitudeLimit(std::numeric_limits<double>::infinity())
 {
 }
 
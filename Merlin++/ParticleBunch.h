@@ -9,6 +9,7 @@
 #define ParticleBunch_h 1
 
 #include "merlin_config.h"
+#include <cmath>
 #include "PSTypes.h"
 #include "Bunch.h"
 
@@ -186,6 +187,63 @@ public:
 	 */
 	void swap(ParticleBunch newbunch);
 
+	/**
+	 *	Tracking flags, accumulated by the tracking maps as a by-product
+	 *	of applying them (see ApplyToBunch()). nonFinite is set when a
+	 *	particle leaves a map with a non-finite coordinate, overAmplitude
+	 *	when |x| or |y| is beyond the amplitude limit, and checked when
+	 *	any map has been applied since the flags were last cleared.
+	 */
+	enum
+	{
+		nonFinite = 1,
+		overAmplitude = 2,
+		checked = 4
+	};
+
+	int GetTrackingFlags() const
+	{
+		return trackingFlags;
+	}
+
+	void ClearTrackingFlags()
+	{
+		trackingFlags = 0;
+	}
+
+	void AddTrackingFlags(int flags)
+	{
+		trackingFlags |= flags | checked;
+	}
+
+	/**
+	 *	Amplitude in x and y beyond which the tracking maps set the
+	 *	overAmplitude flag (infinite by default).
+	 */
+	void SetAmplitudeLimit(double a)
+	{
+		amplitudeLimit = a;
+	}
+
+	double GetAmplitudeLimit() const
+	{
+		return amplitudeLimit;
+	}
+
+	/**
+	 *	The flags (nonFinite, overAmplitude) of a single particle. A single
+	 *	test of the sum of the coordinates catches any non-finite one.
+	 */
+	int CheckParticle(const Particle& p) const
+	{
+		int flags = std::isfinite(p.x() + p.xp() + p.y() + p.yp() + p.ct() + p.dp()) ? 0 : nonFinite;
+		if(std::fabs(p.x()) > amplitudeLimit || std::fabs(p.y()) > amplitudeLimit)
+		{
+			flags |= overAmplitude;
+		}
+		return flags;
+	}
+
 	/**
 	 * Init flag
 	 */
@@ -311,6 +369,9 @@ private:
 	 */
 	double qPerMP;
 
+	int trackingFlags;
+	double amplitudeLimit;
+
 protected:
 
 	PSvectorArray pArray;
@@ -400,6 +461,22 @@ inline void ParticleBunch::clear()
 	pArray.clear();
 }
 
+/**
+ *	Apply the functor m to every particle of the bunch, and add the
+ *	tracking flags of the results to the bunch.
+ */
+template<class M>
+inline void ApplyToBunch(ParticleBunch& bunch, M m)
+{
+	int flags = 0;
+	for(ParticleBunch::iterator p = bunch.begin(); p != bunch.end(); p++)
+	{
+		m(*p);
+		flags |= bunch.CheckParticle(*p);
+	}
+	bunch.AddTrackingFlags(flags);
+}
+
 } // end namespace ParticleTracking
 
 #endif
@@ -37,9 +37,51 @@ namespace
 
 double Ran1()
 {
-	static auto gen = RandomNG::getLocalGenerator(hash_string("PhotonSpectrumGen"));
-	static auto dist = std::uniform_real_distribution<>{0.0, 1.0};
-	return dist(gen);
+	// the generator itself is held per thread by RandomNG
+	static const size_t name_hash = hash_string("PhotonSpectrumGen");
+	std::uniform_real_distribution<> dist{0.0, 1.0};
+	return dist(RandomNG::getLocalGenerator(name_hash));
+}
+
+/**
+ * Constants of the approximate spectra used by SynGenC for a given xmin
+ */
+struct SynGenConstants
+{
+	double a1, a2, c1, xlow, ratio;
+
+	explicit SynGenConstants(double xmin);
+};
+
+SynGenConstants::SynGenConstants(double xmin)
+{
+	if(xmin > 1.)
+	{
+		xlow = xmin;
+	}
+	else
+	{
+		xlow = 1.;
+	}
+
+	// initialize constants used in the approximate expressions
+	// for SYNRAD   (integral over the modified Bessel function K5/3)
+	a1 = SynRadC(1.e-38) / pow(1.e-38, -2. / 3.); // = 2**2/3 GAMMA(2/3)
+	a2 = SynRadC(xlow) / exp(-xlow);
+	c1 = pow(xmin, 1. / 3.);
+	// calculate the integrals of the approximate expressions
+	if(xmin < 1.)   // low and high approx needed
+	{
+		double sum1ap = 3. * a1 * (1. - pow(xmin, 1. / 3.)); //     integral xmin --> 1
+		double sum2ap = a2 * exp(-1.);                    //     integral 1 --> infin
+		ratio = sum1ap / (sum1ap + sum2ap);
+	}
+	else  // only high approx needed
+	{
+		ratio = 0.;     //     generate only high energies using approx. 2
+
+		a2 = SynRadC(xlow) / exp(-xlow);
+	}
 }
 
 /**
@@ -61,41 +103,11 @@ double Ran1()
 
 double SynGenC(double xmin)
 {
-	static bool DoInit = true;
-	static double a1, a2, c1, xlow, ratio, LastXmin = -1.;
-
-	if(DoInit || xmin != LastXmin)
-	{
-		DoInit = false;
-		LastXmin = xmin;
-		if(xmin > 1.)
-		{
-			xlow = xmin;
-		}
-		else
-		{
-			xlow = 1.;
-		}
-
-		// initialize constants used in the approximate expressions
-		// for SYNRAD   (integral over the modified Bessel function K5/3)
-		a1 = SynRadC(1.e-38) / pow(1.e-38, -2. / 3.); // = 2**2/3 GAMMA(2/3)
-		a2 = SynRadC(xlow) / exp(-xlow);
-		c1 = pow(xmin, 1. / 3.);
-		// calculate the integrals of the approximate expressions
-		if(xmin < 1.)   // low and high approx needed
-		{
-			double sum1ap = 3. * a1 * (1. - pow(xmin, 1. / 3.)); //     integral xmin --> 1
-			double sum2ap = a2 * exp(-1.);                    //     integral 1 --> infin
-			ratio = sum1ap / (sum1ap + sum2ap);
-		}
-		else  // only high approx needed
-		{
-			ratio = 0.;     //     generate only high energies using approx. 2
+	// HBSpectrumGen always asks for xmin = 0, so those constants are only found once
+	static const SynGenConstants c0(0.);
+	const SynGenConstants c = xmin == 0. ? c0 : SynGenConstants(xmin);
+	const double a1 = c.a1, a2 = c.a2, c1 = c.c1, xlow = c.xlow, ratio = c.ratio;
 
-			a2 = SynRadC(xlow) / exp(-xlow);
-		}
-	}
 	// Init done, now generate
 	double appr, exact, result;
 	do
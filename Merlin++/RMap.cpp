@@ -36,14 +36,14 @@ void RMap::MatrixForm(std::ostream& os) const
 	ToMatrix(R, false);
 	::MatrixForm(R, os);
 }
-/*
-   PSvector& RMap::Apply(PSvector& X) const
-   {
-    PSvector Y(0);
-    Apply(X,Y);
-    return X=Y;
-   }
- */
+
+PSvector& RMap::Apply(PSvector& X) const
+{
+	PSvector Y(0);
+	Apply(X, Y);
+	return X = Y;
+}
+
 void RMap::Apply(const PSvector& orig, PSvector& result) const
 {
 	for(const_itor r = rterms.begin(); r != rterms.end(); r++)
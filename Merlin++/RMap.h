@@ -17,6 +17,7 @@
 #define RMap_h 1
 
 #include "merlin_config.h"
+#include <algorithm>
 #include "PSTypes.h"
 #include "LinearAlgebra.h"
 #include "utils.h"
@@ -66,6 +67,16 @@ public:
 		{
 			last = array;
 		}
+		// last points into array, so it is rebased on copying
+		LinearTermArray(const LinearTermArray& rhs)
+		{
+			*this = rhs;
+		}
+		LinearTermArray& operator=(const LinearTermArray& rhs)
+		{
+			last = std::copy(rhs.begin(), rhs.end(), array);
+			return *this;
+		}
 		void push_back(const Rij& r)
 		{
 			*last = r;
@@ -0,0 +1,380 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "RadiationIntegrals.h"
+#include "ParallelFor.h"
+#include "ParticleBunch.h"
+#include "ParticleTracker.h"
+#include "TransferMatrix.h"
+#include "SectorBend.h"
+#include "PhysicalConstants.h"
+#include "PhysicalUnits.h"
+#include "MerlinException.h"
+
+using namespace std;
+using namespace PhysicalConstants;
+using namespace PhysicalUnits;
+using namespace ParticleTracking;
+
+namespace
+{
+
+// 8 point Gauss-Legendre rule on [-1, 1]; exact to rounding for the
+// smooth integrands below over a bend with phase advance below ~1
+const int ngauss = 8;
+const double gaussX[ngauss] =
+{
+	-0.9602898564975363, -0.7966664774136267, -0.5255324099163290, -0.1834346424956498,
+	0.1834346424956498, 0.5255324099163290, 0.7966664774136267, 0.9602898564975363
+};
+const double gaussW[ngauss] =
+{
+	0.1012285362903763, 0.2223810344533745, 0.3137066458778873, 0.3626837833783620,
+	0.3626837833783620, 0.3137066458778873, 0.2223810344533745, 0.1012285362903763
+};
+
+// Horizontal transfer functions at s of a bend with focusing t = h^2 + k1:
+// x(s) = C x0 + S x0' + h F2 dp, and F3 = (s - S)/t is the integral of F2
+struct BendFunctions
+{
+	double C, S, F2, F3;
+
+	BendFunctions(double t, double s)
+	{
+		const double u = t * s * s;
+		if(u > 0)
+		{
+			const double r = sqrt(t);
+			const double sh = sin(r * s / 2);
+			C = cos(r * s);
+			S = sin(r * s) / r;
+			F2 = 2 * sh * sh / t;
+		}
+		else if(u < 0)
+		{
+			const double r = sqrt(-t);
+			const double sh = sinh(r * s / 2);
+			C = cosh(r * s);
+			S = sinh(r * s) / r;
+			F2 = -2 * sh * sh / t;
+		}
+		else
+		{
+			C = 1;
+			S = s;
+			F2 = s * s / 2;
+		}
+
+		// (s - S)/t cancels badly for weak focusing, so use its series
+		if(fabs(u) < 0.1)
+		{
+			double term = s * s * s / 6;
+			F3 = 0;
+			for(int n = 0; n < 8; n++)
+			{
+				F3 += term;
+				term *= -u / ((2 * n + 4) * (2 * n + 5));
+			}
+		}
+		else
+		{
+			F3 = (s - S) / t;
+		}
+	}
+};
+
+} // end anonymous namespace
+
+RadiationIntegrals::RadiationIntegrals(AcceleratorModel* aModel, double refMomentum) :
+	theModel(aModel), p0(refMomentum), beta0(0), alpha0(0), eta0(0), etap0(0)
+{
+	for(int n = 0; n < 5; n++)
+	{
+		integral[n] = 0;
+	}
+	for(int k = 0; k < 3; k++)
+	{
+		modeIntegral[k] = 0;
+		modePlane[k] = k;
+	}
+}
+
+void RadiationIntegrals::Calculate(size_t nthreads)
+{
+	for(int n = 0; n < 5; n++)
+	{
+		integral[n] = 0;
+	}
+	for(int k = 0; k < 3; k++)
+	{
+		modeIntegral[k] = 0;
+		modePlane[k] = k;
+	}
+
+	TransferMatrix tm(theModel, p0);
+	RealMatrix M(6);
+	PSvector orbit(0);
+	tm.FindClosedOrbitTM(M, orbit);
+
+	// Periodic horizontal lattice functions
+	const double cosMu = (M(0, 0) + M(1, 1)) / 2;
+	if(fabs(cosMu) >= 1)
+	{
+		throw MerlinException("RadiationIntegrals::Calculate: horizontal motion is not stable");
+	}
+	const double sinMu = (M(0, 1) > 0 ? 1 : -1) * sqrt(1 - cosMu * cosMu);
+	beta0 = M(0, 1) / sinMu;
+	alpha0 = (M(0, 0) - M(1, 1)) / (2 * sinMu);
+
+	const double det = (1 - M(0, 0)) * (1 - M(1, 1)) - M(0, 1) * M(1, 0);
+	eta0 = ((1 - M(1, 1)) * M(0, 5) + M(0, 1) * M(1, 5)) / det;
+	etap0 = ((1 - M(0, 0)) * M(1, 5) + M(1, 0) * M(0, 5)) / det;
+
+	// The eigenmodes need stable motion in all three planes, so without
+	// an RF cavity the mode integrals are left at zero
+	ComplexVector eigenvalues(3);
+	ComplexMatrix eigenvectors(3, 6);
+	bool stable = true;
+	for(int pln = 0; pln < 3; pln++)
+	{
+		stable = stable && fabs(M(2 * pln, 2 * pln) + M(2 * pln + 1, 2 * pln + 1)) < 2;
+	}
+	if(stable)
+	{
+		RealMatrix S(M);
+		CorrectR53R54(S);
+		Symplectify(S);
+		EigenSystem(S, eigenvalues, eigenvectors);
+
+		for(int k = 0; k < 3; k++)
+		{
+			modePlane[k] = EigenmodePlane(eigenvectors, k);
+		}
+	}
+	else
+	{
+		eigenvectors.redim(3, 6);
+		eigenvectors = 0;
+	}
+
+	// Closed orbit at the entrance of each element
+	vector<PSvector> orbits;
+	ParticleBunch bunch(p0, 1.0);
+	bunch.push_back(orbit);
+	ParticleTracker tracker(theModel->GetBeamline(), &bunch);
+	tracker.InitStepper();
+	do
+	{
+		if(tracker.GetTrackedBunch().size() == 0)
+		{
+			throw MerlinException("RadiationIntegrals::Calculate: closed orbit lost before element "
+				+ to_string(orbits.size()));
+		}
+		orbits.push_back(tracker.GetTrackedBunch().GetParticles().front());
+	} while(tracker.StepComponent());
+
+	FindElementMatrices(orbits, nthreads);
+
+	Optics optics;
+	optics.beta = beta0;
+	optics.alpha = alpha0;
+	optics.eta = eta0;
+	optics.etap = etap0;
+
+	AcceleratorModel::Beamline bl = theModel->GetBeamline();
+	AcceleratorModel::BeamlineIterator frame = bl.begin();
+	for(size_t n = 0; n < matrices.size(); n++, frame++)
+	{
+		const SectorBend* sb = dynamic_cast<const SectorBend*>(&(*frame)->GetComponent());
+		if(sb && sb->GetB0())
+		{
+			AddBend(sb, optics, eigenvectors);
+		}
+
+		const RealMatrix& R = matrices[n];
+		const double gamma = (1 + optics.alpha * optics.alpha) / optics.beta;
+		Optics out;
+		out.beta = R(0, 0) * R(0, 0) * optics.beta - 2 * R(0, 0) * R(0, 1) * optics.alpha + R(0, 1) * R(0, 1) * gamma;
+		out.alpha = -R(0, 0) * R(1, 0) * optics.beta + (R(0, 0) * R(1, 1) + R(0, 1) * R(1, 0)) * optics.alpha
+			- R(0, 1) * R(1, 1) * gamma;
+		out.eta = R(0, 0) * optics.eta + R(0, 1) * optics.etap + R(0, 5);
+		out.etap = R(1, 0) * optics.eta + R(1, 1) * optics.etap + R(1, 5);
+		optics = out;
+
+		for(int k = 0; k < 3; k++)
+		{
+			Complex e[6];
+			for(int i = 0; i < 6; i++)
+			{
+				e[i] = 0;
+				for(int j = 0; j < 6; j++)
+				{
+					e[i] += R(i, j) * eigenvectors(k, j);
+				}
+			}
+			for(int i = 0; i < 6; i++)
+			{
+				eigenvectors(k, i) = e[i];
+			}
+		}
+	}
+}
+
+void RadiationIntegrals::FindElementMatrices(const vector<PSvector>& orbits, size_t nthreads)
+{
+	matrices.assign(orbits.size(), RealMatrix(6));
+
+	// Each thread tracks through its own elements with its own TransferMatrix
+	ParallelFor(orbits.size(), nthreads, [this, &orbits](size_t n)
+	{
+		TransferMatrix tm(theModel, p0);
+		PSvector orbit = orbits[n];
+		tm.FindTM(matrices[n], orbit, n, n);
+	});
+}
+
+void RadiationIntegrals::AddBend(const SectorBend* sb, const Optics& in, const ComplexMatrix& ev)
+{
+	const double h = sb->GetB0() * eV * SpeedOfLight / p0;
+	const double k1 = sb->GetB1() * eV * SpeedOfLight / p0;
+	const double t = h * h + k1;
+	const double len = sb->GetLength();
+	const double h2 = h * h;
+	const double h3 = fabs(h * h2);
+
+	const SectorBend::PoleFaceInfo& pfi = sb->GetPoleFaceInfo();
+	const double tanE1 = pfi.entrance ? tan(pfi.entrance->rot) : 0.0;
+	const double tanE2 = pfi.exit ? tan(pfi.exit->rot) : 0.0;
+
+	// Lattice functions after the entrance pole face
+	const double beta = in.beta;
+	const double alpha = in.alpha - h * tanE1 * in.beta;
+	const double gamma = (1 + alpha * alpha) / beta;
+	const double eta = in.eta;
+	const double etap = in.etap + h * tanE1 * in.eta;
+
+	// The integral of the dispersion over the body, and the dispersion at its exit
+	const BendFunctions fl(t, len);
+	const double intEta = eta * fl.S + etap * fl.F2 + h * fl.F3;
+	const double etaOut = eta * fl.C + etap * fl.S + h * fl.F2;
+
+	integral[0] += h * intEta;
+	integral[1] += h2 * len;
+	integral[2] += h3 * len;
+	integral[3] += h * (h2 + 2 * k1) * intEta - h2 * (tanE1 * eta + tanE2 * etaOut);
+
+	// H and the longitudinal components of the eigenvectors are quadratic
+	// in the transfer functions, and are integrated by Gauss-Legendre
+	double intH = 0;
+	double intE5[3] = {0, 0, 0};
+	for(int g = 0; g < ngauss; g++)
+	{
+		const double s = len * (1 + gaussX[g]) / 2;
+		const double w = len * gaussW[g] / 2;
+		const BendFunctions f(t, s);
+
+		const double b = f.C * f.C * beta - 2 * f.C * f.S * alpha + f.S * f.S * gamma;
+		const double a = t * f.S * f.C * beta + (f.C * f.C - t * f.S * f.S) * alpha - f.S * f.C * gamma;
+		const double d = f.C * eta + f.S * etap + h * f.F2;
+		const double dp = -t * f.S * eta + f.C * etap + h * f.S;
+		intH += w * ((1 + a * a) / b * d * d + 2 * a * d * dp + b * dp * dp);
+
+		for(int k = 0; k < 3; k++)
+		{
+			const Complex e1 = ev(k, 1) + h * tanE1 * ev(k, 0);
+			const Complex e5 = ev(k, 4) - h * (f.S * ev(k, 0) + f.F2 * e1 + h * f.F3 * ev(k, 5));
+			intE5[k] += w * norm(e5);
+		}
+	}
+
+	integral[4] += h3 * intH;
+	for(int k = 0; k < 3; k++)
+	{
+		modeIntegral[k] += h3 * intE5[k];
+	}
+}
+
+double RadiationIntegrals::I(int n) const
+{
+	if(n < 1 || n > 5)
+	{
+		throw MerlinException("RadiationIntegrals::I: the integrals are I1 to I5");
+	}
+	return integral[n - 1];
+}
+
+double RadiationIntegrals::DampingPartition(int n) const
+{
+	const double d = integral[3] / integral[1];
+	return n == 0 ? 1 - d : (n == 1 ? 1 : 2 + d);
+}
+
+double RadiationIntegrals::EnergyLoss() const
+{
+	const double m = ElectronMassMeV * MeV;
+	const double gamma = sqrt(1 + pow(p0 / m, 2));
+	return 2 * ElectronRadius * pow(gamma, 4) * m * integral[1] / 3;
+}
+
+double RadiationIntegrals::DampingConstant(int n) const
+{
+	const double energy = sqrt(p0 * p0 + pow(ElectronMassMeV * MeV, 2));
+	return DampingPartition(n) * EnergyLoss() / (2 * energy);
+}
+
+void RadiationIntegrals::CorrectR53R54(RealMatrix& M)
+{
+	M(4, 2) = -(-M(2, 2) * M(3, 1) * M(4, 0) + M(2, 1) * M(3, 2) * M(4, 0)
+		+ M(2, 2) * M(3, 0) * M(4, 1) - M(2, 0) * M(3, 2) * M(4, 1)
+		+ M(2, 5) * M(3, 2) * M(4, 4) - M(2, 2) * M(3, 5) * M(4, 4)
+		- M(2, 4) * M(3, 2) * M(4, 5) + M(2, 2) * M(3, 4) * M(4, 5))
+		/ (M(2, 3) * M(3, 2) - M(2, 2) * M(3, 3));
+
+	M(4, 3) = (-M(3, 3) * M(2, 1) * M(4, 0) + M(3, 3) * M(2, 0) * M(4, 1)
+		- M(3, 3) * M(2, 5) * M(4, 4) + M(3, 3) * M(2, 4) * M(4, 5)
+		+ M(2, 3) * M(3, 1) * M(4, 0) - M(2, 3) * M(3, 0) * M(4, 1)
+		+ M(2, 3) * M(3, 5) * M(4, 4) - M(2, 3) * M(3, 4) * M(4, 5))
+		/ (M(2, 3) * M(3, 2) - M(2, 2) * M(3, 3));
+}
+
+int RadiationIntegrals::EigenmodePlane(const ComplexMatrix& eigenvectors, int k)
+{
+	int plane = k;
+	double largest = 0;
+	for(int pln = 0; pln < 3; pln++)
+	{
+		double a = norm(eigenvectors(k, 2 * pln)) + norm(eigenvectors(k, 2 * pln + 1));
+		if(a > largest)
+		{
+			largest = a;
+			plane = pln;
+		}
+	}
+	return plane;
+}
+
+double RadiationIntegrals::Emittance() const
+{
+	const double Cq = 55 * PlanckConstantBar / (32 * sqrt(3.0) * ElectronMass * SpeedOfLight);
+	const double gamma = sqrt(1 + pow(p0 / (ElectronMassMeV * MeV), 2));
+	return Cq * gamma * gamma * integral[4] / (DampingPartition(0) * integral[1]);
+}
+
+double RadiationIntegrals::EnergySpread() const
+{
+	const double Cq = 55 * PlanckConstantBar / (32 * sqrt(3.0) * ElectronMass * SpeedOfLight);
+	const double gamma = sqrt(1 + pow(p0 / (ElectronMassMeV * MeV), 2));
+	return sqrt(Cq * gamma * gamma * integral[2] / (DampingPartition(2) * integral[1]));
+}
+
+double RadiationIntegrals::MomentumCompaction() const
+{
+	return integral[0] / theModel->GetGlobalFrame().GetGeometryLength();
+}
@@ -0,0 +1,183 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef RadiationIntegrals_h
+#define RadiationIntegrals_h 1
+
+#include "merlin_config.h"
+#include <vector>
+
+#include "AcceleratorModel.h"
+#include "LinearAlgebra.h"
+#include "PSvector.h"
+
+class SectorBend;
+
+/**
+ *	Synchrotron radiation integrals of an electron storage ring,
+ *	from a single sweep of the linear optics around the closed
+ *	orbit.
+ *
+ *	The transfer matrix of each element about the closed orbit is
+ *	found by tracking, with the elements shared out between threads.
+ *	The periodic lattice functions of the one-turn matrix are then
+ *	carried through the element matrices, and each SectorBend adds
+ *	its contribution in closed form from the lattice functions at
+ *	its entrance, including the quadrupole gradient of combined
+ *	function bends and the pole face rotations. Quadrupoles and
+ *	other elements without bending only transport the optics.
+ *
+ *	Two sets of integrals are found:
+ *	- I1 to I5 of the horizontal plane, assuming no coupling
+ *	- for the three eigenmodes of the one-turn matrix,
+ *	  \f$\oint |h|^3 |E_{k5}|^2 ds\f$ with E_k the eigenvector,
+ *	  which give the emittances of a coupled lattice by Chao's
+ *	  method (see EquilibriumDistribution).
+ *
+ * 	RadiationIntegrals ri(model, p0);
+ * 	ri.Calculate();
+ * 	double ex = ri.Emittance();
+ */
+class RadiationIntegrals
+{
+public:
+
+	RadiationIntegrals(AcceleratorModel* aModel, double refMomentum);
+
+	/**
+	 *	Find the integrals, using nthreads threads for the element
+	 *	matrices (0 for ParallelThreads(0): one per hardware thread,
+	 *	or one within another parallel loop).
+	 */
+	void Calculate(size_t nthreads = 0);
+
+	/**
+	 *	Horizontal radiation integral In, n = 1 to 5
+	 */
+	double I(int n) const;
+
+	/**
+	 *	\f$\oint |h|^3 |E_{k5}|^2 ds\f$ for eigenmode k, in the order
+	 *	given by EigenSystem() for the one-turn matrix
+	 */
+	double ModeIntegral(int k) const
+	{
+		return modeIntegral[k];
+	}
+
+	/**
+	 *	Plane (0 x, 1 y, 2 z) in which eigenmode k has the larger
+	 *	part of its eigenvector
+	 */
+	int ModePlane(int k) const
+	{
+		return modePlane[k];
+	}
+
+	/**
+	 *	Damping partition number for plane n = 0 (x), 1 (y), 2 (z)
+	 */
+	double DampingPartition(int n) const;
+
+	/**
+	 *	Energy radiated per turn by the reference particle
+	 */
+	double EnergyLoss() const;
+
+	/**
+	 *	Amplitude damping per turn for plane n = 0 (x), 1 (y), 2 (z)
+	 */
+	double DampingConstant(int n) const;
+
+	/**
+	 *	Amplitude damping per turn of eigenmode k, that of its plane
+	 */
+	double ModeDampingConstant(int k) const
+	{
+		return DampingConstant(modePlane[k]);
+	}
+
+	/**
+	 *	Replaces the R53 and R54 terms of the one-turn matrix M by the
+	 *	values that make it symplectic, as tracking does not find them
+	 *	correctly for a distorted closed orbit.
+	 */
+	static void CorrectR53R54(RealMatrix& M);
+
+	/**
+	 *	Plane in which row k of the eigenvectors from EigenSystem() has
+	 *	the larger part of its amplitude
+	 */
+	static int EigenmodePlane(const ComplexMatrix& eigenvectors, int k);
+
+	/**
+	 *	Natural horizontal emittance
+	 */
+	double Emittance() const;
+
+	/**
+	 *	Equilibrium rms relative energy spread
+	 */
+	double EnergySpread() const;
+
+	/**
+	 *	Momentum compaction factor, I1 over the lattice length
+	 */
+	double MomentumCompaction() const;
+
+	/**
+	 *	Periodic lattice functions at the start of the lattice
+	 */
+	double BetaX() const
+	{
+		return beta0;
+	}
+	double AlphaX() const
+	{
+		return alpha0;
+	}
+	double DispersionX() const
+	{
+		return eta0;
+	}
+	double DispersionPX() const
+	{
+		return etap0;
+	}
+
+private:
+
+	/**
+	 *	Horizontal lattice functions at a point
+	 */
+	struct Optics
+	{
+		double beta;
+		double alpha;
+		double eta;
+		double etap;
+	};
+
+	void FindElementMatrices(const std::vector<PSvector>& orbit, size_t nthreads);
+	void AddBend(const SectorBend* sb, const Optics& in, const ComplexMatrix& ev);
+
+	AcceleratorModel* theModel;
+	double p0;
+
+	double beta0;
+	double alpha0;
+	double eta0;
+	double etap0;
+
+	double integral[5];
+	double modeIntegral[3];
+	int modePlane[3];
+
+	std::vector<RealMatrix> matrices;
+};
+
+#endif
@@ -8,10 +8,10 @@
 #include "RandomNG.h"
 #include "LandauDistribution.h"
 
-std::vector<std::uint32_t> RandomNG::master_seed;
-std::unique_ptr<std::mt19937_64> RandomNG::generator;
+thread_local std::vector<std::uint32_t> RandomNG::master_seed;
+thread_local std::unique_ptr<std::mt19937_64> RandomNG::generator;
 
-std::unordered_map<size_t, std::mt19937_64> RandomNG::generator_store;
+thread_local std::unordered_map<size_t, std::mt19937_64> RandomNG::generator_store;
 
 void RandomNG::init()
 {
@@ -55,6 +55,34 @@ void RandomNG::reset(const std::vector<std::uint32_t>& iseed)
 	reset();
 }
 
+std::vector<std::uint32_t> RandomNG::streamSeed(const std::vector<std::uint32_t>& seed, std::uint32_t n)
+{
+	std::vector<std::uint32_t> s(seed);
+	s.push_back(n);
+	return s;
+}
+
+RandomNG::ScopedSeed::ScopedSeed(std::uint32_t iseed) :
+	savedSeed(std::move(master_seed)), savedGenerator(std::move(generator)), savedStore(std::move(generator_store))
+{
+	generator_store.clear();
+	init(iseed);
+}
+
+RandomNG::ScopedSeed::ScopedSeed(std::vector<std::uint32_t> iseed) :
+	savedSeed(std::move(master_seed)), savedGenerator(std::move(generator)), savedStore(std::move(generator_store))
+{
+	generator_store.clear();
+	init(iseed);
+}
+
+RandomNG::ScopedSeed::~ScopedSeed()
+{
+	master_seed = std::move(savedSeed);
+	generator = std::move(savedGenerator);
+	generator_store = std::move(savedStore);
+}
+
 const std::vector<std::uint32_t>& RandomNG::getSeed()
 {
 	return master_seed;
@@ -14,6 +14,7 @@
 #include <cstdint>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
 
 /**
  * Singleton class for generating continuous floating point numbers from specific distributions.
@@ -23,6 +24,15 @@
  * * landau
  *
  * Also provides access to the generator for more optimised usage.
+ *
+ * The generator state is held per thread: a thread other than the one that
+ * called init() must call init() itself before drawing numbers. A thread that
+ * draws without doing so is seeded from the system random source, with a
+ * warning, so its numbers do not follow the seed given to the main thread.
+ * Programs that seeded once and then drew from their own threads relied on
+ * the single shared generator this replaced. A thread spawned for part of a
+ * seeded calculation can be seeded reproducibly with streamSeed(), and work
+ * that may run on the caller's own thread with a ScopedSeed.
  */
 
 class RandomNG
@@ -110,11 +120,46 @@ public:
 	/// Reset a given local generator
 	static void resetLocalGenerator(size_t name_hash);
 
+	/**
+	 * Seed of the n-th of several independent streams derived from seed:
+	 * seed with n appended. A thread doing part n of a calculation seeded
+	 * with seed can call init(streamSeed(seed, n)), seed having been read
+	 * with getSeed() on the thread that started it, and draws the same
+	 * numbers whichever thread it is and however many there are.
+	 */
+	static std::vector<std::uint32_t> streamSeed(const std::vector<std::uint32_t>& seed, std::uint32_t n);
+
+	/**
+	 * Seeds the generator of the calling thread for the lifetime of this
+	 * object, and then restores the thread's previous seed, generator and
+	 * local generators. Work run by a pool that includes the calling
+	 * thread (e.g. ParallelFor()) uses this to seed itself without
+	 * disturbing the caller's sequence.
+	 */
+	class ScopedSeed
+	{
+	public:
+		explicit ScopedSeed(std::uint32_t iseed);
+		explicit ScopedSeed(std::vector<std::uint32_t> iseed);
+		~ScopedSeed();
+
+	private:
+		std::vector<std::uint32_t> savedSeed;
+		std::unique_ptr<std::mt19937_64> savedGenerator;
+		std::unordered_map<size_t, std::mt19937_64> savedStore;
+
+		ScopedSeed(const ScopedSeed&) = delete;
+		ScopedSeed& operator=(const ScopedSeed&) = delete;
+	};
+
 private:
-	static std::vector<std::uint32_t> master_seed;
-	static std::unique_ptr<std::mt19937_64> generator;
+	// Each thread has its own seed and generators, so threads must be seeded separately. They are
+	// created empty on each new thread, and a thread drawing numbers without calling init() first
+	// seeds itself from std::random_device in not_seeded(), so that its sequence is not reproducible.
+	static thread_local std::vector<std::uint32_t> master_seed;
+	static thread_local std::unique_ptr<std::mt19937_64> generator;
 
-	static std::unordered_map<size_t, std::mt19937_64> generator_store;
+	static thread_local std::unordered_map<size_t, std::mt19937_64> generator_store;
 
 	static void not_seeded()
 	{
@@ -14,10 +14,10 @@ namespace SMPTracking
 DEF_INTG_SET(SMPComponentTracker, StdISet)
 ADD_INTG(DriftCI)
 ADD_INTG(SectorBendCI)
-ADD_INTG(RectMultipoleCI)
+ct.Register(new RectMultipoleCI(dpBinWidth));
 ADD_INTG(TWRFStructureCI)
 ADD_INTG(MonitorCI)
-ADD_INTG(SolenoidCI)
+ct.Register(new SolenoidCI(dpBinWidth));
 ADD_INTG(MarkerCI)
 END_INTG_SET
 
@@ -23,9 +23,27 @@ namespace SMPTracking
 typedef TBunchCMPTracker<SMPBunch> SMPComponentTracker;
 
 /**
- * Standard integrator set
+ * Standard integrator set.
+ *
+ * The dp dependent maps of quadrupoles and solenoids are by default
+ * shared only by consecutive macro-particles with equal dp, so that the
+ * tracking is exact. Binning is opt-in: with a dpBinWidth w > 0 the
+ * trackers initialised by the set build each map once for each dp bin
+ * of width w, for the dp of the bin centre, which bounds the dp error
+ * of the map by w/2.
+ *
+ * 	tracker->SetIntegratorSet(new SMPTracking::StdISet(1.0e-6));
  */
-DECL_INTG_SET(SMPComponentTracker, StdISet)
+struct StdISet: public SMPComponentTracker::ISetBase
+{
+	explicit StdISet(double w = 0) :
+		dpBinWidth(w)
+	{
+	}
+	void Init(SMPComponentTracker& ct) const;
+
+	double dpBinWidth;
+};
 
 } // end namespace SMPTracking
 
@@ -12,6 +12,8 @@
 #include "PhysicalConstants.h"
 #include "NumericalConstants.h"
 #include "PhysicalUnits.h"
+#include <algorithm>
+#include <cmath>
 
 #define _USE_2x2_ 1
 
@@ -26,6 +28,116 @@ using namespace PhysicalUnits;
 // Support routines and function object classes
 /////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Applies a map which depends on the dp of the macro-particle to the
+ * bunch. F provides the map type, MakeMap(dp, map) and Apply(map, p).
+ * With a dp bin width > 0, the map is built once for each occupied
+ * bin, found from a table indexed by the bin number. Otherwise a map
+ * is only shared by consecutive macro-particles with equal dp.
+ */
+template<class F>
+void ApplyMapByDp(const F& f, SMPBunch& bunch, double dpBinWidth)
+{
+	typedef typename F::map_type map_type;
+	const size_t n = bunch.Size();
+	if(n == 0)
+	{
+		return;
+	}
+
+	if(dpBinWidth > 0)
+	{
+		vector<long> bin(n);
+		long bmin = bin[0] = lround(bunch.Get(0).dp() / dpBinWidth);
+		long bmax = bmin;
+		for(size_t i = 1; i < n; i++)
+		{
+			bin[i] = lround(bunch.Get(i).dp() / dpBinWidth);
+			bmin = min(bmin, bin[i]);
+			bmax = max(bmax, bin[i]);
+		}
+
+		// A sparse spread of bins is left to the exact path
+		if(static_cast<size_t>(bmax - bmin) < 4 * n)
+		{
+			vector<int> index(bmax - bmin + 1, -1);
+			vector<map_type> maps;
+			for(size_t i = 0; i < n; i++)
+			{
+				int& m = index[bin[i] - bmin];
+				if(m < 0)
+				{
+					m = maps.size();
+					maps.push_back(map_type());
+					f.MakeMap(dpBinWidth * bin[i], maps.back());
+				}
+				f.Apply(maps[m], bunch.Get(i));
+			}
+			return;
+		}
+	}
+
+	map_type M;
+	double dp = bunch.Get(0).dp();
+	f.MakeMap(dp, M);
+	for(SMPBunch::iterator p = bunch.begin(); p != bunch.end(); p++)
+	{
+		if(p->dp() != dp)
+		{
+			dp = p->dp();
+			f.MakeMap(dp, M);
+		}
+		f.Apply(M, *p);
+	}
+}
+
+/**
+ * Dense linear map of the transverse coordinates, for maps which
+ * couple x and y. The centroid is mapped by R and the second
+ * moments by R.S.R'; ct and dp are unchanged.
+ */
+struct R4Map
+{
+	double r[4][4];
+
+	// Built from the transverse block of an RMap
+	void Set(const RMap& M)
+	{
+		for(int j = 0; j < 4; j++)
+		{
+			PSvector e(0);
+			e[j] = 1;
+			M.Apply(e);
+			for(int i = 0; i < 4; i++)
+			{
+				r[i][j] = e[i];
+			}
+		}
+	}
+
+	void Apply(SliceMacroParticle& p) const
+	{
+		double x[4];
+		double rs[4][4];
+		for(int i = 0; i < 4; i++)
+		{
+			x[i] = r[i][0] * p[0] + r[i][1] * p[1] + r[i][2] * p[2] + r[i][3] * p[3];
+			for(int j = 0; j < 4; j++)
+			{
+				rs[i][j] = r[i][0] * p(0, j) + r[i][1] * p(1, j) + r[i][2] * p(2, j) + r[i][3] * p(3, j);
+			}
+		}
+		for(int i = 0; i < 4; i++)
+		{
+			p[i] = x[i];
+			for(int j = 0; j <= i; j++)
+			{
+				p(i, j) = rs[i][0] * r[j][0] + rs[i][1] * r[j][1] + rs[i][2] * r[j][2] + rs[i][3] * r[j][3];
+			}
+		}
+	}
+};
+
 struct ThickLens
 {
 
@@ -41,33 +153,49 @@ struct ThickLens
 		}
 	}
 
-	void Apply(SliceMacroParticle& p) const
-	{
-		double ct = p.ct();
-		double dp = p.dp();
 #ifdef _USE_2x2_
+	struct map_type
+	{
 		R2Map Mx, My;
-		TransportRMap::Quadrupole(len, k1 / (1 + dp), Mx);
-		TransportRMap::Quadrupole(len, -k1 / (1 + dp), My);
-		ApplyR2Map(Mx, p, 0);
-		ApplyR2Map(My, p, 1);
-		ApplyR2Map(Mx, p, My);
+	};
+
+	void MakeMap(double dp, map_type& M) const
+	{
+		TransportRMap::Quadrupole(len, k1 / (1 + dp), M.Mx);
+		TransportRMap::Quadrupole(len, -k1 / (1 + dp), M.My);
+	}
+
+	static void ApplyTransverse(const map_type& M, SliceMacroParticle& p)
+	{
+		ApplyR2Map(M.Mx, p, 0);
+		ApplyR2Map(M.My, p, 1);
+		ApplyR2Map(M.Mx, p, M.My);
+	}
 #else
-		RMap M;
+	typedef RMap map_type;
+
+	void MakeMap(double dp, map_type& M) const
+	{
+		M = RMap();
 		TransportRMap::Quadrupole(len, k1 / (1 + dp), M);
+	}
+
+	static void ApplyTransverse(const map_type& M, SliceMacroParticle& p)
+	{
 		M.Apply(p);
+	}
 #endif
+
+	void Apply(const map_type& M, SliceMacroParticle& p) const
+	{
+		double ct = p.ct();
+		double dp = p.dp();
+		ApplyTransverse(M, p);
 		if(hasDipoleKick)
 		{
 			p[ps_XP] += theta_x / (1 + dp);
 			p[ps_YP] += theta_y / (1 + dp);
-#ifdef _USE_2x2_
-			ApplyR2Map(Mx, p, 0);
-			ApplyR2Map(My, p, 1);
-			ApplyR2Map(Mx, p, My);
-#else
-			M.Apply(p);
-#endif
+			ApplyTransverse(M, p);
 		}
 		p.ct() = ct;
 		p.dp() = dp;
@@ -97,11 +225,11 @@ struct ThinLensKick
 		if(k1 != 0)
 		{
 			double k = dpp * k1;
-			RMap M;
-			MakeIdentity(M);
-			M.AddTerm(2, 1) = k;
-			M.AddTerm(4, 3) = -k;
-			M.Apply(p);
+			R2Map Mx(1, 0, k, 1);
+			R2Map My(1, 0, -k, 1);
+			ApplyR2Map(Mx, p, 0);
+			ApplyR2Map(My, p, 1);
+			ApplyR2Map(Mx, p, My);
 		}
 	}
 
@@ -118,10 +246,17 @@ struct ApplySolenoid
 	{
 	}
 
-	void Apply(SliceMacroParticle& p) const
+	typedef R4Map map_type;
+
+	void MakeMap(double dp, map_type& M) const
+	{
+		RMap R;
+		TransportRMap::Solenoid(ds, k / (1 + dp), 0, true, true, R);
+		M.Set(R);
+	}
+
+	void Apply(const map_type& M, SliceMacroParticle& p) const
 	{
-		RMap M;
-		TransportRMap::Solenoid(ds, k / (1 + p.dp()), 0, true, true, M);
 		M.Apply(p);
 	}
 
@@ -188,11 +323,10 @@ struct ApplyTWRFEdgeField
 	void Apply(SliceMacroParticle& x) const
 	{
 		double a = -0.5 * Ez * cos(phi0 - k * x.ct()) / (1 + x.dp());
-		RMap M;
-		MakeIdentity(M);
-		M.AddTerm(2, 1) = a;
-		M.AddTerm(4, 3) = a;
-		M.Apply(x);
+		R2Map M(1, 0, a, 1);
+		ApplyR2Map(M, x, 0);
+		ApplyR2Map(M, x, 1);
+		ApplyR2Map(M, x, M);
 	}
 
 };
@@ -365,7 +499,7 @@ void RectMultipoleCI::TrackStep(double ds)
 	}
 	else
 	{
-		ApplyMap(ThickLens(ds, cK0, K1), *currentBunch);
+		ApplyMapByDp(ThickLens(ds, cK0, K1), *currentBunch, dpBinWidth);
 	}
 
 	if(tilt != 0)
@@ -390,7 +524,7 @@ void SolenoidCI::TrackStep(double ds)
 	}
 	else
 	{
-		ApplyMap(ApplySolenoid(ds, q * Bz / brho), *currentBunch);
+		ApplyMapByDp(ApplySolenoid(ds, q * Bz / brho), *currentBunch, dpBinWidth);
 	}
 	return;
 }
@@ -57,8 +57,19 @@ protected:
 
 class RectMultipoleCI: public SMPComponentTracker::Integrator<RectMultipole>
 {
+public:
+	/**
+	 *	Quadrupole maps are built once for each dp bin of width w,
+	 *	or for each dp if w is 0, see StdISet.
+	 */
+	explicit RectMultipoleCI(double w = 0) :
+		dpBinWidth(w)
+	{
+	}
 protected:
 	void TrackStep(double ds);
+private:
+	double dpBinWidth;
 };
 
 class MonitorCI: public SMPComponentTracker::Integrator<Monitor>
@@ -75,8 +86,19 @@ protected:
 
 class SolenoidCI: public SMPComponentTracker::Integrator<Solenoid>
 {
+public:
+	/**
+	 *	Solenoid maps are built once for each dp bin of width w,
+	 *	or for each dp if w is 0, see StdISet.
+	 */
+	explicit SolenoidCI(double w = 0) :
+		dpBinWidth(w)
+	{
+	}
 protected:
 	void TrackStep(double ds);
+private:
+	double dpBinWidth;
 };
 
 class MarkerCI: public SMPComponentTracker::Integrator<Marker>
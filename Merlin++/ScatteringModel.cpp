@@ -29,8 +29,171 @@ using namespace PhysicalUnits;
 using namespace PhysicalConstants;
 using namespace Collimation;
 
+ScatterModelDetails::~ScatterModelDetails()
+{
+	for(size_t i = 1; i < Processes.size(); i++)
+	{
+		delete Processes[i];
+	}
+}
+
+void ScatterTableEntry::MakeAliasTable()
+{
+	double w[5];
+	double total = Xsection[0];
+	if(total > 0)
+	{
+		double c = 0;
+		for(int i = 0; i < 4; i++)
+		{
+			double next = fmin(c + Xsection[i + 1], total);
+			w[i] = 5 * (next - c) / total;
+			c = next;
+		}
+		w[4] = 5 * (total - c) / total;
+	}
+	else
+	{
+		w[0] = w[1] = w[2] = w[3] = 0;
+		w[4] = 5;
+	}
+
+	//Vose's method: pair each under-full column with an over-full one
+	int small[5], large[5];
+	int ns = 0, nl = 0;
+	for(int i = 0; i < 5; i++)
+	{
+		alias[i] = i;
+		if(w[i] < 1)
+		{
+			small[ns++] = i;
+		}
+		else
+		{
+			large[nl++] = i;
+		}
+	}
+	while(ns > 0 && nl > 0)
+	{
+		int l = small[--ns];
+		int g = large[--nl];
+		aliasProb[l] = w[l];
+		alias[l] = g;
+		w[g] -= 1 - w[l];
+		if(w[g] < 1)
+		{
+			small[ns++] = g;
+		}
+		else
+		{
+			large[nl++] = g;
+		}
+	}
+	while(nl > 0)
+	{
+		aliasProb[large[--nl]] = 1;
+	}
+	while(ns > 0)
+	{
+		aliasProb[small[--ns]] = 1;
+	}
+}
+
+int ScatterTableEntry::SelectProcess() const
+{
+	double u = RandomNG::uniform(0, 5);
+	int k = (u < 5) ? int(u) : 4;
+	return 1 + ((u - k < aliasProb[k]) ? k : alias[k]);
+}
+
+namespace
+{
+
+// Energy grid of the cross section tables
+const size_t tableSize = 64;
+const double tableEmin = 0.01;
+const double tableEmax = 1.1;
+
+// Centre of mass energy squared of a proton of energy E (GeV) on a proton at rest
+double CentreOfMassSq(double E)
+{
+	return 2 * ProtonMassGeV * E + ProtonMassGeV * ProtonMassGeV;
+}
+
+} // end anonymous namespace
+
+void ScatterModelDetails::Tabulate(const MaterialProperties* mat, double E0)
+{
+	const double logE0 = log(E0);
+	logEmin = logE0 + log(tableEmin);
+	dlogE = (log(tableEmax) - log(tableEmin)) / (tableSize - 1);
+
+	// lambda from MaterialProperties includes the Rutherford cross section in the total
+	const double sigma0 = Xsection[0] + mat->sigma_R;
+	const double logs0 = log(0.15 * CentreOfMassSq(E0));
+
+	table.resize(tableSize);
+	for(size_t i = 0; i < tableSize; i++)
+	{
+		const double logE = logEmin + i * dlogE;
+		ScatterTableEntry& t = table[i];
+		for(int k = 0; k < 5; k++)
+		{
+			t.Xsection[k] = Xsection[k];
+		}
+
+		// SixTrack fits: sigma_el ~ E^0.04792, sigma_sd ~ log(0.15 s)
+		t.Xsection[2] = Xsection[2] * exp(0.04792 * (logE - logE0));
+		t.Xsection[3] = Xsection[3] * log(0.15 * CentreOfMassSq(exp(logE))) / logs0;
+		t.Xsection[0] += (t.Xsection[2] - Xsection[2]) + (t.Xsection[3] - Xsection[3]);
+
+		t.lambda = mat->lambda * sigma0 / (t.Xsection[0] + mat->sigma_R);
+		t.MakeAliasTable();
+	}
+}
+
+void ScatterModelDetails::Locate(double E, size_t& i, double& f) const
+{
+	double x = (log(E) - logEmin) / dlogE;
+	if(!(x > 0))
+	{
+		i = 0;
+		f = 0;
+	}
+	else if(x >= table.size() - 1)
+	{
+		i = table.size() - 2;
+		f = 1;
+	}
+	else
+	{
+		i = static_cast<size_t>(x);
+		f = x - i;
+	}
+}
+
+double ScatterModelDetails::MeanFreePath(double E) const
+{
+	size_t i;
+	double f;
+	Locate(E, i, f);
+	return table[i].lambda + f * (table[i + 1].lambda - table[i].lambda);
+}
+
+int ScatterModelDetails::SelectProcess(double E) const
+{
+	size_t i;
+	double f;
+	Locate(E, i, f);
+	if(f > 0 && RandomNG::uniform(0, 1) < f)
+	{
+		i++;
+	}
+	return table[i].SelectProcess();
+}
+
 ScatteringModel::ScatteringModel() :
-	energy_loss_mode(FullEnergyLoss)
+	energy_loss_mode(FullEnergyLoss), slotMaterial(nullptr), slot(0), currentDetails(nullptr)
 {
 	ScatterPlot_on = 0;
 	JawImpact_on = 0;
@@ -39,13 +202,118 @@ ScatteringModel::ScatteringModel() :
 
 ScatteringModel::~ScatteringModel()
 {
-//	for(auto it : stored_cross_sections)
-//	{
-//		delete it.second;
-//	}
+	for(size_t i = 0; i < details.size(); i++)
+	{
+		delete details[i];
+	}
+}
+
+void ScatteringModel::ConfigureMaterials(MaterialData* data, double Energy)
+{
+	for(std::map<std::string, MaterialProperties*>::iterator it = data->property.begin(); it != data->property.end();
+		++it)
+	{
+		if(it->second->sigma_T > 0)
+		{
+			GetDetails(it->second, Energy);
+			GetLossConstants(it->second);
+		}
+	}
+}
+
+size_t ScatteringModel::GetSlot(const MaterialProperties* mat)
+{
+	if(mat == slotMaterial)
+	{
+		return slot;
+	}
+
+	std::unordered_map<const MaterialProperties*, size_t>::const_iterator it = slots.find(mat);
+	if(it == slots.end())
+	{
+		it = slots.insert(std::make_pair(mat, slots.size())).first;
+		details.push_back(nullptr);
+		lossConstants.push_back(MaterialLossConstants());
+	}
+	slotMaterial = mat;
+	slot = it->second;
+	return slot;
+}
+
+ScatterModelDetails* ScatteringModel::GetDetails(MaterialProperties* mat, double E)
+{
+	ScatterModelDetails*& sc = details[GetSlot(mat)];
+	if(sc == nullptr)
+	{
+		Configure(mat, E);
+		sc = new ScatterModelDetails();
+		for(int i = 0; i < 5; i++)
+			sc->Xsection[i] = Xsection[i];
+		for(int i = 1; i < 6; i++)
+			sc->Processes[i] = Processes[i];
+		sc->Tabulate(mat, E);
+
+		//Configure() has set up this material, so the current one must be restored on the next scatter
+		oldMaterial = mat;
+		currentDetails = sc;
+	}
+	return sc;
 }
 
-double ScatteringModel::PathLength(MaterialProperties* mat, double E0)
+const MaterialLossConstants& ScatteringModel::GetLossConstants(MaterialProperties* mat)
+{
+	MaterialLossConstants& lc = lossConstants[GetSlot(mat)];
+	if(!lc.set)
+	{
+		static const double xi1 = 2.0 * pi * pow(ElectronRadius, 2) * ElectronMass * pow(SpeedOfLight, 2);
+
+		if(mat->HaveExtra("MeanExcitationEnergy"))
+		{
+			lc.I = mat->GetExtra("MeanExcitationEnergy") / eV;
+		}
+		else
+		{
+			lc.I = 10 * mat->Z; // I is in eV
+		}
+		double edensity = (mat->Z) * Avogadro * (mat->density) / (mat->A);
+		lc.xi0 = xi1 * edensity;
+		double plasmaEnergy = 28.816 * sqrt((mat->density) * 0.001 * (mat->Z) / (mat->A)); // from 33.1 of the PDG
+		lc.C = 1 + 2 * log(lc.I / plasmaEnergy);
+
+		if((lc.I / eV) < 100)
+		{
+			if(lc.C <= 3.681)
+			{
+				lc.C0 = 0.2;
+				lc.C1 = 2.0;
+			}
+			else
+			{
+				lc.C0 = 0.326 * lc.C - 1.0;
+				lc.C1 = 2.0;
+			}
+		}
+		else //I >= 100eV
+		{
+			if(lc.C <= 5.215)
+			{
+				lc.C0 = 0.2;
+				lc.C1 = 3.0;
+			}
+			else
+			{
+				lc.C0 = 0.326 * lc.C - 1.5;
+				lc.C1 = 3.0;
+			}
+		}
+
+		lc.X = centimeter * mat->X0 / (mat->density / (gram / cc));
+		lc.set = true;
+	}
+	return lc;
+}
+
+double ScatteringModel::PathLength(MaterialProperties* mat, double E)
 {
 // deleted RJB   just use sigma_T
 //    though this  does all sorts of other fancy config stuff which may need replanting
@@ -111,7 +379,7 @@ double ScatteringModel::PathLength(MaterialProperties* mat, double E0)
 //
 //	}
 //
-	return -(mat->lambda) * log(RandomNG::uniform(0, 1));
+	return -GetDetails(mat, E)->MeanFreePath(E) * log(RandomNG::uniform(0, 1));
 }
 
 void ScatteringModel::EnergyLoss(PSvector& p, double x, MaterialProperties* mat, double E0)
@@ -138,54 +406,11 @@ void ScatteringModel::EnergyLossSimple(PSvector& p, double x, MaterialProperties
 //Advanced energy loss
 void ScatteringModel::EnergyLossFull(PSvector& p, double x, MaterialProperties* mat, double E0)
 {
-	static MaterialProperties* oldmat = 0;
-	static const double xi1 = 2.0 * pi * pow(ElectronRadius, 2) * ElectronMass * pow(SpeedOfLight, 2);
-	static double C, C0, C1, I, edensity, xi0, plasmaEnergy;
-	if(mat != oldmat)      // new material so do the sums, otherwise they persist
-	{
-		cout << " New Material for energy loss full calculation";
-		if(mat->HaveExtra("MeanExcitationEnergy")) {
-                   I = mat->GetExtra("MeanExcitationEnergy") / eV;
-                   } else {
-                  I=10*mat->Z; // I is in eV
-}
-                cout<<" Excitation energy "<<I;
-		edensity = (mat->Z) * Avogadro * (mat->density) / (mat->A);
-		xi0 = xi1 *  edensity; //  mat->GetExtra("ElectronDensity");
-		plasmaEnergy = 28.816 * sqrt((mat->density) * 0.001 * (mat->Z) / (mat->A)); // from 33.1 of the PDG
-		cout << " plasma energy is " << plasmaEnergy << endl;
-		C = 1 + 2 * log(I / plasmaEnergy); 
-		C1 = 0;
-		C0 = 0;
-
-		if((I / eV) < 100)
-		{
-			if(C <= 3.681)
-			{
-				C0 = 0.2;
-				C1 = 2.0;
-			}
-			else
-			{
-				C0 = 0.326 * C - 1.0;
-				C1 = 2.0;
-			}
-		}
-		else //I >= 100eV
-		{
-			if(C <= 5.215)
-			{
-				C0 = 0.2;
-				C1 = 3.0;
-			}
-			else
-			{
-				C0 = 0.326 * C - 1.5;
-				C1 = 3.0;
-			}
-		}
-		oldmat = mat;
-	}       // end of material setup stuff
+	const MaterialLossConstants& lc = GetLossConstants(mat);
+	const double C = lc.C;
+	const double C0 = lc.C0;
+	const double C1 = lc.C1;
+	const double I = lc.I;
 
 	double E1 = E0 * (1 + p.dp());
 	double gamma = E1 / (ProtonMassMeV * MeV);
@@ -195,7 +420,7 @@ void ScatteringModel::EnergyLossFull(PSvector& p, double x, MaterialProperties*
 	double tmax = (2 * ElectronMassMeV * beta * beta * gamma * gamma) / (1 + (2 * gamma * (ElectronMassMeV
 		/ ProtonMassMeV)) + pow((ElectronMassMeV / ProtonMassMeV), 2)) * MeV;
 
-	double xi = (xi0 * x / (beta * beta)) / ElectronCharge * (eV / MeV);
+	double xi = (lc.xi0 * x / (beta * beta)) / ElectronCharge * (eV / MeV);
 	double delta = 0;
 
 	//Density correction
@@ -239,17 +464,8 @@ void ScatteringModel::EnergyLossFull(PSvector& p, double x, MaterialProperties*
 //HR 29Aug13
 void ScatteringModel::Straggle(PSvector& p, double x, MaterialProperties* mat, double E1, double E2)
 {
-	static MaterialProperties* oldmat = 0;
-	static double X;     // radiation length in metres
 	static const double root12 = sqrt(12.0);
-	if(mat != oldmat)
-	{
-		X = centimeter * mat->X0 / (mat->density / (gram / cc));
-		cout << " New material in Straggle: radiation length "
-                   << setw(12) << setprecision(5) << X << " metres" << endl;
-		oldmat = mat;
-	}
-	double scaledx = x / X;
+	double scaledx = x / GetLossConstants(mat).X;
 	double Eav = (E1 + E2) / 2.0;
 	double theta0 = 13.6 * MeV * sqrt(scaledx) * (1.0 + 0.038 * log(scaledx)) / Eav;
 	double theta_plane_x = RandomNG::normal(0, 1) * theta0;
@@ -268,49 +484,15 @@ bool ScatteringModel::ParticleScatter(PSvector& p, MaterialProperties* mat, doub
 {
 	if(mat != oldMaterial)       // new collimator material
 	{
-		cout << " Collimator Material has changed";
-		ScatterModelDetails*  sc = saveDetails[mat];
-		if(sc)      // get details
-		{
-			cout << " but is already known \n";
-			for(int i = 0; i < 5; i++)
-				Xsection[i] = sc->Xsection[i];
-			for(int i = 1; i < 6; i++)
-				Processes[i] = sc->Processes[i]; // yes really 1
-		}
-		else
-		{
-			// generate new details
-			cout << " is new so need to make it \n";
-			Configure(mat, E);
-			sc = new ScatterModelDetails(); // NEED DELETE SOMEWHERE
-			for(int i = 0; i < 5; i++)
-				sc->Xsection[i] = Xsection[i];
-			for(int i = 1; i < 6; i++)
-				sc->Processes[i] = Processes[i];
-			saveDetails[mat] = sc;
-		}
-
+		currentDetails = GetDetails(mat, E);
+		for(int i = 0; i < 5; i++)
+			Xsection[i] = currentDetails->Xsection[i];
+		for(int i = 1; i < 6; i++)
+			Processes[i] = currentDetails->Processes[i]; // yes really 1
 		oldMaterial = mat;
 	}
-//
-//	if(fraction.size() == 0)
-//	{
-//		cerr << "ScatteringModel has no ScatteringProcesses. Use AddProcess() or "
-//			 << "one of the inbuilt ScatteringModels such as ScatteringModelMerlin." << endl;
-//		exit(EXIT_FAILURE);
-//	}
-	double r = RandomNG::uniform(0, Xsection[0]);
 
-	for(unsigned int i = 1; i < 5; i++)
-	{
-		r -= Xsection[i];
-		if(r < 0)
-		{
-			return Processes[i]->Scatter(p, E);
-		}
-	}
-	return Processes[5]->Scatter(p, E);
+	return Processes[currentDetails->SelectProcess(E)]->Scatter(p, E);
 }
 
 void ScatteringModel::SetScatterType(int st)
@@ -11,10 +11,12 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include "merlin_config.h"
 #include "PSvector.h"
 #include "ScatteringProcess.h"
+#include "MaterialData.h"
 #include "utils.h"
 
 namespace Collimation
@@ -97,11 +99,96 @@ enum EnergyLossMode
  * use the predefined models such as ScatteringModelMerlin.
  */
 
+/**
+ * Cross sections of a material at one energy, with its mean free path and
+ * the alias table for picking a process
+ */
+struct ScatterTableEntry
+{
+	double Xsection[5];
+	double lambda;
+
+	/**
+	 * Alias table over Processes[1] to Processes[5]: the process in
+	 * column k is chosen with probability aliasProb[k], otherwise alias[k]
+	 */
+	double aliasProb[5];
+	int alias[5];
+
+	/**
+	 * Builds the alias table from the cross sections. Processes 1-4 take
+	 * their cross sections out of the total Xsection[0] in turn, and
+	 * process 5 takes the remainder.
+	 */
+	void MakeAliasTable();
+
+	/**
+	 * Picks a process in proportion to its cross section
+	 * @return index into Processes
+	 */
+	int SelectProcess() const;
+};
+
 struct ScatterModelDetails
 {
+	/**
+	 * Cross sections and processes as configured at the reference energy
+	 */
 	std::vector<double> Xsection = std::vector<double>(5, 0.0);
 	std::vector<Collimation::ScatteringProcess*> Processes{0, 0, 0, 0, 0, 0};
 
+	/**
+	 * Cross sections on a grid of energies, evenly spaced in log(E) from
+	 * exp(logEmin) in steps of dlogE
+	 */
+	std::vector<ScatterTableEntry> table;
+	double logEmin;
+	double dlogE;
+
+	~ScatterModelDetails();
+
+	/**
+	 * Tabulates the cross sections of mat from E0 / 100, below which
+	 * collimation stops tracking a particle, to just above E0, the energy
+	 * at which Xsection was configured. The proton-nucleon elastic and
+	 * single diffractive cross sections Xsection[2] and [3] follow the
+	 * energy dependence of the SixTrack fits, and the total changes with
+	 * them. The Rutherford and inelastic cross sections of MaterialData
+	 * do not depend on energy.
+	 */
+	void Tabulate(const MaterialProperties* mat, double E0);
+
+	/**
+	 * Interpolated mean free path at energy E
+	 */
+	double MeanFreePath(double E) const;
+
+	/**
+	 * Picks a process in proportion to its cross section at energy E, from
+	 * the table of one of the two grid energies either side of E, chosen
+	 * with the weights of linear interpolation
+	 * @return index into Processes
+	 */
+	int SelectProcess(double E) const;
+
+private:
+	/**
+	 * Grid index i and fraction f of the way from entry i to entry i + 1
+	 * of energy E, clamped to the ends of the table
+	 */
+	void Locate(double E, size_t& i, double& f) const;
+};
+
+/**
+ * Per material constants for ionisation energy loss and multiple scattering
+ */
+struct MaterialLossConstants
+{
+	bool set = false;
+	double I;       // mean excitation energy in eV
+	double C, C0, C1;   // density correction parameters
+	double xi0;
+	double X;       // radiation length in metres
 };
 
 class ScatteringModel
@@ -109,7 +196,6 @@ class ScatteringModel
 
 public:
 	MaterialProperties* oldMaterial;   // keep track of changing collimators
-	std::map<MaterialProperties*, ScatterModelDetails*> saveDetails;
 	/**
 	 * Constructor
 	 */
@@ -118,6 +204,14 @@ public:
 	virtual void Configure(MaterialProperties *, double Energy) = 0;    // material not known at
 	// construct time and may change
 
+	/**
+	 * Configures every material in data that has cross sections, and
+	 * tabulates them in energy below the reference Energy, so that no set
+	 * up is needed when a particle first hits each collimator. Materials
+	 * not configured here are configured on first use.
+	 */
+	void ConfigureMaterials(MaterialData* data, double Energy);
+
 	/**
 	 * Collimation Functions
 	 * Set ScatterType
@@ -125,9 +219,11 @@ public:
 	void SetScatterType(int st);
 
 	/**
-	 * Calculate the particle path length in given material using scattering processes
+	 * Samples the path length to the next interaction of a particle of
+	 * energy E in the given material, from the mean free path tabulated
+	 * in energy. A material not yet configured is configured at E.
 	 */
-	double PathLength(MaterialProperties* mat, double E0);
+	double PathLength(MaterialProperties* mat, double E);
 
 	/**
 	 * Dispatches to EnergyLossSimple or EnergyLossFull
@@ -140,7 +236,9 @@ public:
 	void Straggle(PSvector& p, double x, MaterialProperties* mat, double E1, double E2);
 
 	/**
-	 * Function performs scattering and returns true if inelastic scatter
+	 * Function performs scattering and returns true if inelastic scatter.
+	 * The process is chosen with the cross sections at E, but the
+	 * processes themselves are those configured for the material.
 	 */
 	bool ParticleScatter(PSvector& p, MaterialProperties* mat, double E);
 
@@ -193,6 +291,39 @@ private:
 	 */
 
 	void EnergyLossFull(PSvector& p, double x, MaterialProperties* mat, double E0);
+
+	/**
+	 * Returns the configured details of mat, configuring them at energy E
+	 * if needed
+	 */
+	ScatterModelDetails* GetDetails(MaterialProperties* mat, double E);
+
+	/**
+	 * Returns the energy loss and scattering constants of mat, calculating
+	 * them if needed
+	 */
+	const MaterialLossConstants& GetLossConstants(MaterialProperties* mat);
+
+	/**
+	 * Returns the slot of mat in details and lossConstants, assigning
+	 * the next free slot on its first use by this model
+	 */
+	size_t GetSlot(const MaterialProperties* mat);
+
+	/**
+	 * Slots of the materials used by this model, with the last one
+	 * looked up
+	 */
+	std::unordered_map<const MaterialProperties*, size_t> slots;
+	const MaterialProperties* slotMaterial;
+	size_t slot;
+
+	/**
+	 * Configured details and loss constants of each material, by slot
+	 */
+	std::vector<ScatterModelDetails*> details;
+	std::vector<MaterialLossConstants> lossConstants;
+	ScatterModelDetails* currentDetails;
 	//0 = SixTrack, 1 = ST+Ad Ion, 2 = ST + Ad El, 3 = ST + Ad SD, 4 = MERLIN
 	int ScatteringPhysicsModel; // Still required for CrossSections
 };
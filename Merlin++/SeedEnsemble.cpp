@@ -0,0 +1,74 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#include "SeedEnsemble.h"
+#include "ParallelFor.h"
+#include "AcceleratorModel.h"
+#include "ParticleTracker.h"
+#include "CollimationOutput.h"
+#include "RandomNG.h"
+#include "MerlinException.h"
+
+namespace ParticleTracking
+{
+
+SeedEnsemble::SeedEnsemble(AcceleratorModel* m, double p0, unsigned int n) :
+	model(m), P0(p0), nthreads(n)
+{
+}
+
+SeedEnsemble::~SeedEnsemble()
+{
+	for(size_t n = 0; n < jobs.size(); n++)
+	{
+		delete jobs[n];
+	}
+}
+
+void SeedEnsemble::AddJob(Job* job, std::uint32_t seed)
+{
+	jobs.push_back(job);
+	seeds.push_back(seed);
+}
+
+void SeedEnsemble::Prepare()
+{
+	ParticleTracker tracker(model->GetBeamline(), Particle(0), P0);
+	tracker.Run();
+}
+
+void SeedEnsemble::Run()
+{
+	if(jobs.empty())
+	{
+		return;
+	}
+
+	Prepare();
+
+	ParallelFor(jobs.size(), nthreads, [this](size_t n)
+		{
+			// The calling thread runs jobs too, so its own generator is put back afterwards
+			RandomNG::ScopedSeed seed(seeds[n]);
+			jobs[n]->Run(model, seeds[n]);
+		});
+}
+
+void SeedEnsemble::MergeCollimationOutputs(CollimationOutput& total, size_t n) const
+{
+	for(size_t j = 0; j < jobs.size(); j++)
+	{
+		std::vector<CollimationOutput*> outputs = jobs[j]->GetCollimationOutputs();
+		if(n >= outputs.size())
+		{
+			throw MerlinException("SeedEnsemble::MergeCollimationOutputs: job has no collimation output with this index");
+		}
+		total.Merge(*outputs[n]);
+	}
+}
+
+} // end namespace ParticleTracking
@@ -0,0 +1,133 @@
+/*
+ * Merlin++: C++ Class Library for Charged Particle Accelerator Simulations
+ * Copyright (c) 2001-2018 The Merlin++ developers
+ * This file is covered by the terms the GNU GPL version 2, or (at your option) any later version, see the file COPYING
+ * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
+ */
+
+#ifndef SeedEnsemble_h
+#define SeedEnsemble_h 1
+
+#include "merlin_config.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class AcceleratorModel;
+
+namespace ParticleTracking
+{
+
+class CollimationOutput;
+
+/**
+ * Runs a set of independent jobs, one per random seed, on a pool of threads that
+ * all share one AcceleratorModel. The model is built (and the lattice is loaded)
+ * once, instead of once per seed.
+ *
+ * Each job owns everything it modifies: its bunch, tracker, processes, scattering
+ * model and outputs. The model itself must be treated as read-only by the jobs;
+ * the integrators and processes only read component fields and apertures while
+ * tracking. Before the jobs start, a reference particle is tracked through the
+ * beamline on the calling thread so that any lazily sized field expansions are
+ * complete before the model is shared.
+ *
+ * The random number generator is held per thread. Each job is run with the
+ * generator of its thread seeded by a RandomNG::ScopedSeed, so it gives the same
+ * result as a serial run started with RandomNG::init(seed), regardless of which
+ * thread it runs on. The calling thread also runs jobs, and its generator is the
+ * same after Run() as before it.
+ *
+ * The jobs run in a ParallelFor() loop, so parallel code they call with its
+ * default thread count (e.g. DispersionFreeSteering, the blocked linear
+ * algebra) runs on the job's thread only, and the ensemble does not
+ * oversubscribe the machine.
+ */
+class SeedEnsemble
+{
+public:
+
+	/**
+	 * A single seed of the ensemble.
+	 */
+	class Job
+	{
+	public:
+		virtual ~Job()
+		{
+		}
+
+		/**
+		 * Build the bunch, tracker and processes and run the simulation.
+		 * The generator has already been seeded with seed.
+		 */
+		virtual void Run(AcceleratorModel* model, std::uint32_t seed) = 0;
+
+		/**
+		 * Collimation outputs filled by this job, for MergeCollimationOutputs()
+		 */
+		virtual std::vector<CollimationOutput*> GetCollimationOutputs()
+		{
+			return std::vector<CollimationOutput*>();
+		}
+	};
+
+	/**
+	 * Ensemble sharing model, using reference momentum P0 for the warm-up pass.
+	 * With nthreads = 0 one thread per hardware core is used (see
+	 * ParallelThreads()).
+	 */
+	SeedEnsemble(AcceleratorModel* model, double P0, unsigned int nthreads = 0);
+	~SeedEnsemble();
+
+	/**
+	 * Add a job to be run with the given seed. The ensemble takes ownership of job.
+	 */
+	void AddJob(Job* job, std::uint32_t seed);
+
+	/**
+	 * Run all jobs and wait for them to finish. If jobs throw, the remaining
+	 * jobs still run and the exception of the first of them in job order is
+	 * rethrown here.
+	 */
+	void Run();
+
+	/**
+	 * Merge the n-th collimation output of every job, in job order, into total.
+	 */
+	void MergeCollimationOutputs(CollimationOutput& total, size_t n = 0) const;
+
+	size_t GetNumberOfJobs() const
+	{
+		return jobs.size();
+	}
+
+	Job* GetJob(size_t n) const
+	{
+		return jobs[n];
+	}
+
+private:
+
+	/**
+	 * Track a reference particle through the model once before the
+	 * threads start, so that caches built on first use, such as the
+	 * frame transformations, are filled serially
+	 */
+	void Prepare();
+
+	AcceleratorModel* model;
+	double P0;
+	unsigned int nthreads;
+
+	std::vector<Job*> jobs;
+	std::vector<std::uint32_t> seeds;
+
+	//Copy protection
+	SeedEnsemble(const SeedEnsemble& rhs);
+	SeedEnsemble& operator=(const SeedEnsemble& rhs);
+};
+
+} // end namespace ParticleTracking
+
+#endif
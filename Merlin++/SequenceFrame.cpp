@@ -164,10 +164,12 @@ void SequenceFrame::ConsolidateConstruction()
 	}
 
 	itsSeqGeom->CalculateCachedTransforms();
+	InvalidateGeometryCache();
 }
 
 void SequenceFrame::Invalidate() const
 {
+	LatticeFrame::Invalidate();
 	if(!subFrames.empty())
 	{
 		(subFrames.front())->Invalidate();
@@ -178,6 +180,41 @@ void SequenceFrame::Invalidate() const
 	}
 }
 
+Transform3D SequenceFrame::GetSubFrameOriginTransform(const LatticeFrame* aSubFrame) const
+{
+	const unsigned long v = GeometryVersion();
+	FrameCache<OriginMap>::Pointer origins = subFrameOrigins.Find(v);
+	if(!origins)
+	{
+		// The sub-frames are contiguous, so each origin follows from the
+		// previous one through the exit of the previous sub-frame, which is
+		// the entrance of the next.
+		OriginMap newOrigins;
+		Transform3D t;
+		Transform3D toEntrance;
+		for(FrameList::const_iterator fi = subFrames.begin(); fi != subFrames.end(); ++fi)
+		{
+			AcceleratorGeometry::Extent ext = (*fi)->GetLocalGeometryExtent();
+			if(fi == subFrames.begin())
+			{
+				t = GetGeometryTransform(0, (*fi)->GetLocalPosition());
+			}
+			else
+			{
+				FrameList::const_iterator prev = fi;
+				--prev;
+				t = (*fi)->GetGeometryTransform(ext.first, 0) * (*prev)->GetTotalGeometryTransform() * toEntrance * t;
+			}
+			newOrigins[*fi] = t;
+			toEntrance = (*fi)->GetGeometryTransform(0, ext.first);
+		}
+		origins = subFrameOrigins.Store(v, newOrigins);
+	}
+
+	OriginMap::const_iterator oi = origins->find(aSubFrame);
+	return oi != origins->end() ? oi->second : LatticeFrame::GetSubFrameOriginTransform(aSubFrame);
+}
+
 ModelElement* SequenceFrame::Copy() const
 {
 	return new SequenceFrame(*this);
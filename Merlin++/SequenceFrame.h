@@ -10,6 +10,7 @@
 
 #include "merlin_config.h"
 #include <list>
+#include <map>
 #include <vector>
 
 #include "LatticeFrame.h"
@@ -101,11 +102,22 @@ public:
 
 protected:
 
+	/**
+	 *	Returns the geometry transformation from the origin of this
+	 *	frame to the origin of aSubFrame. The transformations to all
+	 *	the sub-frames are calculated together, in one pass along the
+	 *	sequence, and cached.
+	 */
+	virtual Transform3D GetSubFrameOriginTransform(const LatticeFrame* aSubFrame) const;
+
 private:
 
 	FrameList subFrames;
 	SequenceGeometry* itsSeqGeom;
 
+	typedef std::map<const LatticeFrame*, Transform3D> OriginMap;
+	mutable FrameCache<OriginMap> subFrameOrigins;
+
 	/**
 	 *	Copies the subframes from frames.
 	 */
@@ -5,16 +5,17 @@
  * This file is derived from software bearing the copyright notice in merlin4_copyright.txt
  */
 
-#include <fstream>
+#include <algorithm>
 
 #include "ParticleTracker.h"
 #include "CollimateParticleProcess.h"
 #include "StableOrbits.h"
+#include "ParallelFor.h"
 
 using namespace std;
 
 StableOrbits::StableOrbits(AcceleratorModel* aModel) :
-	theModel(aModel), nturns(1), obspnt(0)
+	theModel(aModel), nturns(1), obspnt(0), nthreads(1)
 {
 }
 
@@ -32,30 +33,75 @@ int StableOrbits::SetObservationPoint(int n)
 	return old;
 }
 
+size_t StableOrbits::SetThreads(size_t n)
+{
+	size_t old = nthreads;
+	nthreads = n;
+	return old;
+}
+
 void StableOrbits::SelectStable(ParticleBunch& bunch, list<size_t>* index)
 {
-	ParticleTracker tracker(theModel->GetRing(obspnt), &bunch, false);
+	vector<size_t> stable = SelectStable(static_cast<const ParticleBunch&>(bunch));
+	index->assign(stable.begin(), stable.end());
+}
+
+vector<size_t> StableOrbits::SelectStable(const ParticleBunch& bunch)
+{
+	const size_t np = bunch.size();
+	if(np == 0)
+	{
+		return {};
+	}
+
+	const size_t nt = min(ParallelThreads(nthreads), np);
 
-	ofstream collimlog("DataFiles/CollimationLog.dat");
-	CollimateParticleProcess* collimate = new CollimateParticleProcess(1, COLL_AT_CENTER, &collimlog);
-	collimate->IndexParticles(*index);
-	tracker.AddProcess(collimate);
+	const double P0 = bunch.GetReferenceMomentum();
+	const double Qm = bunch.GetTotalCharge() / np;
 
-	for(int turn_count = 1; turn_count <= nturns; turn_count++)
+	// One pass through the ring sets up any state the lattice builds
+	// lazily, before the threads share it
+	if(nt > 1)
 	{
-		if(turn_count == 1)
+		ParticleTracker tracker(theModel->GetRing(obspnt), Particle(0), P0);
+		tracker.Run();
+	}
+
+	vector<vector<size_t> > stable(nt);
+	ParallelFor(nt, nt, [&](size_t c)
+	{
+		const size_t first = c * np / nt;
+		const size_t last = (c + 1) * np / nt;
+		ParticleBunch chunk(P0, Qm);
+		for(size_t n = first; n < last; n++)
 		{
-			tracker.Run();
+			chunk.push_back(bunch.GetParticles()[n]);
 		}
-		else
+
+		ParticleTracker tracker(theModel->GetRing(obspnt), &chunk, false);
+		CollimateParticleProcess* collimate = new CollimateParticleProcess(1, COLL_AT_CENTER);
+		collimate->IndexParticles(true);
+		collimate->SetLossThreshold(200); // losing the whole chunk is not an error here
+		tracker.AddProcess(collimate);
+
+		// Lost particles are removed from the tracked copy of the chunk
+		// as they hit an aperture, and a chunk with none left is finished
+		tracker.Run();
+		for(int turn_count = 2; turn_count <= nturns && tracker.GetTrackedBunch().size() > 0; turn_count++)
 		{
 			tracker.Continue();
 		}
 
-		ParticleBunch& tracked_bunch = tracker.GetTrackedBunch();
-		cout << "Tracked turn " << turn_count << ": ";
-		cout << tracked_bunch.size() << " particles remaining.    " << char(13);
-	}
+		for(auto n : collimate->GetIndexes())
+		{
+			stable[c].push_back(first + n);
+		}
+	});
 
-	cout << endl;
+	vector<size_t> index;
+	for(size_t c = 0; c < nt; c++)
+	{
+		index.insert(index.end(), stable[c].begin(), stable[c].end());
+	}
+	return index;
 }
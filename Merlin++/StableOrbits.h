@@ -9,24 +9,48 @@
 #define StableOrbits_h 1
 
 #include <list>
+#include <vector>
 #include "AcceleratorModel.h"
 #include "ParticleBunch.h"
 
 using namespace ParticleTracking;
 
+/**
+ * Selects the particles of a bunch which survive a number of turns
+ * around the ring, starting at an observation point. Particles are
+ * dropped from tracking as soon as they hit an aperture. The bunch can
+ * be split into chunks which are tracked on separate threads.
+ */
 class StableOrbits
 {
 public:
 	StableOrbits(AcceleratorModel* aModel);
+
+	/**
+	 * Set index to the positions in the bunch of the particles which
+	 * survive. The bunch is not changed.
+	 */
 	void SelectStable(ParticleBunch& aBunch, std::list<size_t>* index);
 
+	/**
+	 * Positions in the bunch of the particles which survive, in order.
+	 */
+	std::vector<size_t> SelectStable(const ParticleBunch& aBunch);
+
 	int SetTurns(int turns);
 	int SetObservationPoint(int n);
 
+	/**
+	 * Number of threads tracking chunks of the bunch (default 1, 0 for
+	 * ParallelThreads(0)). The selection does not depend on it.
+	 */
+	size_t SetThreads(size_t n);
+
 private:
 	AcceleratorModel* theModel;
 	int nturns;
 	int obspnt;
+	size_t nthreads;
 };
 
 #endif
@@ -53,9 +53,20 @@ struct MultipoleKick
 	const MultipoleField& field;
 	double scale;
 
+	// Coefficients (up to the quadrupole) left out of the kick because the map models them
+	Complex removed[2];
+	bool subtract;
+
 	MultipoleKick(const MultipoleField& f, double len, double P0, double q) :
-		field(f), scale(q * len * eV * SpeedOfLight / P0)
+		field(f), scale(q * len * eV * SpeedOfLight / P0), subtract(false)
+	{
+	}
+
+	MultipoleKick& Without(size_t n, const Complex& b)
 	{
+		removed[n] = b;
+		subtract = true;
+		return *this;
 	}
 
 	void operator()(PSvector& v)
@@ -63,7 +74,12 @@ struct MultipoleKick
 		double x = v.x();
 		double y = v.y();
 		double dp = v.dp();
-		Complex F = scale * field.GetField2D(x, y) / (1 + dp);
+		Complex B = field.GetField2D(x, y);
+		if(subtract)
+		{
+			B -= field.GetFieldScale() * (removed[0] + Complex(x, y) * removed[1]);
+		}
+		Complex F = scale * B / (1 + dp);
 		v.xp() += -F.real();
 		v.yp() += F.imag();
 	}
@@ -216,21 +232,17 @@ void SectorBendCI::TrackStep(double ds)
 	if(splitMagnet)
 	{
 
-		// First we set the real parts of the
-		// dipole and quad fields to zero, since these
+		// The real parts of the dipole and quad fields
+		// are left out of the kick, since these
 		// components have been modeled in the matrix
 		Complex b1 = field.GetCoefficient(1);
-		field.SetCoefficient(0, Complex(0, b0.imag()));
-		field.SetCoefficient(1, Complex(0, b1.imag()));
+		MultipoleKick kick(field, ds, P0, q);
+		kick.Without(0, b0.real()).Without(1, b1.real());
 
 		// Apply the integrated kick, and then track
 		// through the linear second half
-		for_each(currentBunch->begin(), currentBunch->end(), MultipoleKick(field, ds, P0, q));
+		for_each(currentBunch->begin(), currentBunch->end(), kick);
 		M.Apply(currentBunch->GetParticles(), P0);
-
-		// Remember to set the components back
-		field.SetCoefficient(0, b0);
-		field.SetCoefficient(1, b1);
 	}
 
 	if(tilt != 0)
@@ -320,8 +332,9 @@ void RectMultipoleCI::TrackStep(double ds)
 	if(splitMagnet)
 	{
 		Complex b1 = field.GetCoefficient(1);
-		field.SetCoefficient(1, Complex(0));
-		for_each(currentBunch->begin(), currentBunch->end(), MultipoleKick(field, ds, P0, q));
+		MultipoleKick kick(field, ds, P0, q);
+		kick.Without(1, b1);
+		for_each(currentBunch->begin(), currentBunch->end(), kick);
 		if(b1 != 0.0)
 		{
 			M.Apply(currentBunch->GetParticles());
@@ -330,7 +343,6 @@ void RectMultipoleCI::TrackStep(double ds)
 		{
 			ApplyDrift(currentBunch->GetParticles(), len);
 		}
-		field.SetCoefficient(1, b1);
 	}
 }
 
@@ -9,6 +9,9 @@
 #define ParticleTracking_StdIntegrators_h 1
 
 #include "merlin_config.h"
+#include <array>
+#include <map>
+#include "RTMap.h"
 #include "SectorBend.h"
 #include "RectMultipole.h"
 #include "SWRFStructure.h"
@@ -20,6 +23,8 @@
 
 #include "ParticleComponentTracker.h"
 #include "ParticleMapPI.h"
+#include "LCAVintegrator.h"
+#include "TransRFIntegrator.h"
 
 #define DECL_SIMPLE_INTG(I, C) class I: \
 	public ParticleComponentTracker::Integrator<C> { \
@@ -69,9 +74,27 @@ public:
 	void TrackExit();
 protected:
 	void ApplyPoleFaceRotation(const SectorBend::PoleFace* pf);
+
+	/**
+	 * Second-order map of a step of length len through a bend of
+	 * curvature h and focusing K1, for particles of the given gamma.
+	 * Only the real part of K1 enters a quadrupole map, which does
+	 * not depend on gamma. The maps are built once and kept by the
+	 * integrator, so each tracker has its own.
+	 */
+	const RTMap& GetMap(double len, double h, const Complex& K1, double gamma);
+
+private:
+	std::map<std::array<double, 4>, RTMap> maps;
 };
 
 DECL_INTG_SET(ParticleComponentTracker, StdISet)
+
+/**
+ * The integrators of StdISet as a StaticISet
+ */
+typedef ParticleComponentTracker::StaticISet<DriftCI, SectorBendCI, RectMultipoleCI, LCAVIntegrator,
+	TransRFIntegrator, SolenoidCI, THIN_LENS::SWRFStructureCI, MarkerCI, MonitorCI, ParticleMapCI> FixedISet;
 } //end namespace TRANSPORT
 
 } // end namespace ParticleTracking
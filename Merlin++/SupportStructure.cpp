@@ -14,15 +14,23 @@ SupportStructure::SupportStructure(const string& id, Type type) :
 {
 	sup1 = new AcceleratorSupport();
 	sup2 = (type == girder) ? new AcceleratorSupport() : nullptr;
+	SetSupportFrames();
 }
 
 SupportStructure::SupportStructure(const SupportStructure& rhs) :
 	SequenceFrame(rhs)
 {
 	sup1 = new AcceleratorSupport();
-	if(rhs.sup2)
+	sup2 = rhs.sup2 ? new AcceleratorSupport() : nullptr;
+	SetSupportFrames();
+}
+
+void SupportStructure::SetSupportFrames()
+{
+	sup1->frame = this;
+	if(sup2)
 	{
-		sup2 = new AcceleratorSupport();
+		sup2->frame = this;
 	}
 }
 
@@ -84,6 +84,11 @@ private:
 	 */
 	void UpdateSupportTransform() const;
 
+	/**
+	 *	Tells the supports that they support this frame.
+	 */
+	void SetSupportFrames();
+
 	/**
 	 *	Rotation used to convert the support motion into the
 	 *	local entrance plane reference frame.
@@ -39,6 +39,7 @@ ADD_INTG(SectorBendCI)
 ADD_INTG(ParticleTracking::MarkerCI)
 ADD_INTG(ParticleTracking::MonitorCI)
 ADD_INTG(ParticleTracking::SolenoidCI)
+ADD_INTG(ParticleTracking::ParticleMapCI)
 END_INTG_SET
 
 #define CHK_ZERO(s) if(s == 0) return;
@@ -404,18 +405,34 @@ private:
 	const MultipoleField& field;
 	Complex scale;
 
+	// Coefficients (up to the quadrupole) left out of the kick because the map models them
+	Complex removed[2];
+	bool subtract;
+
 public:
 	MultipoleKick(const MultipoleField& f, double ds, double P0, double q, double phi = 0) :
-		field(f)
+		field(f), subtract(false)
 	{
 		scale = q * ds * eV * SpeedOfLight / P0 * Complex(cos(phi), sin(phi));
 	}
 
+	MultipoleKick& Without(size_t n, const Complex& b)
+	{
+		removed[n] = b;
+		subtract = true;
+		return *this;
+	}
+
 	void operator()(PSvector& v)
 	{
 		double x = v.x();
 		double y = v.y();
-		Complex F = scale * field.GetField2D(x, y);
+		Complex B = field.GetField2D(x, y);
+		if(subtract)
+		{
+			B -= field.GetFieldScale() * (removed[0] + Complex(x, y) * removed[1]);
+		}
+		Complex F = scale * B;
 		v.xp() += -F.real();
 		v.yp() += F.imag();
 	}
@@ -633,21 +650,21 @@ inline void ApplyDriftMap(ParticleBunch* bunch, double ds)
 {
 	if(ds != 0)
 	{
-		for_each(bunch->begin(), bunch->end(), DriftMap(ds));
+		ApplyToBunch(*bunch, DriftMap(ds));
 	}
 }
 
-inline void ApplyMultipoleKick(ParticleBunch* bunch, MultipoleField& field, double ds, double P0, double q)
+inline void ApplyMultipoleKick(ParticleBunch* bunch, const MultipoleKick& kick, double ds)
 {
 	if(ds != 0)
 	{
-		for_each(bunch->begin(), bunch->end(), MultipoleKick(field, ds, P0, q));
+		ApplyToBunch(*bunch, kick);
 	}
 }
 
 inline void ApplyPoleFaceRotation(ParticleBunch* bunch, double h, const SectorBend::PoleFace& pf)
 {
-	for_each(bunch->begin(), bunch->end(), PoleFaceRotation(h, pf));
+	ApplyToBunch(*bunch, PoleFaceRotation(h, pf));
 }
 
 inline void ApplySectorBendMap(ParticleBunch* bunch, double h, double ds)
@@ -656,11 +673,11 @@ inline void ApplySectorBendMap(ParticleBunch* bunch, double h, double ds)
 	{
 		if(h == 0)
 		{
-			for_each(bunch->begin(), bunch->end(), DriftMap(ds));
+			ApplyToBunch(*bunch, DriftMap(ds));
 		}
 		else
 		{
-			for_each(bunch->begin(), bunch->end(), SectorBendMap(h, ds));
+			ApplyToBunch(*bunch, SectorBendMap(h, ds));
 		}
 	}
 }
@@ -671,11 +688,11 @@ inline void ApplySectorBendMapEF(ParticleBunch* bunch, double h, double ds)
 	{
 		if(h == 0)
 		{
-			for_each(bunch->begin(), bunch->end(), DriftMap(ds));
+			ApplyToBunch(*bunch, DriftMap(ds));
 		}
 		else
 		{
-			for_each(bunch->begin(), bunch->end(), SectorBendMapEF(h, ds));
+			ApplyToBunch(*bunch, SectorBendMapEF(h, ds));
 		}
 	}
 }
@@ -684,7 +701,7 @@ inline void ApplyCombinedFunctionSectorBendMap(ParticleBunch* bunch, double h, d
 {
 	if(ds != 0)
 	{
-		for_each(bunch->begin(), bunch->end(), CombinedFunctionSectorBendMap(h, k1, ds));
+		ApplyToBunch(*bunch, CombinedFunctionSectorBendMap(h, k1, ds));
 	}
 }
 
@@ -692,26 +709,26 @@ inline void ApplyQuadrupoleMap(ParticleBunch* bunch, double k1, double ds)
 {
 	if(ds != 0)
 	{
-		for_each(bunch->begin(), bunch->end(), QuadrupoleMap(k1, ds));
+		ApplyToBunch(*bunch, QuadrupoleMap(k1, ds));
 	}
 }
 
 inline void ApplyRFStructureMap(ParticleBunch* bunch, double Vnorm, double Verr, double kval, double phase, double
 	phaseErr, RMtrx& RM, bool full_accel)
 {
-	for_each(bunch->begin(), bunch->end(), RFStructureMap(Vnorm, Verr, kval, phase, phaseErr, RM, full_accel));
+	ApplyToBunch(*bunch, RFStructureMap(Vnorm, Verr, kval, phase, phaseErr, RM, full_accel));
 }
 
 inline void ApplySWRFStructureMap(ParticleBunch* bunch, double Vnorm, double Verr, double kval, double phase, double
 	phaseErr, double length)
 {
-	for_each(bunch->begin(), bunch->end(), RSRFStructureMap(Vnorm, Verr, kval, phase, phaseErr, length));
+	ApplyToBunch(*bunch, RSRFStructureMap(Vnorm, Verr, kval, phase, phaseErr, length));
 }
 
 inline void ApplySimpleRFStructureMap(ParticleBunch* bunch, double Vnorm, double Verr, double kval, double phase, double
 	phaseErr, double length)
 {
-	for_each(bunch->begin(), bunch->end(), SimpleRFStructureMap(Vnorm, Verr, kval, phase, phaseErr, length));
+	ApplyToBunch(*bunch, SimpleRFStructureMap(Vnorm, Verr, kval, phase, phaseErr, length));
 }
 
 // TrackStep Routines
@@ -796,14 +813,14 @@ void SectorBendCI::TrackStep(double ds)
 	if(splitMagnet)
 	{
 
-		// First we set the real parts of the dipole and quad fields to zero,
+		// The real parts of the dipole and quad fields are left out of the kick,
 		// since these components have been modeled in the matrix
 		Complex b1 = field.GetCoefficient(1);
-		field.SetCoefficient(0, Complex(0, b0.imag()));
-		field.SetCoefficient(1, Complex(0, b1.imag()));
+		MultipoleKick kick(field, ds, P0, q);
+		kick.Without(0, b0.real()).Without(1, b1.real());
 
 		// Apply the integrated kick, and then track through the linear second half
-		ApplyMultipoleKick(currentBunch, field, ds, P0, q);
+		ApplyMultipoleKick(currentBunch, kick, ds);
 
 		if(h == 0 && K1.real() == 0)
 		{
@@ -824,10 +841,6 @@ void SectorBendCI::TrackStep(double ds)
 		{
 			ApplyCombinedFunctionSectorBendMap(currentBunch, h, K1.real(), len);
 		}
-
-		// Remember to set the components back
-		field.SetCoefficient(0, b0);
-		field.SetCoefficient(1, b1);
 	}
 
 	if(tilt != 0)
@@ -912,14 +925,14 @@ void SectorBendCI_ef::TrackStep(double ds)
 	if(splitMagnet)
 	{
 
-		// First we set the real parts of the dipole and quad fields to zero,
+		// The real parts of the dipole and quad fields are left out of the kick,
 		// since these components have been modeled in the matrix
 		Complex b1 = field.GetCoefficient(1);
-		field.SetCoefficient(0, Complex(0, b0.imag()));
-		field.SetCoefficient(1, Complex(0, b1.imag()));
+		MultipoleKick kick(field, ds, P0, q);
+		kick.Without(0, b0.real()).Without(1, b1.real());
 
 		// Apply the integrated kick, and then track through the linear second half
-		ApplyMultipoleKick(currentBunch, field, ds, P0, q);
+		ApplyMultipoleKick(currentBunch, kick, ds);
 
 		if(h == 0 && K1.real() == 0)
 		{
@@ -940,10 +953,6 @@ void SectorBendCI_ef::TrackStep(double ds)
 		{
 			ApplyCombinedFunctionSectorBendMap(currentBunch, h, K1.real(), len);
 		}
-
-		// Remember to set the components back
-		field.SetCoefficient(0, b0);
-		field.SetCoefficient(1, b1);
 	}
 
 	if(tilt != 0)
@@ -975,7 +984,7 @@ void RectMultipoleCI::TrackStep(double ds)
 	if(currentComponent->GetLength() == 0 && ds == 0 && !field.IsNullField())
 	{
 		// Using a ds = 1.0 for thin correctors
-		for_each(currentBunch->begin(), currentBunch->end(), MultipoleKick(field, 1.0, P0, q));
+		ApplyToBunch(*currentBunch, MultipoleKick(field, 1.0, P0, q));
 		return;
 	}
 	CHK_ZERO(ds);
@@ -1007,18 +1016,18 @@ void RectMultipoleCI::TrackStep(double ds)
 		if(splitMagnet)
 		{
 			Complex b1 = field.GetCoefficient(1);
-			field.SetCoefficient(1, Complex(0));
 			if(cK1 != 0.0)
 			{
 				double phi = arg(cK1) / 2;
-				for_each(currentBunch->begin(), currentBunch->end(), MultipoleKick(field, ds, P0, q, -phi));
+				MultipoleKick kick(field, ds, P0, q, -phi);
+				ApplyToBunch(*currentBunch, kick.Without(1, b1));
 			}
 			else
 			{
-				for_each(currentBunch->begin(), currentBunch->end(), MultipoleKick(field, ds, P0, q));
+				MultipoleKick kick(field, ds, P0, q);
+				ApplyToBunch(*currentBunch, kick.Without(1, b1));
 			}
 			M.Apply(currentBunch->GetParticles());
-			field.SetCoefficient(1, b1);
 		}
 
 	}
@@ -1029,11 +1038,10 @@ void RectMultipoleCI::TrackStep(double ds)
 
 	if(splitMagnet)
 	{
-		Complex b1 = field.GetCoefficient(1);
-		field.SetCoefficient(1, Complex(0));
-		for_each(currentBunch->begin(), currentBunch->end(), MultipoleKick(field, ds, P0, q));
+		MultipoleKick kick(field, ds, P0, q);
+		kick.Without(1, field.GetCoefficient(1));
+		ApplyToBunch(*currentBunch, kick);
 		ApplyDriftMap(currentBunch, len);
-		field.SetCoefficient(1, b1);
 	}
 }
 
@@ -46,6 +46,13 @@ public:
 
 DECL_INTG_SET(ParticleComponentTracker, StdISet)
 
+/**
+ * The integrators of StdISet as a StaticISet
+ */
+typedef ParticleComponentTracker::StaticISet<DriftCI, TWRFStructureCI, SWRFStructureCI, RectMultipoleCI,
+	SectorBendCI, ParticleTracking::MarkerCI, ParticleTracking::MonitorCI, ParticleTracking::SolenoidCI,
+	ParticleTracking::ParticleMapCI> FixedISet;
+
 }  // end namespace SYMPLECTIC
 }
 #endif
@@ -35,6 +35,7 @@ template<class T> T Det(const Matrix<T>&);
 template<class T> void ludcmp(Matrix<T>&, std::vector<int>&, T&);
 template<class T, class V> V& lubksb(const Matrix<T>& a, const std::vector<int>& indx, V& b);
 template<class T> void svdcmp(Matrix<T>&, Vector<T>&, Matrix<T>&);
+template<class T> void svdecomp(Matrix<T>&, Vector<T>&, Matrix<T>&);
 template<class T, class V>
 Vector<T>& svbksb(const Matrix<T>&, const Vector<T>&, const Matrix<T>&, const V&, Vector<T>&);
 
@@ -12,6 +12,7 @@
 // perform linear algebra functions based on TMAT::Matrix and TMAT::Vector classes.
 
 #include "TLAS.h"
+#include "BlockedLinearAlgebra.h"
 
 namespace TLAS
 {
@@ -207,7 +208,7 @@ void SVDMatrix<T>::Init(const Matrix<T>& M, T threshold)
 	wflgs = std::vector<bool>(u.ncols(), true);
 
 	v.redim(u.ncols(), u.ncols());
-	svdcmp(u, w, v);
+	svdecomp(u, w, v);
 
 	T wmin = threshold != T(0) ? threshold * (*std::max_element(w.begin(), w.end())) : threshold;
 	int zerocount = 0;
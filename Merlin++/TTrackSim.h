@@ -178,6 +178,16 @@ public:
 	 */
 	bunch_type* Track(bunch_type*);
 
+	/**
+	 * Tracks the supplied bunch without initialising the
+	 * processes again, so that they carry their state (e.g.
+	 * collimation loss counts) over from the last tracking.
+	 * The processes are initialised only if they have not yet
+	 * been used with this bunch.
+	 */
+	bunch_type* Continue(bunch_type*);
+	using TrackingSimulation::Continue;
+
 	/**
 	 * Sets the initial particle for single-particle tracking.
 	 */
@@ -204,6 +214,13 @@ public:
 private:
 	transport_process* transportProc;
 
+	/**
+	 * The bunch the processes were last initialised with
+	 */
+	const bunch_type* initialisedBunch;
+
+	bunch_type* TrackBunch(bunch_type* aBunch, bool do_init);
+
 	//Copy protection
 	TTrackSim(const TTrackSim& rhs);
 	TTrackSim& operator=(const TTrackSim& rhs);
@@ -216,7 +233,7 @@ private:
  */
 template<class T>
 TTrackSim<T>::TTrackSim(const AcceleratorModel::Beamline& bline, bunch_type* bunch0, bool del) :
-	TrackingSimulation(bline), transportProc(new transport_process())
+	TrackingSimulation(bline), transportProc(new transport_process()), initialisedBunch(nullptr)
 {
 	SetInitialBunch(bunch0, del);
 	AddProcess(transportProc);
@@ -224,7 +241,7 @@ TTrackSim<T>::TTrackSim(const AcceleratorModel::Beamline& bline, bunch_type* bun
 
 template<class T>
 TTrackSim<T>::TTrackSim(const AcceleratorModel::Beamline& bline, const particle_type& p, double Pref) :
-	TrackingSimulation(bline), transportProc(new transport_process())
+	TrackingSimulation(bline), transportProc(new transport_process()), initialisedBunch(nullptr)
 {
 	SetInitialParticle(p, Pref);
 	AddProcess(transportProc);
@@ -232,7 +249,7 @@ TTrackSim<T>::TTrackSim(const AcceleratorModel::Beamline& bline, const particle_
 
 template<class T>
 TTrackSim<T>::TTrackSim(const AcceleratorModel::RingIterator& ring, bunch_type* bunch0, bool del) :
-	TrackingSimulation(ring), transportProc(new transport_process())
+	TrackingSimulation(ring), transportProc(new transport_process()), initialisedBunch(nullptr)
 {
 	SetInitialBunch(bunch0, del);
 	AddProcess(transportProc);
@@ -240,7 +257,7 @@ TTrackSim<T>::TTrackSim(const AcceleratorModel::RingIterator& ring, bunch_type*
 
 template<class T>
 TTrackSim<T>::TTrackSim(const AcceleratorModel::RingIterator& ring, const particle_type& p, double Pref) :
-	TrackingSimulation(ring), transportProc(new transport_process())
+	TrackingSimulation(ring), transportProc(new transport_process()), initialisedBunch(nullptr)
 {
 	SetInitialParticle(p, Pref);
 	AddProcess(transportProc);
@@ -248,7 +265,7 @@ TTrackSim<T>::TTrackSim(const AcceleratorModel::RingIterator& ring, const partic
 
 template<class T>
 TTrackSim<T>::TTrackSim() :
-	TrackingSimulation(), transportProc(new transport_process())
+	TrackingSimulation(), transportProc(new transport_process()), initialisedBunch(nullptr)
 {
 	AddProcess(transportProc);
 }
@@ -265,6 +282,18 @@ void TTrackSim<T>::SetInitialParticle(const particle_type& p, double Pref)
  */
 template<class T>
 typename TTrackSim<T>::bunch_type * TTrackSim<T>::Track(bunch_type * aBunch)
+{
+	return TrackBunch(aBunch, true);
+}
+
+template<class T>
+typename TTrackSim<T>::bunch_type * TTrackSim<T>::Continue(bunch_type * aBunch)
+{
+	return TrackBunch(aBunch, aBunch != initialisedBunch);
+}
+
+template<class T>
+typename TTrackSim<T>::bunch_type * TTrackSim<T>::TrackBunch(bunch_type * aBunch, bool do_init)
 {
 	if(bunch != nullptr)
 	{
@@ -272,9 +301,13 @@ typename TTrackSim<T>::bunch_type * TTrackSim<T>::Track(bunch_type * aBunch)
 	}
 
 	bunch = aBunch;
+	if(do_init)
+	{
+		initialisedBunch = aBunch;
+	}
 	try
 	{
-		DoRun(false, true);
+		DoRun(false, do_init);
 	}
 	catch(...)
 	{
@@ -15,9 +15,10 @@ namespace
 
 template<class II>
 void PerformTracking(ProcessStepManager& aStepper, Bunch& aBunch, bool includeX, bool injOnAxis,
-	SimulationOutput* simop, II first, II last)
+	SimulationOutput* simop, const std::vector<bool>& record, II first, II last)
 {
 	bool fb = true;
+	size_t n = 0;
 	do
 	{
 		ComponentFrame* frame = *first;
@@ -52,10 +53,11 @@ void PerformTracking(ProcessStepManager& aStepper, Bunch& aBunch, bool includeX,
 		}
 		if(simop)
 		{
-			simop->DoRecord(frame, &aBunch);
+			simop->DoRecord(frame, &aBunch, record[n]);
 		}
 
 		fb = false;
+		n++;
 	} while(++first != last);
 }
 
@@ -77,19 +79,19 @@ ComponentFrame* TrackingSimulation::TStepper<I>::NextFrame()
 
 TrackingSimulation::TrackingSimulation(const AcceleratorModel::Beamline& bline) :
 	bunch(nullptr), incX(true), injOnAxis(false), log(nullptr), handle_me(false), type(beamline), ibunchCtor(nullptr),
-	stepper(), theRing(), theBeamline(bline), cstepper(nullptr), simOp(nullptr)
+	stepper(), theRing(), theBeamline(bline), cstepper(nullptr), simOp(nullptr), recordIds(0)
 {
 }
 
 TrackingSimulation::TrackingSimulation(const AcceleratorModel::RingIterator& aRing) :
 	bunch(nullptr), incX(true), injOnAxis(false), log(nullptr), handle_me(false), type(ring), ibunchCtor(nullptr),
-	stepper(), theRing(aRing), theBeamline(), cstepper(nullptr), simOp(nullptr)
+	stepper(), theRing(aRing), theBeamline(), cstepper(nullptr), simOp(nullptr), recordIds(0)
 {
 }
 
 TrackingSimulation::TrackingSimulation() :
 	bunch(nullptr), incX(true), injOnAxis(false), log(nullptr), handle_me(false), type(undefined), ibunchCtor(nullptr),
-	stepper(), theRing(), theBeamline(), cstepper(nullptr), simOp(nullptr)
+	stepper(), theRing(), theBeamline(), cstepper(nullptr), simOp(nullptr), recordIds(0)
 {
 }
 
@@ -97,12 +99,14 @@ void TrackingSimulation::SetBeamline(const AcceleratorModel::Beamline& bline)
 {
 	theBeamline = bline;
 	type = beamline;
+	recordFrames.clear();
 }
 
 void TrackingSimulation::SetRing(const AcceleratorModel::RingIterator& aRing)
 {
 	theRing = aRing;
 	type = ring;
+	recordFrames.clear();
 }
 
 TrackingSimulation::~TrackingSimulation()
@@ -135,6 +139,7 @@ Bunch& TrackingSimulation::DoRun(bool new_bunch, bool do_init)
 	if(simOp)
 	{
 		simOp->DoRecordInitialBunch(bunch);
+		SelectRecordFrames();
 	}
 
 	// NOTE potential bug: if injOnAxis is true then do_init should also be true.
@@ -155,11 +160,11 @@ Bunch& TrackingSimulation::DoRun(bool new_bunch, bool do_init)
 
 		if(type == beamline)
 		{
-			PerformTracking(stepper, *bunch, incX, injOnAxis, simOp, theBeamline.begin(), theBeamline.end());
+			PerformTracking(stepper, *bunch, incX, injOnAxis, simOp, recordFrames, theBeamline.begin(), theBeamline.end());
 		}
 		else
 		{
-			PerformTracking(stepper, *bunch, incX, injOnAxis, simOp, theRing, theRing);
+			PerformTracking(stepper, *bunch, incX, injOnAxis, simOp, recordFrames, theRing, theRing);
 		}
 	}
 	catch(MerlinException& me)
@@ -298,6 +303,25 @@ bool TrackingSimulation::StepComponent()
 void TrackingSimulation::SetOutput(SimulationOutput *simout)
 {
 	simOp = simout;
+	recordFrames.clear();
+}
+
+void TrackingSimulation::SelectRecordFrames()
+{
+	// The names are matched once for the lattice, and again only when
+	// the lattice, the output or its identifiers change
+	if(recordFrames.empty() || recordIds != simOp->GetIdentifierCount())
+	{
+		if(type == beamline)
+		{
+			recordFrames = simOp->SelectFrames(theBeamline.begin(), theBeamline.end());
+		}
+		else
+		{
+			recordFrames = simOp->SelectFrames(theRing, theRing);
+		}
+		recordIds = simOp->GetIdentifierCount();
+	}
 }
 
 // SimulationOutput definitions
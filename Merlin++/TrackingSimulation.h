@@ -32,9 +32,35 @@ public:
 	void DoRecordInitialBunch(const Bunch* bunch);
 	void DoRecordFinalBunch(const Bunch* bunch);
 
+	/**
+	 * Record frame if selected, as flagged by SelectFrames(), or if
+	 * all components are output.
+	 */
+	void DoRecord(const ComponentFrame* frame, const Bunch* bunch, bool selected)
+	{
+		if(output_all ? frame->IsComponent() : selected)
+		{
+			Record(frame, bunch);
+		}
+	}
+
+	/**
+	 * Flags for the frames first to last (the whole ring if first ==
+	 * last) whose components match an identifier. The names are matched
+	 * once here, rather than at each frame tracked.
+	 */
+	template<class II>
+	std::vector<bool> SelectFrames(II first, II last);
+
 	// Output control
 	void AddIdentifier(const std::string& pattern, size_t nocc = 1);
 
+	/// Number of identifiers added, which invalidates earlier SelectFrames()
+	size_t GetIdentifierCount() const
+	{
+		return ids.size();
+	}
+
 	// Public output flags
 	bool output_all;
 	bool output_initial;
@@ -52,6 +78,18 @@ private:
 	std::vector<StringPattern> ids;
 };
 
+template<class II>
+std::vector<bool> SimulationOutput::SelectFrames(II first, II last)
+{
+	std::vector<bool> selected;
+	do
+	{
+		const ComponentFrame* frame = *first;
+		selected.push_back(frame->IsComponent() && IsMember(frame->GetComponent().GetQualifiedName()));
+	} while(++first != last);
+	return selected;
+}
+
 /**
  * A beam dynamics simulation. TrackingSimulation tracks a
  * Bunch object through a specified Beamline (single pass).
@@ -258,6 +296,11 @@ private:
 	AcceleratorModel::Beamline theBeamline;
 	Stepper* cstepper;
 	SimulationOutput* simOp;
+
+	// Frames recorded by simOp, for its identifiers when selected
+	std::vector<bool> recordFrames;
+	size_t recordIds;
+	void SelectRecordFrames();
 };
 
 /**
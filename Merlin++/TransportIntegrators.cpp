@@ -33,6 +33,7 @@ ADD_INTG(SolenoidCI)
 ADD_INTG(THIN_LENS::SWRFStructureCI)
 ADD_INTG(MarkerCI)
 ADD_INTG(MonitorCI)
+ADD_INTG(ParticleMapCI)
 END_INTG_SET
 
 } // end namespace TRANSPORT
@@ -57,19 +58,38 @@ struct MultipoleKick
 	const MultipoleField& field;
 	Complex scale;
 
+	// Coefficients (up to the sextupole) taken out of the kick because a map already models them.
+	// They are subtracted here rather than zeroed in the field, so that the field is never modified
+	// during tracking.
+	Complex removed[3];
+	bool subtract;
+
 	MultipoleKick(const MultipoleField& f, double len, double P0, double q, double phi = 0) :
-		field(f)
+		field(f), subtract(false)
 	{
 		//cout <<"apply multipolekick"<<endl;
 		scale = q * len * eV * SpeedOfLight / P0 * Complex(cos(phi), sin(phi));
 	}
 
+	MultipoleKick& Without(size_t n, const Complex& b)
+	{
+		removed[n] = b;
+		subtract = true;
+		return *this;
+	}
+
 	void operator()(PSvector& v)
 	{
 		double x = v.x();
 		double y = v.y();
 		double dp = v.dp();
-		Complex F = scale * field.GetField2D(x, y) / (1 + dp);
+		Complex B = field.GetField2D(x, y);
+		if(subtract)
+		{
+			const Complex z(x, y);
+			B -= field.GetFieldScale() * (removed[0] + z * (removed[1] + z * removed[2]));
+		}
+		Complex F = scale * B / (1 + dp);
 		v.xp() += -F.real();
 		v.yp() += F.imag();
 	}
@@ -79,8 +99,8 @@ struct MultipoleKick
 // Apply a map without dp/p scaling
 struct ApplyMap
 {
-	RTMap* m;
-	ApplyMap(RTMap* amap) :
+	const RTMap* m;
+	ApplyMap(const RTMap* amap) :
 		m(amap)
 	{
 	}
@@ -94,10 +114,10 @@ struct ApplyMap
 // Apply map with a dp/p scaling
 struct ApplyMap1
 {
-	RTMap* m;
+	const RTMap* m;
 	double Eratio;
 
-	ApplyMap1(RTMap* amap, double Er) :
+	ApplyMap1(const RTMap* amap, double Er) :
 		m(amap), Eratio(Er)
 	{
 	}
@@ -159,31 +179,34 @@ struct ApplyRFMap
 
 };
 
-inline void ApplyMapToBunch(ParticleBunch& bunch, RTMap* amap)
+inline void ApplyMapToBunch(ParticleBunch& bunch, const RTMap* amap)
 {
 //Old method (and now MPI)
 #ifndef ENABLE_OPENMP
-	for_each(bunch.begin(), bunch.end(), ApplyMap(amap));
+	ApplyToBunch(bunch, ApplyMap(amap));
 #endif
 
 //OpenMP option
 #ifdef ENABLE_OPENMP
-	#pragma omp parallel for
+	int flags = 0;
+	#pragma omp parallel for reduction(|:flags)
 	for(size_t i = 0; i < bunch.size(); i++)
 	{
 		amap->Apply(bunch.GetParticles()[i]);
+		flags |= bunch.CheckParticle(bunch.GetParticles()[i]);
 	}
+	bunch.AddTrackingFlags(flags);
 #endif
 }
 
-inline void ApplyMapToBunch(ParticleBunch& bunch, RTMap* amap, double Er)
+inline void ApplyMapToBunch(ParticleBunch& bunch, const RTMap* amap, double Er)
 {
-	for_each(bunch.begin(), bunch.end(), ApplyMap1(amap, Er));
+	ApplyToBunch(bunch, ApplyMap1(amap, Er));
 }
 
 inline void ApplyDriftToBunch(ParticleBunch& bunch, double len)
 {
-	for_each(bunch.begin(), bunch.end(), ApplyDrift(len));
+	ApplyToBunch(bunch, ApplyDrift(len));
 }
 
 void RotateBunchAboutZ(ParticleBunch& bunch, double phi)
@@ -221,7 +244,7 @@ void SectorBendCI::TrackStep(double ds)
 	CHK_ZERO(ds);
 
 	double h = (*currentComponent).GetGeometry().GetCurvature();
-	MultipoleField& field = (*currentComponent).GetField();
+	const MultipoleField& field = (*currentComponent).GetField();
 	const double P0 = (*currentBunch).GetReferenceMomentum();
 	const double q = (*currentBunch).GetChargeSign();
 	const double Pref = (*currentComponent).GetMatchedMomentum(q);
@@ -241,8 +264,8 @@ void SectorBendCI::TrackStep(double ds)
 	bool splitMagnet = b0.imag() != 0 || K1.imag() != 0 || np > 1;
 	double len = splitMagnet ? ds / 2.0 : ds;
 
-	// Construct the second-order map
-	RTMap* M = (abs(K1) == 0) ? SectorBendTM(len, h, gamma) : GenSectorBendTM(len, h, K1.real(), 0);
+	// The second-order map
+	const RTMap* M = &GetMap(len, h, K1, gamma);
 
 	if(fequal(P0, Pref, REL_ENGY_TOL))
 	{
@@ -259,16 +282,16 @@ void SectorBendCI::TrackStep(double ds)
 	if(splitMagnet)
 	{
 
-		// First we set the real parts of the
-		// dipole and quad fields to zero, since these
+		// The real parts of the dipole and quad fields
+		// are left out of the kick, since these
 		// components have been modeled in the matrix
 		Complex b1 = field.GetCoefficient(1);
-		field.SetCoefficient(0, Complex(0, b0.imag()));
-		field.SetCoefficient(1, Complex(0, b1.imag()));
+		MultipoleKick kick(field, ds, P0, q);
+		kick.Without(0, b0.real()).Without(1, b1.real());
 
 		// Apply the integrated kick, and then track
 		// through the linear second half
-		for_each((*currentBunch).begin(), (*currentBunch).end(), MultipoleKick(field, ds, P0, q));
+		ApplyToBunch(*currentBunch, kick);
 
 		if(fequal(P0, Pref, REL_ENGY_TOL))
 		{
@@ -278,16 +301,34 @@ void SectorBendCI::TrackStep(double ds)
 		{
 			ApplyMapToBunch(*currentBunch, M, P0 / Pref);
 		}
+	}
+	return;
+
+}
 
-		// Remember to set the components back
-		field.SetCoefficient(0, b0);
-		field.SetCoefficient(1, b1);
+const RTMap& SectorBendCI::GetMap(double len, double h, const Complex& K1, double gamma)
+{
+	// An accelerating bunch needs new maps at each step, so the
+	// maps are dropped once there are many
+	static const size_t max_maps = 256;
+
+	// gamma is at least 1, so a key with gamma 0 is a quadrupole map
+	const bool dipole = abs(K1) == 0;
+	const std::array<double, 4> key = {{len, h, K1.real(), dipole ? gamma : 0}};
+	auto m = maps.find(key);
+	if(m != maps.end())
+	{
+		return m->second;
 	}
 
-	// must delete the map
+	if(maps.size() >= max_maps)
+	{
+		maps.clear();
+	}
+	RTMap* M = dipole ? SectorBendTM(len, h, gamma) : GenSectorBendTM(len, h, K1.real(), 0);
+	const RTMap& cached = maps.emplace(key, std::move(*M)).first->second;
 	delete M;
-	return;
-
+	return cached;
 }
 
 void SectorBendCI::TrackEntrance()
@@ -350,7 +391,7 @@ void RectMultipoleCI::TrackStep(double ds)
 	if((*currentComponent).GetLength() == 0 && ds == 0 && !field.IsNullField())
 	{
 		// treat field as integrated strength
-		for_each((*currentBunch).begin(), (*currentBunch).end(), MultipoleKick(field, 1.0, P0, q));
+		ApplyToBunch(*currentBunch, MultipoleKick(field, 1.0, P0, q));
 		return;
 	}
 
@@ -393,12 +434,11 @@ void RectMultipoleCI::TrackStep(double ds)
 		ApplyMapToBunch(*currentBunch, M);
 		if(splitMagnet)
 		{
-			Complex b1 = field.GetCoefficient(1);
-			field.SetCoefficient(1, Complex(0));
-			for_each((*currentBunch).begin(), (*currentBunch).end(), MultipoleKick(field, ds, P0, q, -phi));
+			MultipoleKick kick(field, ds, P0, q, -phi);
+			kick.Without(1, field.GetCoefficient(1));
+			ApplyToBunch(*currentBunch, kick);
 			// Apply second half of map
 			ApplyMapToBunch(*currentBunch, M);
-			field.SetCoefficient(1, b1);
 		}
 		delete M;
 		if(!fequal(phi, 0))
@@ -430,12 +470,11 @@ void RectMultipoleCI::TrackStep(double ds)
 		ApplyMapToBunch(*currentBunch, M);
 		if(splitMagnet)
 		{
-			Complex b2 = field.GetCoefficient(2);
-			field.SetCoefficient(2, Complex(0));
-			for_each((*currentBunch).begin(), (*currentBunch).end(), MultipoleKick(field, ds, P0, q, -phi));
+			MultipoleKick kick(field, ds, P0, q, -phi);
+			kick.Without(2, field.GetCoefficient(2));
+			ApplyToBunch(*currentBunch, kick);
 			// Apply second half of map
 			ApplyMapToBunch(*currentBunch, M);
-			field.SetCoefficient(2, b2);
 		}
 		delete M;
 		if(!fequal(phi, 0))
@@ -448,7 +487,7 @@ void RectMultipoleCI::TrackStep(double ds)
 		ApplyDriftToBunch(*currentBunch, len);
 		if(splitMagnet)
 		{
-			for_each((*currentBunch).begin(), (*currentBunch).end(), MultipoleKick(field, ds, P0, q));
+			ApplyToBunch(*currentBunch, MultipoleKick(field, ds, P0, q));
 			// Apply second half of map
 			ApplyDriftToBunch(*currentBunch, len);
 		}
@@ -84,7 +84,8 @@ namespace ParticleTracking
 
 WakeFieldProcess::WakeFieldProcess(int prio, size_t nb, double ns, string aID) :
 	ParticleBunchProcess(aID, prio), imploc(atExit), nbins(nb), nsig(ns), currentWake(nullptr), Qd(), Qdp(), filter(
-		nullptr), wake_x(0), wake_y(0), wake_z(0), recalc(true), inc_tw(true), oldBunchLen(0)
+		nullptr), wake_x(0), wake_y(0), wake_z(0), recalc(true), inc_tw(true), oldBunchLen(0), binnedCharge(0), binnedWakeVersion(0),
+	rebinTolerance(0.1)
 {
 	SetFilter(14, 2, 1);
 
@@ -210,8 +211,16 @@ void WakeFieldProcess::DoProcess(double ds)
 	current_s += ds;
 	if(fequal(current_s, impulse_s))
 	{
-		currentBunch->SortByCT();
-		Init();
+		if(NeedsRebinning())
+		{
+			currentBunch->SortByCT();
+			Init();
+		}
+		else if(currentWake->GetVersion() != binnedWakeVersion)
+		{
+			CalculateWakeL();
+			binnedWakeVersion = currentWake->GetVersion();
+		}
 		ApplyWakefield(clen);
 		active = false;
 	}
@@ -327,6 +336,37 @@ void WakeFieldProcess::Init()
 	CalculateWakeL();
 	recalc = false;
 
+	binnedCT.resize(currentBunch->size());
+	size_t i = 0;
+	for(ParticleBunch::const_iterator p = currentBunch->begin(); p != currentBunch->end(); p++, i++)
+	{
+		binnedCT[i] = p->ct();
+	}
+	binnedCharge = currentBunch->GetTotalCharge();
+	binnedWakeVersion = currentWake->GetVersion();
+}
+
+bool WakeFieldProcess::NeedsRebinning() const
+{
+	// The slices are iterators into the bunch, so the bunch must be
+	// unchanged as well as the ct of its particles
+	if(recalc || bunchSlices.empty() || binnedCT.size() != currentBunch->size() || bunchSlices.front()
+		!= currentBunch->begin() || bunchSlices.back() != currentBunch->end() || currentBunch->GetTotalCharge()
+		!= binnedCharge)
+	{
+		return true;
+	}
+
+	const double tol = rebinTolerance * dz;
+	size_t i = 0;
+	for(ParticleBunch::const_iterator p = currentBunch->begin(); p != currentBunch->end(); p++, i++)
+	{
+		if(fabs(p->ct() - binnedCT[i]) > tol)
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
 void WakeFieldProcess::CalculateWakeL()
@@ -360,11 +400,17 @@ void WakeFieldProcess::CalculateWakeL()
 	}
 	else
 	{
+		// The wake depends only on the slice separation j - i
+		vector<double> wl(bunchSlices.size());
+		for(size_t k = 0; k + 1 < bunchSlices.size(); k++)
+		{
+			wl[k] = currentWake->Wlong((k + 0.5) * dz);
+		}
 		for(size_t i = 0; i < bunchSlices.size(); i++)
 		{
 			for(size_t j = i; j < bunchSlices.size() - 1; j++)
 			{
-				wake_z[i] += Qd[j] * (currentWake->Wlong((j - i + 0.5) * dz));
+				wake_z[i] += Qd[j] * wl[j - i];
 			}
 			wake_z[i] *= a0;
 		}
@@ -399,11 +445,16 @@ void WakeFieldProcess::CalculateWakeT()
 	double a0 = dz * (fabs(currentBunch->GetTotalCharge())) * ElectronCharge * Volt;
 	wake_x = vector<double>(bunchSlices.size(), 0.0);
 	wake_y = vector<double>(bunchSlices.size(), 0.0);
+	vector<double> wt(bunchSlices.size());
+	for(size_t k = 0; k + 1 < bunchSlices.size(); k++)
+	{
+		wt[k] = currentWake->Wtrans((k + 0.5) * dz);
+	}
 	for(i = 0; i < bunchSlices.size(); i++)
 	{
 		for(size_t j = i; j < bunchSlices.size() - 1; j++)
 		{
-			double wxy = Qd[j] * (currentWake->Wtrans((j - i + 0.5) * dz));
+			double wxy = Qd[j] * wt[j - i];
 			wake_x[i] += wxy * xyc[j].x;
 			wake_y[i] += wxy * xyc[j].y;
 		}
@@ -59,6 +59,23 @@ public:
 	void DumpSliceCentroids(std::ostream&) const;
 	void SetFilter(int n, int m, int d);
 
+	/**
+	 * The bunch is sorted and binned again at a wake unless its particles
+	 * and charge are unchanged and no particle has moved in ct by more
+	 * than f times the bin width since the last binning. Otherwise the
+	 * slices, charge distribution and longitudinal wake are reused, and
+	 * only the transverse wake is recalculated, and a particle may be
+	 * kicked with the wake of the slice it was in at the last binning.
+	 * The default f = 0.1 keeps the shift of the charge distribution well
+	 * below the width of the smoothing filter (SetFilter()), which spans
+	 * many bins. f = 0 reuses the binning only when no ct has changed at
+	 * all, which gives the same kicks as binning again.
+	 */
+	void SetRebinTolerance(double f)
+	{
+		rebinTolerance = f;
+	}
+
 protected:
 
 	ImpulseLocation imploc;
@@ -69,6 +86,7 @@ protected:
 	double nsig;
 
 	void Init();
+	bool NeedsRebinning() const;
 	size_t CalculateQdist();
 	virtual void CalculateWakeL();
 	virtual void CalculateWakeT();
@@ -90,6 +108,15 @@ protected:
 
 	size_t oldBunchLen;
 
+	/**
+	 * ct of the particles, total charge and version of the wake at the
+	 * last binning
+	 */
+	std::vector<double> binnedCT;
+	double binnedCharge;
+	size_t binnedWakeVersion;
+	double rebinTolerance;
+
 private:
 	//Copy protection
 	WakeFieldProcess(const WakeFieldProcess& rhs);
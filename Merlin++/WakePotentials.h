@@ -8,6 +8,7 @@
 #ifndef WakePotentials_h
 #define WakePotentials_h 1
 
+#include <atomic>
 #include "merlin_config.h"
 #include "BunchProcess.h"
 
@@ -22,11 +23,11 @@ class WakePotentials
 public:
 
 	WakePotentials(double r, double s) :
-		csr(false), expectedProcess(nullptr), radius(r), conductivity(s)
+		csr(false), expectedProcess(nullptr), version(NextVersion()), radius(r), conductivity(s)
 	{
 	}
 	WakePotentials() :
-		csr(false), expectedProcess(nullptr)
+		csr(false), expectedProcess(nullptr), version(NextVersion())
 	{
 	}                                                            // back to the original constructor
 	//WakePotentials() : csr(false) {}   // back to the original constructor
@@ -53,13 +54,41 @@ public:
 		expectedProcess = p;
 	}
 
+	/**
+	 * Returns a stamp identifying the current state of the potentials.
+	 * Stamps are unique across all instances, so processes may use them
+	 * to key cached tables of the potentials.
+	 * @return The version stamp
+	 */
+	size_t GetVersion() const
+	{
+		return version;
+	}
+
+	/**
+	 * Must be called after any parameter of the potentials is changed,
+	 * so that processes holding tables of the old values recalculate them.
+	 */
+	void Changed()
+	{
+		version = NextVersion();
+	}
+
 protected:
 	bool csr;
 
 private:
 	WakePotentials(const WakePotentials& wake);
 	WakePotentials& operator=(const WakePotentials& wake);
+
+	static size_t NextVersion()
+	{
+		static std::atomic<size_t> counter(0);
+		return ++counter;
+	}
+
 	BunchProcess* expectedProcess;
+	size_t version;
 	double radius;
 	double conductivity;
 };
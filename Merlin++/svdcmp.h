@@ -16,27 +16,27 @@ Vector<T>& svbksb(const Matrix<T>& u, const Vector<T>& w, const Matrix<T>& v, co
 	const int m = b.size();
 	const int n = u.ncols();
 	int jj, j, i;
-	std::vector<T> tmp(n);
+	std::vector<T> tmp(n, T(0));
 
-	for(j = 0; j < n; j++)
+	// U^T b, by rows of u
+	for(i = 0; i < m; i++)
 	{
-		T s = 0.0;
-		if(!fequal(w[j], 0.0))
+		const T bi = b[i];
+		for(j = 0; j < n; j++)
 		{
-			for(i = 0; i < m; i++)
-			{
-				s += u[i][j] * b[i];
-			}
-			s /= w[j];
+			tmp[j] += u(i, j) * bi;
 		}
-		tmp[j] = s;
+	}
+	for(j = 0; j < n; j++)
+	{
+		tmp[j] = fequal(w[j], 0.0) ? T(0) : tmp[j] / w[j];
 	}
 	for(j = 0; j < n; j++)
 	{
 		T s = 0.0;
 		for(jj = 0; jj < n; jj++)
 		{
-			s += v[j][jj] * tmp[jj];
+			s += v(j, jj) * tmp[jj];
 		}
 		x[j] = s;
 	}
@@ -359,4 +359,26 @@ void svdcmp(Matrix<T>& a, Vector<T>& w, Matrix<T>& v)
 	}
 }
 
+/**
+ * Singular value decomposition by svdcmp(), or by BlockedSVD() for large
+ * real matrices.
+ */
+template<class T>
+void svdecomp(Matrix<T>& a, Vector<T>& w, Matrix<T>& v)
+{
+	svdcmp(a, w, v);
+}
+
+inline void svdecomp(Matrix<double>& a, Vector<double>& w, Matrix<double>& v)
+{
+	if(a.ncols() >= GetBlockedThreshold())
+	{
+		BlockedSVD(a, w, v);
+	}
+	else
+	{
+		svdcmp(a, w, v);
+	}
+}
+
 #endif